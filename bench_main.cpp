@@ -0,0 +1,24 @@
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "benchmarks.h"
+#include "hot_log.h"
+#include "trace.h"
+#include <string>
+
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+// Benchmark runner: `AudioPlayerBench <name>`, or `AudioPlayerBench list`.
+int main(int argc, char** argv) {
+    spdlog::set_default_logger(spdlog::stdout_color_mt<spdlog::async_factory>("bench_logger"));
+    spdlog::set_level(spdlog::level::info);
+    StartHotLog();
+    SetTraceThreadName("Main");
+
+    const int exit_code = RunBenchmark(argc > 1 ? argv[1] : "list");
+    StopHotLog();
+    spdlog::shutdown();
+    return exit_code;
+}
@@ -0,0 +1,720 @@
+#include "benchmarks.h"
+
+#include "hot_log.h"
+#include "latency_probe.h"
+#include "load_policy.h"
+#include "miniaudio.h"
+#include "resampler.h"
+#include "soundboard.h"
+#include "trace.h"
+#include "track_source.h"
+#include "wav_format.h"
+#include "volume_node.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+// --- Allocation Counting ---
+// Global replacements so benchmarks can assert that a code path never allocates. Counting is armed
+// per thread, so only the thread under test is measured. They live here, in the AudioPlayerBench
+// executable only; the player keeps the standard allocator. The array and nothrow forms forward to
+// these.
+namespace {
+thread_local bool t_count_allocations = false;
+std::atomic<size_t> g_counted_allocations{0};
+
+void CountAllocation() {
+    if (t_count_allocations) {
+        g_counted_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+} // namespace
+
+void* operator new(std::size_t size) {
+    CountAllocation();
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    CountAllocation();
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+#if defined(_WIN32)
+    void* memory = _aligned_malloc(rounded, align);
+#else
+    void* memory = std::aligned_alloc(align, rounded);
+#endif
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+namespace {
+
+// --- Resampler ---
+using ResampleFunction = std::function<void(const float*, uint64_t*, float*, uint64_t*)>;
+
+constexpr uint32_t kBenchChannels = 2;
+constexpr uint64_t kBenchChunkFrames = 512;
+
+// Runs `input` through `process` in fixed chunks, as an audio callback would.
+std::vector<float> ResampleAll(const ResampleFunction& process, const std::vector<float>& input, double ratio) {
+    const uint64_t input_frames = input.size() / kBenchChannels;
+    std::vector<float> output(static_cast<size_t>(input_frames * ratio + kBenchChunkFrames * 2) * kBenchChannels);
+    uint64_t consumed = 0;
+    uint64_t produced = 0;
+    while (consumed < input_frames) {
+        uint64_t in_count = std::min(kBenchChunkFrames, input_frames - consumed);
+        uint64_t out_count = std::min<uint64_t>(kBenchChunkFrames * 2, output.size() / kBenchChannels - produced);
+        process(input.data() + consumed * kBenchChannels, &in_count, output.data() + produced * kBenchChannels, &out_count);
+        if (in_count == 0 && out_count == 0) {
+            break;
+        }
+        consumed += in_count;
+        produced += out_count;
+    }
+    output.resize(produced * kBenchChannels);
+    return output;
+}
+
+// THD+N of the left channel: least-squares fit of a sine at `frequency` plus DC over the middle of
+// the output, then residual power relative to the fitted tone.
+double MeasureThdPlusNoiseDb(const std::vector<float>& output, uint32_t rate, double frequency) {
+    const size_t frames = output.size() / kBenchChannels;
+    const size_t begin = frames / 8;
+    const size_t end = frames - frames / 8;
+    double ss = 0, sc = 0, s1 = 0, cc = 0, c1 = 0, n = 0, ys = 0, yc = 0, y1 = 0;
+    for (size_t i = begin; i < end; ++i) {
+        double phase = 2.0 * std::numbers::pi * frequency * i / rate;
+        double s = std::sin(phase), c = std::cos(phase), y = output[i * kBenchChannels];
+        ss += s * s; sc += s * c; s1 += s; cc += c * c; c1 += c; n += 1.0;
+        ys += y * s; yc += y * c; y1 += y;
+    }
+    // Solve the 3x3 normal equations with Cramer's rule.
+    auto det3 = [](double a, double b, double c, double d, double e, double f, double g, double h, double k) {
+        return a * (e * k - f * h) - b * (d * k - f * g) + c * (d * h - e * g);
+    };
+    double det = det3(ss, sc, s1, sc, cc, c1, s1, c1, n);
+    double a = det3(ys, sc, s1, yc, cc, c1, y1, c1, n) / det;
+    double b = det3(ss, ys, s1, sc, yc, c1, s1, y1, n) / det;
+    double dc = det3(ss, sc, ys, sc, cc, yc, s1, c1, y1) / det;
+
+    double signal = 0.0, residual = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        double phase = 2.0 * std::numbers::pi * frequency * i / rate;
+        double fit = a * std::sin(phase) + b * std::cos(phase);
+        double error = output[i * kBenchChannels] - fit - dc;
+        signal += fit * fit;
+        residual += error * error;
+    }
+    return 10.0 * std::log10(std::max(residual, 1e-30) / signal);
+}
+
+std::vector<float> GenerateSine(uint32_t rate, double frequency, double seconds) {
+    std::vector<float> samples(static_cast<size_t>(rate * seconds) * kBenchChannels);
+    for (size_t i = 0; i < samples.size() / kBenchChannels; ++i) {
+        float value = 0.5f * static_cast<float>(std::sin(2.0 * std::numbers::pi * frequency * i / rate));
+        for (uint32_t c = 0; c < kBenchChannels; ++c) {
+            samples[i * kBenchChannels + c] = value;
+        }
+    }
+    return samples;
+}
+
+// Returns a freshly initialised converter for the quality, or an empty function on failure.
+ResampleFunction CreateConverter(ResamplerQuality quality, uint32_t input_rate, uint32_t output_rate, std::shared_ptr<void>& holder) {
+    if (quality == ResamplerQuality::Builtin) {
+        // Same configuration ma_sound uses internally: linear, no low-pass stage.
+        ma_resampler_config config = ma_resampler_config_init(ma_format_f32, kBenchChannels, input_rate, output_rate,
+                                                              ma_resample_algorithm_linear);
+        config.linear.lpfOrder = 0;
+        auto resampler = std::shared_ptr<ma_resampler>(new ma_resampler{}, [](ma_resampler* r) {
+            ma_resampler_uninit(r, nullptr);
+            delete r;
+        });
+        if (ma_resampler_init(&config, nullptr, resampler.get()) != MA_SUCCESS) {
+            return {};
+        }
+        holder = resampler;
+        return [r = resampler.get()](const float* in, uint64_t* in_frames, float* out, uint64_t* out_frames) {
+            ma_uint64 in_count = *in_frames, out_count = *out_frames;
+            ma_resampler_process_pcm_frames(r, in, &in_count, out, &out_count);
+            *in_frames = in_count;
+            *out_frames = out_count;
+        };
+    }
+    auto resampler = std::make_shared<Resampler>();
+    if (!InitializeResampler(*resampler, quality, kBenchChannels, input_rate, output_rate)) {
+        return {};
+    }
+    holder = resampler;
+    return [r = resampler.get()](const float* in, uint64_t* in_frames, float* out, uint64_t* out_frames) {
+        ProcessResampler(*r, in, in_frames, out, out_frames);
+    };
+}
+
+int RunResamplerBenchmark() {
+    const std::pair<uint32_t, uint32_t> conversions[] = {{44100, 48000}, {48000, 44100}, {88200, 48000}};
+    const double test_frequencies[] = {1000.0, 10000.0};
+    constexpr double kThroughputSeconds = 10.0;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+    for (const auto& [input_rate, output_rate] : conversions) {
+        spdlog::info("Resampler {} -> {} Hz (stereo f32):", input_rate, output_rate);
+        const double ratio = static_cast<double>(output_rate) / input_rate;
+        std::vector<float> noise_input(static_cast<size_t>(input_rate * kThroughputSeconds) * kBenchChannels);
+        for (float& sample : noise_input) {
+            sample = noise(rng);
+        }
+
+        for (ResamplerQuality quality : kResamplerQualities) {
+            std::string thd_report;
+            for (double frequency : test_frequencies) {
+                std::shared_ptr<void> holder;
+                ResampleFunction process = CreateConverter(quality, input_rate, output_rate, holder);
+                if (!process) {
+                    spdlog::error("  {}: failed to initialise.", GetResamplerQualityName(quality));
+                    return 1;
+                }
+                auto output = ResampleAll(process, GenerateSine(input_rate, frequency, 2.0), ratio);
+                thd_report += fmt::format("  THD+N@{:.0f}Hz {:7.1f} dB", frequency, MeasureThdPlusNoiseDb(output, output_rate, frequency));
+            }
+
+            std::shared_ptr<void> holder;
+            ResampleFunction process = CreateConverter(quality, input_rate, output_rate, holder);
+            auto start = std::chrono::steady_clock::now();
+            auto output = ResampleAll(process, noise_input, ratio);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double frames_per_second = (output.size() / kBenchChannels) / elapsed;
+            spdlog::info("  {:<18} {:7.2f} Mframes/s ({:6.0f}x realtime){}", GetResamplerQualityName(quality), frames_per_second / 1e6,
+                         frames_per_second / output_rate, thd_report);
+        }
+    }
+    return 0;
+}
+
+// --- Volume Ramp ---
+int RunVolumeBenchmark() {
+    constexpr ma_uint32 kSampleRate = 48000;
+    constexpr ma_uint32 kBlockFrames = 512;
+    constexpr double kSeconds = 60.0;
+
+    VolumeNode node;
+    ConfigureVolumeRamp(&node, kBenchChannels, kSampleRate, 1.0f);
+    std::vector<float> input(static_cast<size_t>(kBlockFrames) * kBenchChannels, 1.0f); // DC, so output == gain
+    std::vector<float> output(input.size());
+
+    // A second thread moves the target as fast as it can, like a slider being dragged.
+    std::atomic<bool> running{true};
+    std::jthread slider([&node, &running] {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> value(0.0f, 1.0f);
+        while (running.load(std::memory_order_relaxed)) {
+            SetVolumeNodeTarget(&node, value(rng));
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    const size_t blocks = static_cast<size_t>(kSeconds * kSampleRate / kBlockFrames);
+    float previous_gain = 1.0f;
+    float max_step = 0.0f;
+    g_counted_allocations.store(0);
+    t_count_allocations = true;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t block = 0; block < blocks; ++block) {
+        ProcessVolumeRamp(&node, input.data(), output.data(), kBlockFrames);
+        for (ma_uint32 i = 0; i < kBlockFrames; ++i) {
+            max_step = std::max(max_step, std::fabs(output[i * kBenchChannels] - previous_gain));
+            previous_gain = output[i * kBenchChannels];
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    t_count_allocations = false;
+    running.store(false);
+
+    const size_t allocations = g_counted_allocations.load();
+    const double frames = static_cast<double>(blocks) * kBlockFrames;
+    spdlog::info("Volume ramp: {:.2f} ns/frame ({:.0f}x realtime), {} allocations on the audio thread, target atomic {}.",
+                 elapsed * 1e9 / frames, frames / kSampleRate / elapsed, allocations,
+                 std::atomic<float>::is_always_lock_free ? "lock-free" : "NOT lock-free");
+    spdlog::info("Largest per-sample gain change: {:.6f} (limit {:.6f} for a {:.0f} ms full-scale ramp).", max_step, node.max_step_per_frame,
+                 kVolumeRampMs);
+    return allocations == 0 && max_step <= node.max_step_per_frame * 1.001f ? 0 : 1;
+}
+
+// --- Soundboard ---
+int RunSoundboardBenchmark() {
+    constexpr ma_uint32 kSampleRate = 48000;
+    constexpr ma_uint32 kBlockFrames = 256;
+    constexpr int kPadCount = 200;
+    constexpr int kTriggers = 20000;
+    constexpr int kTriggersPerBlock = 4; // A busy performance: several hits per period
+
+    ma_engine_config engine_config = ma_engine_config_init();
+    engine_config.noDevice = MA_TRUE;
+    engine_config.channels = kBenchChannels;
+    engine_config.sampleRate = kSampleRate;
+    ma_engine engine;
+    if (ma_engine_init(&engine_config, &engine) != MA_SUCCESS) {
+        spdlog::error("Failed to initialise the offline engine.");
+        return 1;
+    }
+    Soundboard board;
+    if (!InitializeSoundboard(board, &engine, ma_engine_get_endpoint(&engine))) {
+        ma_engine_uninit(&engine);
+        return 1;
+    }
+
+    // Synthetic pads: 50-500 ms decaying noise bursts, every fourth one in a shared choke group.
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<CuePad> pads(kPadCount);
+    for (int i = 0; i < kPadCount; ++i) {
+        CuePad& pad = pads[i];
+        pad.name = fmt::format("pad{}", i);
+        pad.frame_count = kSampleRate / 20 + static_cast<ma_uint64>(i) * kSampleRate * 9 / 20 / kPadCount;
+        pad.samples.resize(static_cast<size_t>(pad.frame_count) * kBenchChannels);
+        for (size_t s = 0; s < pad.samples.size(); ++s) {
+            pad.samples[s] = noise(rng) * std::exp(-8.0f * static_cast<float>(s) / pad.samples.size());
+        }
+        pad.bus = i % kCueBusCount;
+        pad.choke_group = i % 4 == 0 ? 1 : 0;
+    }
+    ReplaceCuePads(board, std::move(pads));
+
+    std::vector<float> output(static_cast<size_t>(kBlockFrames) * kBenchChannels);
+    std::uniform_int_distribution<int> pick(0, kPadCount - 1);
+    double trigger_seconds = 0.0;
+    double max_trigger_seconds = 0.0;
+    g_counted_allocations.store(0);
+    for (int i = 0; i < kTriggers; ++i) {
+        const int pad = pick(rng);
+        t_count_allocations = true;
+        auto start = std::chrono::steady_clock::now();
+        TriggerCuePad(board, pad);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i % kTriggersPerBlock == kTriggersPerBlock - 1) {
+            ma_engine_read_pcm_frames(&engine, output.data(), kBlockFrames, nullptr);
+            ProcessSoundboardAudio(board);
+        }
+        t_count_allocations = false;
+        trigger_seconds += elapsed;
+        max_trigger_seconds = std::max(max_trigger_seconds, elapsed);
+    }
+
+    const size_t allocations = g_counted_allocations.load();
+    spdlog::info("Cue trigger: {:.0f} ns average, {:.0f} ns worst over {} triggers ({} voices, {} stolen).", trigger_seconds * 1e9 / kTriggers,
+                 max_trigger_seconds * 1e9, kTriggers, kCueVoiceCount, board.voices_stolen);
+    spdlog::info("{} allocations while triggering and rendering.", allocations);
+    UninitializeSoundboard(board);
+    ma_engine_uninit(&engine);
+    return allocations == 0 ? 0 : 1;
+}
+
+// --- Play Latency ---
+// Track switches on the null backend, which paces callbacks in real time like a device would, so
+// the result tracks the open/decode/start path rather than any particular sound card.
+int RunLatencyBenchmark() {
+    constexpr ma_uint32 kTrackRate = 44100; // Differs from the engine rate, so the resampler is in the path
+    constexpr ma_uint32 kEngineRate = 48000;
+    constexpr int kSwitches = 100;
+
+    std::vector<std::filesystem::path> tracks;
+    for (int t = 0; t < 2; ++t) {
+        std::vector<float> samples(static_cast<size_t>(kTrackRate) * 2 * kBenchChannels);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = 0.25f * static_cast<float>(std::sin(2.0 * std::numbers::pi * (220.0 * (t + 1)) * (i / kBenchChannels) / kTrackRate));
+        }
+        const auto data_bytes = static_cast<uint32_t>(samples.size() * sizeof(float));
+        const auto header = BuildWavHeader(kBenchChannels, kTrackRate, 32, true, data_bytes);
+        tracks.push_back(std::filesystem::temp_directory_path() / fmt::format("audioplayer_latency_{}.wav", t));
+        std::ofstream file(tracks.back(), std::ios::binary);
+        file.write(header.data(), header.size());
+        file.write(reinterpret_cast<const char*>(samples.data()), data_bytes);
+    }
+
+    ma_backend null_backend = ma_backend_null;
+    ma_context context;
+    if (ma_context_init(&null_backend, 1, nullptr, &context) != MA_SUCCESS) {
+        spdlog::error("Failed to initialise the null backend.");
+        return 1;
+    }
+    ma_resource_manager_config resource_manager_config = ma_resource_manager_config_init();
+    resource_manager_config.decodedFormat = ma_format_f32;
+    resource_manager_config.decodedSampleRate = 0;
+    ma_resource_manager resource_manager;
+    if (ma_resource_manager_init(&resource_manager_config, &resource_manager) != MA_SUCCESS) {
+        ma_context_uninit(&context);
+        return 1;
+    }
+    LatencyProbe probe;
+    probe.enabled = true;
+    ma_engine_config engine_config = ma_engine_config_init();
+    engine_config.pContext = &context;
+    engine_config.pResourceManager = &resource_manager;
+    engine_config.channels = kBenchChannels;
+    engine_config.sampleRate = kEngineRate;
+    engine_config.onProcess = [](void* user_data, float* frames, ma_uint64 frame_count) {
+        ProcessLatencyProbe(*static_cast<LatencyProbe*>(user_data), frames, frame_count, kBenchChannels, kEngineRate);
+    };
+    engine_config.pProcessUserData = &probe;
+    ma_engine engine;
+    if (ma_engine_init(&engine_config, &engine) != MA_SUCCESS) {
+        spdlog::error("Failed to initialise the engine on the null backend.");
+        ma_resource_manager_uninit(&resource_manager);
+        ma_context_uninit(&context);
+        return 1;
+    }
+    const double device_latency = GetPlaybackDeviceLatency(ma_engine_get_device(&engine));
+
+    TrackSource track;
+    ma_sound sound;
+    bool sound_initialized = false;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> gap_ms(0, 15); // Vary where in the period each click lands
+    for (int i = 0; i < kSwitches; ++i) {
+        const uint32_t finished = probe.measurements.load() + probe.timeouts.load();
+        StampLatencyClick(probe);
+        DisarmLatencyProbe(probe);
+        if (sound_initialized) {
+            ma_sound_uninit(&sound);
+            UninitializeTrackSource(&track);
+            sound_initialized = false;
+        }
+        ma_result result = InitializeTrackSource(&resource_manager, tracks[i % tracks.size()].string(), MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM,
+                                                 ResamplerQuality::Medium, kEngineRate, &track);
+        if (result == MA_SUCCESS) {
+            result = ma_sound_init_from_data_source(&engine, GetTrackDataSource(&track), 0, nullptr, &sound);
+            if (result != MA_SUCCESS) {
+                UninitializeTrackSource(&track);
+            }
+        }
+        if (result != MA_SUCCESS) {
+            spdlog::error("Failed to open the benchmark track: {}", ma_result_description(result));
+            break;
+        }
+        sound_initialized = true;
+        ma_sound_start(&sound);
+        ArmLatencyProbe(probe, &sound, device_latency);
+        while (probe.measurements.load() + probe.timeouts.load() == finished) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(gap_ms(rng)));
+    }
+    DisarmLatencyProbe(probe);
+    if (sound_initialized) {
+        ma_sound_uninit(&sound);
+        UninitializeTrackSource(&track);
+    }
+    ma_engine_uninit(&engine);
+    ma_resource_manager_uninit(&resource_manager);
+    ma_context_uninit(&context);
+    for (const auto& path : tracks) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+
+    const uint32_t measurements = probe.measurements.load();
+    if (measurements == 0) {
+        spdlog::error("No track switch produced audio.");
+        return 1;
+    }
+    spdlog::info("Track switch to first audible frame over {} switches: min {:.1f} ms, avg {:.1f} ms, max {:.1f} ms, p50 <= {:.0f} ms, "
+                 "p95 <= {:.0f} ms (device latency {:.1f} ms).",
+                 measurements, probe.min_ms.load(), probe.total_ms.load() / measurements, probe.max_ms.load(), EstimateLatencyPercentile(probe, 0.5),
+                 EstimateLatencyPercentile(probe, 0.95), device_latency * 1000.0);
+    spdlog::info("{} switches timed out.", probe.timeouts.load());
+    return probe.timeouts.load() == 0 ? 0 : 1;
+}
+
+// --- Load Policy ---
+uint64_t GetResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#elif defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    uint64_t total_pages = 0, resident_pages = 0;
+    statm >> total_pages >> resident_pages;
+    return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+// A mixed library opened in a fixed random order: mostly short cues, some album tracks and one long
+// mix. Each open is timed from the request to the first decoded block; the track is then held until
+// fully loaded, as during playback, while resident memory is sampled.
+int RunLoadPolicyBenchmark() {
+    struct BenchFile {
+        const char* name;
+        double seconds;
+        uint32_t sample_rate;
+        uint32_t channels;
+        int copies;
+    };
+    constexpr BenchFile kWorkload[] = {
+        {"cue", 4.0, 44100, 2, 12},
+        {"track", 90.0, 44100, 2, 4},
+        {"mix", 900.0, 22050, 1, 1},
+    };
+    constexpr int kOpens = 60;
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& spec : kWorkload) {
+        const auto frames = static_cast<size_t>(spec.seconds * spec.sample_rate);
+        std::vector<int16_t> samples(frames * spec.channels);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = static_cast<int16_t>(8000.0 * std::sin(2.0 * std::numbers::pi * 330.0 * (i / spec.channels) / spec.sample_rate));
+        }
+        const auto data_bytes = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+        const auto header = BuildWavHeader(spec.channels, spec.sample_rate, 16, false, data_bytes);
+        for (int copy = 0; copy < spec.copies; ++copy) {
+            files.push_back(std::filesystem::temp_directory_path() / fmt::format("audioplayer_load_{}_{}.wav", spec.name, copy));
+            std::ofstream file(files.back(), std::ios::binary);
+            file.write(header.data(), header.size());
+            file.write(reinterpret_cast<const char*>(samples.data()), data_bytes);
+        }
+    }
+    std::vector<TrackLoadInfo> infos(files.size());
+    std::vector<double> read_ms;
+    for (size_t i = 0; i < files.size(); ++i) {
+        infos[i].file_size = std::filesystem::file_size(files[i]);
+        double probe_ms = 0.0;
+        ProbeTrackFile(files[i].string(), infos[i], probe_ms);
+        read_ms.push_back(probe_ms);
+    }
+    const double storage_latency_ms = EstimateStorageLatency(read_ms);
+    std::vector<size_t> order(kOpens);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, files.size() - 1);
+    for (auto& index : order) {
+        index = pick(rng);
+    }
+
+    ma_resource_manager_config resource_manager_config = ma_resource_manager_config_init();
+    resource_manager_config.decodedFormat = ma_format_f32;
+    resource_manager_config.decodedSampleRate = 0;
+    ma_resource_manager resource_manager;
+    if (ma_resource_manager_init(&resource_manager_config, &resource_manager) != MA_SUCCESS) {
+        spdlog::error("Failed to initialise the resource manager.");
+        return 1;
+    }
+
+    struct PolicyRun {
+        const char* name;
+        std::optional<TrackLoadMode> fixed_mode; // Empty for the adaptive policy
+    };
+    const PolicyRun kPolicies[] = {
+        {"stream all", TrackLoadMode::Stream},
+        {"decode all", TrackLoadMode::Decode},
+        {"compressed all", TrackLoadMode::Compressed},
+        {"adaptive", std::nullopt},
+    };
+    const LoadPolicyConfig config;
+    bool failed = false;
+    std::vector<float> block(4096 * 2);
+    for (const auto& policy : kPolicies) {
+        std::vector<double> open_ms;
+        std::array<int, 3> mode_counts{};
+        const uint64_t baseline = GetResidentBytes();
+        uint64_t peak = baseline;
+        for (size_t index : order) {
+            const TrackLoadMode mode = policy.fixed_mode.value_or(ChooseTrackLoadMode(infos[index], config, storage_latency_ms));
+            ++mode_counts[static_cast<size_t>(mode)];
+            TrackSource track;
+            ma_fence done_fence;
+            ma_fence_init(&done_fence);
+            const auto start = std::chrono::steady_clock::now();
+            ma_result result = BeginTrackSourceOpen(&resource_manager, files[index].string(), GetTrackLoadFlags(mode), &track, &done_fence);
+            if (result == MA_SUCCESS) {
+                while (!IsTrackSourceOpenComplete(&track)) {
+                    std::this_thread::yield();
+                }
+                result = FinishTrackSourceOpen(&track, files[index].string(), ResamplerQuality::Builtin, infos[index].sample_rate);
+            }
+            if (result == MA_SUCCESS) {
+                const ma_uint64 frames = block.size() / infos[index].channels;
+                ma_uint64 frames_read = 0;
+                result = ma_data_source_read_pcm_frames(GetTrackDataSource(&track), block.data(), frames, &frames_read);
+            }
+            open_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            WaitForTrackSourceOpen(&track);
+            ma_fence_wait(&done_fence);
+            peak = std::max(peak, GetResidentBytes());
+            UninitializeTrackSource(&track);
+            ma_fence_uninit(&done_fence);
+            if (result != MA_SUCCESS) {
+                spdlog::error("Opening '{}' as {} failed: {}", files[index].string(), GetTrackLoadModeName(mode), ma_result_description(result));
+                failed = true;
+                break;
+            }
+        }
+        if (failed) {
+            break;
+        }
+        std::sort(open_ms.begin(), open_ms.end());
+        double total_ms = 0.0;
+        for (double ms : open_ms) {
+            total_ms += ms;
+        }
+        spdlog::info("{:<14} open avg {:.2f} ms, p95 {:.2f} ms, max {:.2f} ms; peak RSS +{:.1f} MiB ({} stream, {} decode, {} compressed).",
+                     policy.name, total_ms / open_ms.size(), open_ms[open_ms.size() * 95 / 100], open_ms.back(),
+                     (peak - baseline) / (1024.0 * 1024.0), mode_counts[0], mode_counts[1], mode_counts[2]);
+    }
+    spdlog::info("Storage first-read latency {:.3f} ms.", storage_latency_ms);
+
+    ma_resource_manager_uninit(&resource_manager);
+    for (const auto& path : files) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+    return failed ? 1 : 0;
+}
+
+// --- Hot-Path Logging ---
+int RunHotLogBenchmark() {
+    constexpr int kCalls = 1'000'000;
+    constexpr int kBatch = 1000; // Well inside the ring, so every enqueued record fits
+    constexpr double kBudgetNs = 50.0;
+    // Trace level: formatted by the drain thread as usual, then filtered out by spdlog.
+    static HotLogSite unlimited_site{spdlog::level::trace, "Bench {} {:.2f} {}", UINT32_MAX};
+    const std::string_view track_name = "Some Artist - Some Track.mp3";
+
+    g_counted_allocations.store(0);
+    double enqueue_seconds = 0.0;
+    for (int done = 0; done < kCalls; done += kBatch) {
+        t_count_allocations = true;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kBatch; ++i) {
+            WriteHotLog(unlimited_site, done + i, 0.5, track_name);
+        }
+        enqueue_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        t_count_allocations = false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // Let the drain thread catch up
+    }
+
+    t_count_allocations = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCalls; ++i) {
+        HOT_LOG_INFO("Bench rate-limited {} {}", i, track_name); // Ten get through; the rest are counted
+    }
+    const double limited_ns = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kCalls;
+    t_count_allocations = false;
+
+    const double enqueue_ns = enqueue_seconds * 1e9 / kCalls;
+    const size_t allocations = g_counted_allocations.load();
+    spdlog::info("Hot log: {:.1f} ns per enqueued message, {:.1f} ns per rate-limited call (budget {:.0f} ns), {} allocations, {} lost.", enqueue_ns,
+                 limited_ns, kBudgetNs, allocations, GetHotLogDroppedCount());
+    return enqueue_ns < kBudgetNs && limited_ns < kBudgetNs && allocations == 0 ? 0 : 1;
+}
+
+// --- Tracing ---
+int RunTraceBenchmark() {
+    constexpr int kEvents = 4'000'000;
+    constexpr double kBudgetNs = 20.0;
+    auto time_scopes = [&]() {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kEvents; ++i) {
+            TRACE_SCOPE("BenchScope");
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kEvents;
+    };
+
+    const double disabled_ns = time_scopes();
+    SetTracingEnabled(true);
+    TRACE_INSTANT("BenchWarmup"); // Registers this thread's buffer outside the measured loop
+    g_counted_allocations.store(0);
+    t_count_allocations = true;
+    const double enabled_ns = time_scopes();
+    t_count_allocations = false;
+    SetTracingEnabled(false);
+
+    const size_t allocations = g_counted_allocations.load();
+    spdlog::info("Trace scope: {:.2f} ns disabled, {:.2f} ns enabled per event (budget {:.0f} ns), {} allocations.", disabled_ns, enabled_ns,
+                 kBudgetNs, allocations);
+    return enabled_ns < kBudgetNs && allocations == 0 ? 0 : 1;
+}
+
+struct BenchmarkEntry {
+    const char* name;
+    const char* description;
+    int (*run)();
+};
+
+const BenchmarkEntry kBenchmarks[] = {
+    {"resampler", "Throughput and THD+N per resampler quality against miniaudio's linear converter", RunResamplerBenchmark},
+    {"volume", "Volume ramp cost, audio-thread allocations and per-sample gain steps", RunVolumeBenchmark},
+    {"soundboard", "Cue pad trigger cost and allocations with a saturated voice pool", RunSoundboardBenchmark},
+    {"log", "Hot-path log call cost, enqueued and rate-limited, and allocations", RunHotLogBenchmark},
+    {"latency", "Track switch to first audible frame on the null backend", RunLatencyBenchmark},
+    {"load", "Open latency and resident memory of the track load policies on a mixed library", RunLoadPolicyBenchmark},
+    {"trace", "Cost of a trace scope with tracing disabled and enabled", RunTraceBenchmark},
+};
+
+} // namespace
+
+int RunBenchmark(const std::string& name) {
+    for (const auto& entry : kBenchmarks) {
+        if (name == entry.name) {
+            spdlog::info("Running benchmark '{}'.", entry.name);
+            return entry.run();
+        }
+    }
+    if (name != "list") {
+        spdlog::error("Unknown benchmark '{}'.", name);
+    }
+    for (const auto& entry : kBenchmarks) {
+        spdlog::info("  {:<12} {}", entry.name, entry.description);
+    }
+    return name == "list" ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Offline benchmarks, run by the AudioPlayerBench executable: `AudioPlayerBench <name>`, where
+// `list` prints the available names. Returns the process exit code.
+int RunBenchmark(const std::string& name);
@@ -0,0 +1,78 @@
+#include "clock_sync.h"
+
+#include <chrono>
+
+void RecordDeviceClock(DeviceClock& clock, uint64_t frame_count) {
+    const int64_t now_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    const uint32_t sequence = clock.sequence.load(std::memory_order_relaxed);
+    clock.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    clock.frames.store(clock.frames.load(std::memory_order_relaxed) + frame_count, std::memory_order_relaxed);
+    clock.time_ns.store(now_ns, std::memory_order_relaxed);
+    clock.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool ReadDeviceClock(const DeviceClock& clock, uint64_t& frames_out, int64_t& time_ns_out) {
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        const uint32_t before = clock.sequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        frames_out = clock.frames.load(std::memory_order_relaxed);
+        time_ns_out = clock.time_ns.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (clock.sequence.load(std::memory_order_relaxed) == before) {
+            return before != 0;
+        }
+    }
+    return false;
+}
+
+void ResetDriftEstimator(DriftEstimator& estimator) {
+    estimator.count = 0;
+    estimator.head = 0;
+}
+
+void AddDriftSample(DriftEstimator& estimator, double time_seconds, double frames) {
+    estimator.times[estimator.head] = time_seconds;
+    estimator.frames[estimator.head] = frames;
+    estimator.head = (estimator.head + 1) % DriftEstimator::kCapacity;
+    if (estimator.count < DriftEstimator::kCapacity) {
+        ++estimator.count;
+    }
+}
+
+double EstimateDeviceRate(const DriftEstimator& estimator) {
+    if (estimator.count < kDriftMinSamples) {
+        return 0.0;
+    }
+    // Regress relative to the oldest sample so large frame counts keep their precision.
+    const size_t oldest = (estimator.head + DriftEstimator::kCapacity - estimator.count) % DriftEstimator::kCapacity;
+    const double t0 = estimator.times[oldest];
+    const double f0 = estimator.frames[oldest];
+    double sum_t = 0.0, sum_f = 0.0, sum_ff = 0.0, sum_tf = 0.0;
+    for (size_t i = 0; i < estimator.count; ++i) {
+        const size_t slot = (oldest + i) % DriftEstimator::kCapacity;
+        const double t = estimator.times[slot] - t0;
+        const double f = estimator.frames[slot] - f0;
+        sum_t += t;
+        sum_f += f;
+        sum_ff += f * f;
+        sum_tf += t * f;
+    }
+    const double n = static_cast<double>(estimator.count);
+    const double denominator = n * sum_ff - sum_f * sum_f;
+    if (denominator <= 0.0) {
+        return 0.0;
+    }
+    const double seconds_per_frame = (n * sum_tf - sum_t * sum_f) / denominator;
+    return seconds_per_frame > 0.0 ? 1.0 / seconds_per_frame : 0.0;
+}
+
+double ComputeDriftPpm(double reference_rate, ma_uint32 reference_nominal, double follower_rate, ma_uint32 follower_nominal) {
+    if (reference_rate <= 0.0 || follower_rate <= 0.0 || reference_nominal == 0 || follower_nominal == 0) {
+        return 0.0;
+    }
+    return ((follower_rate / follower_nominal) / (reference_rate / reference_nominal) - 1.0) * 1e6;
+}
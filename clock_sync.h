@@ -0,0 +1,43 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Clock-drift measurement between audio devices. Each device callback stamps its cumulative frame
+// count against the shared steady clock; a least-squares fit over a long window gives the device's
+// real consumption rate. Time is regressed on frames, since frame counts are exact and callback
+// timestamps carry the jitter. Comparing two devices' rates, each relative to its nominal rate,
+// gives their drift in ppm independent of the system clock's own error.
+
+struct DeviceClock {
+    std::atomic<uint32_t> sequence{0}; // Seqlock: odd while the audio thread is writing
+    std::atomic<uint64_t> frames{0};
+    std::atomic<int64_t> time_ns{0};
+};
+
+// Audio thread: account for `frame_count` frames consumed now. Wait-free.
+void RecordDeviceClock(DeviceClock& clock, uint64_t frame_count);
+// Any thread: consistent snapshot of the last record. False if nothing was recorded yet.
+bool ReadDeviceClock(const DeviceClock& clock, uint64_t& frames_out, int64_t& time_ns_out);
+
+struct DriftEstimator {
+    static constexpr size_t kCapacity = 2400; // Ten minutes at kDriftSampleInterval
+    std::array<double, kCapacity> times{};
+    std::array<double, kCapacity> frames{};
+    size_t count = 0;
+    size_t head = 0; // Next slot to write
+};
+
+constexpr double kDriftSampleInterval = 0.25; // Seconds between estimator samples
+constexpr size_t kDriftMinSamples = 40;       // Ten seconds of history before estimates are trusted
+
+void ResetDriftEstimator(DriftEstimator& estimator);
+void AddDriftSample(DriftEstimator& estimator, double time_seconds, double frames);
+// Least-squares frames per second over the window, or 0 until kDriftMinSamples are present.
+double EstimateDeviceRate(const DriftEstimator& estimator);
+
+// Drift of `follower` relative to `reference` in parts per million (positive = follower runs fast).
+double ComputeDriftPpm(double reference_rate, ma_uint32 reference_nominal, double follower_rate, ma_uint32 follower_nominal);
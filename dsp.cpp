@@ -0,0 +1,352 @@
+#include "dsp.h"
+
+#include "miniaudio.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "spdlog/spdlog.h"
+
+#if defined(AUDIOPLAYER_DSP_AVX2)
+#include <immintrin.h>
+#elif defined(AUDIOPLAYER_DSP_SSE2)
+#include <emmintrin.h>
+#elif defined(AUDIOPLAYER_DSP_NEON)
+#include <arm_neon.h>
+#endif
+
+// --- Vector Kernels ---
+float DspPeakAbs(const float* samples, size_t count) {
+    size_t i = 0;
+    float peak = 0.0f;
+#if defined(AUDIOPLAYER_DSP_SSE2)
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak4 = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        peak4 = _mm_max_ps(peak4, _mm_and_ps(_mm_loadu_ps(samples + i), abs_mask));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, peak4);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    float32x4_t peak4 = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        peak4 = vmaxq_f32(peak4, vabsq_f32(vld1q_f32(samples + i)));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, peak4);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; i < count; ++i) {
+        peak = std::max(peak, std::fabs(samples[i]));
+    }
+    return peak;
+}
+
+void DspMultiply(const float* a, const float* b, float* out, size_t count) {
+    size_t i = 0;
+#if defined(AUDIOPLAYER_DSP_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+void DspMultiplyInPlace(float* samples, const float* gains, size_t count) {
+    DspMultiply(samples, gains, samples, count);
+}
+
+void DspSubtract(const float* a, const float* b, float* out, size_t count) {
+    size_t i = 0;
+#if defined(AUDIOPLAYER_DSP_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+void DspScale(float* samples, float gain, size_t count) {
+    size_t i = 0;
+#if defined(AUDIOPLAYER_DSP_SSE2)
+    const __m128 gain4 = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), gain4));
+    }
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    const float32x4_t gain4 = vdupq_n_f32(gain);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), gain4));
+    }
+#endif
+    for (; i < count; ++i) {
+        samples[i] *= gain;
+    }
+}
+
+float DspDotProduct(const float* a, const float* b, size_t count) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(AUDIOPLAYER_DSP_AVX2)
+    __m256 sum8a = _mm256_setzero_ps();
+    __m256 sum8b = _mm256_setzero_ps();
+    for (; i + 16 <= count; i += 16) {
+        sum8a = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum8a);
+        sum8b = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum8b);
+    }
+    for (; i + 8 <= count; i += 8) {
+        sum8a = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum8a);
+    }
+    __m256 sum8 = _mm256_add_ps(sum8a, sum8b);
+    __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, sum4);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(AUDIOPLAYER_DSP_SSE2)
+    __m128 sum4 = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, sum4);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    float32x4_t sum4 = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        sum4 = vmlaq_f32(sum4, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum4);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void DspLerp(const float* a, const float* b, float t, float* out, size_t count) {
+    size_t i = 0;
+#if defined(AUDIOPLAYER_DSP_AVX2)
+    const __m256 t8 = _mm256_set1_ps(t);
+    for (; i + 8 <= count; i += 8) {
+        __m256 a8 = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), a8), t8, a8));
+    }
+#elif defined(AUDIOPLAYER_DSP_SSE2)
+    const __m128 t4 = _mm_set1_ps(t);
+    for (; i + 4 <= count; i += 4) {
+        __m128 a4 = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(a4, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), a4), t4)));
+    }
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    const float32x4_t t4 = vdupq_n_f32(t);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t a4 = vld1q_f32(a + i);
+        vst1q_f32(out + i, vmlaq_f32(a4, vsubq_f32(vld1q_f32(b + i), a4), t4));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = a[i] + (b[i] - a[i]) * t;
+    }
+}
+
+float DspSumOfSquares(const float* samples, size_t count) {
+    return DspDotProduct(samples, samples, count);
+}
+
+// Four lanes at a time: two shifted adds give the running sum within the vector, then the carry
+// from the previous vector is added and its last lane becomes the next carry.
+float DspPrefixSum(float* values, size_t count, float carry) {
+    size_t i = 0;
+#if defined(AUDIOPLAYER_DSP_SSE2)
+    __m128 carry4 = _mm_set1_ps(carry);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+        x = _mm_add_ps(x, carry4);
+        _mm_storeu_ps(values + i, x);
+        carry4 = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    carry = _mm_cvtss_f32(carry4);
+#elif defined(AUDIOPLAYER_DSP_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t carry4 = vdupq_n_f32(carry);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(values + i);
+        x = vaddq_f32(x, vextq_f32(zero, x, 3));
+        x = vaddq_f32(x, vextq_f32(zero, x, 2));
+        x = vaddq_f32(x, carry4);
+        vst1q_f32(values + i, x);
+        carry4 = vdupq_n_f32(vgetq_lane_f32(x, 3));
+    }
+    carry = vgetq_lane_f32(carry4, 0);
+#endif
+    for (; i < count; ++i) {
+        carry += values[i];
+        values[i] = carry;
+    }
+    return carry;
+}
+
+// --- FFT ---
+FftPlan CreateFftPlan(size_t size) {
+    FftPlan plan;
+    plan.size = size;
+    const size_t half = size / 2;
+
+    plan.window.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        plan.window[i] = 0.5f - 0.5f * static_cast<float>(std::cos(2.0 * std::numbers::pi * i / size));
+    }
+
+    plan.twiddle_re.resize(half / 2);
+    plan.twiddle_im.resize(half / 2);
+    for (size_t i = 0; i < half / 2; ++i) {
+        double angle = -2.0 * std::numbers::pi * i / half;
+        plan.twiddle_re[i] = static_cast<float>(std::cos(angle));
+        plan.twiddle_im[i] = static_cast<float>(std::sin(angle));
+    }
+
+    plan.post_re.resize(half + 1);
+    plan.post_im.resize(half + 1);
+    for (size_t k = 0; k <= half; ++k) {
+        double angle = -2.0 * std::numbers::pi * k / size;
+        plan.post_re[k] = static_cast<float>(std::cos(angle));
+        plan.post_im[k] = static_cast<float>(std::sin(angle));
+    }
+
+    uint32_t bits = 0;
+    while ((size_t{1} << bits) < half) {
+        ++bits;
+    }
+    plan.bit_reverse.resize(half);
+    for (uint32_t i = 0; i < half; ++i) {
+        uint32_t reversed = 0;
+        for (uint32_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        plan.bit_reverse[i] = reversed;
+    }
+    return plan;
+}
+
+void ComputePowerSpectrum(const FftPlan& plan, const float* frame, float* power_out, FftScratch& scratch) {
+    const size_t size = plan.size;
+    const size_t half = size / 2;
+    scratch.windowed.resize(size);
+    scratch.re.resize(half);
+    scratch.im.resize(half);
+
+    DspMultiply(frame, plan.window.data(), scratch.windowed.data(), size);
+
+    // Pack even/odd samples into a half-size complex sequence, in bit-reversed order.
+    float* re = scratch.re.data();
+    float* im = scratch.im.data();
+    for (size_t i = 0; i < half; ++i) {
+        uint32_t j = plan.bit_reverse[i];
+        re[j] = scratch.windowed[2 * i];
+        im[j] = scratch.windowed[2 * i + 1];
+    }
+
+    // Iterative radix-2 butterflies over the half-size sequence.
+    for (size_t span = 1; span < half; span *= 2) {
+        const size_t twiddle_step = half / (2 * span);
+        for (size_t start = 0; start < half; start += 2 * span) {
+            for (size_t k = 0; k < span; ++k) {
+                const float wr = plan.twiddle_re[k * twiddle_step];
+                const float wi = plan.twiddle_im[k * twiddle_step];
+                const size_t a = start + k;
+                const size_t b = a + span;
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    // Split the packed result into the spectrum of the real input.
+    for (size_t k = 0; k <= half; ++k) {
+        const size_t k1 = k % half;
+        const size_t k2 = (half - k) % half;
+        const float even_re = 0.5f * (re[k1] + re[k2]);
+        const float even_im = 0.5f * (im[k1] - im[k2]);
+        const float odd_re = 0.5f * (im[k1] + im[k2]);
+        const float odd_im = -0.5f * (re[k1] - re[k2]);
+        const float x_re = even_re + plan.post_re[k] * odd_re - plan.post_im[k] * odd_im;
+        const float x_im = even_im + plan.post_re[k] * odd_im + plan.post_im[k] * odd_re;
+        power_out[k] = x_re * x_re + x_im * x_im;
+    }
+}
+
+std::vector<int> CreateChromaBinMap(size_t fft_size, uint32_t sample_rate, double min_hz, double max_hz) {
+    std::vector<int> bin_map(fft_size / 2 + 1, -1);
+    for (size_t k = 1; k < bin_map.size(); ++k) {
+        double frequency = static_cast<double>(k) * sample_rate / fft_size;
+        if (frequency < min_hz || frequency > max_hz) {
+            continue;
+        }
+        double note = 12.0 * std::log2(frequency / 440.0) + 69.0;
+        int pitch_class = static_cast<int>(std::lround(note)) % 12;
+        bin_map[k] = pitch_class < 0 ? pitch_class + 12 : pitch_class;
+    }
+    return bin_map;
+}
+
+void AccumulateChroma(const float* power, const std::vector<int>& bin_map, float* chroma_out) {
+    std::fill(chroma_out, chroma_out + 12, 0.0f);
+    for (size_t k = 0; k < bin_map.size(); ++k) {
+        if (bin_map[k] >= 0) {
+            chroma_out[bin_map[k]] += power[k];
+        }
+    }
+}
+
+// --- Decoding For Analysis ---
+bool DecodeFileToMono(const std::string& filepath, uint32_t sample_rate, double max_seconds, std::vector<float>& samples_out) {
+    samples_out.clear();
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 1, sample_rate);
+    ma_decoder decoder;
+    ma_result result = ma_decoder_init_file(filepath.c_str(), &config, &decoder);
+    if (result != MA_SUCCESS) {
+        spdlog::warn("Analysis decode failed to open '{}': {}", filepath, ma_result_description(result));
+        return false;
+    }
+
+    const ma_uint64 max_frames = max_seconds > 0.0 ? static_cast<ma_uint64>(max_seconds * sample_rate) : UINT64_MAX;
+    ma_uint64 length = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) == MA_SUCCESS && length > 0) {
+        samples_out.reserve(static_cast<size_t>(std::min(length, max_frames)));
+    }
+
+    constexpr ma_uint64 kChunkFrames = 8192;
+    float chunk[kChunkFrames];
+    while (samples_out.size() < max_frames) {
+        ma_uint64 frames_read = 0;
+        ma_uint64 to_read = std::min<ma_uint64>(kChunkFrames, max_frames - samples_out.size());
+        result = ma_decoder_read_pcm_frames(&decoder, chunk, to_read, &frames_read);
+        samples_out.insert(samples_out.end(), chunk, chunk + frames_read);
+        if (result != MA_SUCCESS || frames_read < to_read) {
+            break;
+        }
+    }
+    ma_decoder_uninit(&decoder);
+    return !samples_out.empty();
+}
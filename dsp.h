@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shared DSP building blocks for the analysis passes and audio-thread nodes.
+// The vector kernels pick SSE2 / NEON at compile time and fall back to scalar code.
+// Hot kernels additionally use AVX2/FMA when the build enables it (AUDIOPLAYER_ENABLE_AVX2).
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER)) // MSVC /arch:AVX2 implies FMA
+#define AUDIOPLAYER_DSP_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIOPLAYER_DSP_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define AUDIOPLAYER_DSP_NEON 1
+#endif
+
+// --- Vector Kernels ---
+float DspPeakAbs(const float* samples, size_t count);
+void DspMultiply(const float* a, const float* b, float* out, size_t count);
+void DspMultiplyInPlace(float* samples, const float* gains, size_t count);
+// out[i] = a[i] - b[i]
+void DspSubtract(const float* a, const float* b, float* out, size_t count);
+void DspScale(float* samples, float gain, size_t count);
+float DspDotProduct(const float* a, const float* b, size_t count);
+// out[i] = a[i] + (b[i] - a[i]) * t
+void DspLerp(const float* a, const float* b, float t, float* out, size_t count);
+float DspSumOfSquares(const float* samples, size_t count);
+// In-place inclusive running sum starting from `carry`; returns the last value.
+float DspPrefixSum(float* values, size_t count, float carry);
+
+// --- FFT ---
+// Real-input FFT of a fixed power-of-two size, computed as a half-size complex FFT.
+struct FftPlan {
+    size_t size = 0;
+    std::vector<float> window;      // Hann window of `size` samples
+    std::vector<float> twiddle_re;  // Half-size complex FFT twiddles
+    std::vector<float> twiddle_im;
+    std::vector<float> post_re;     // Real-FFT post-processing twiddles
+    std::vector<float> post_im;
+    std::vector<uint32_t> bit_reverse;
+};
+
+struct FftScratch {
+    std::vector<float> windowed;
+    std::vector<float> re;
+    std::vector<float> im;
+};
+
+FftPlan CreateFftPlan(size_t size);
+// Applies the plan's window to `frame` (plan.size samples) and writes size/2 + 1 power bins.
+void ComputePowerSpectrum(const FftPlan& plan, const float* frame, float* power_out, FftScratch& scratch);
+
+// Pitch class (0 = C) for each of the size/2 + 1 power bins, -1 for bins outside [min_hz, max_hz].
+std::vector<int> CreateChromaBinMap(size_t fft_size, uint32_t sample_rate, double min_hz, double max_hz);
+// Folds a power spectrum into 12 pitch-class energies using a map from CreateChromaBinMap.
+void AccumulateChroma(const float* power, const std::vector<int>& bin_map, float* chroma_out);
+
+// --- Decoding For Analysis ---
+// Decodes a file to mono f32 at `sample_rate`, stopping after `max_seconds` (0 = whole file).
+bool DecodeFileToMono(const std::string& filepath, uint32_t sample_rate, double max_seconds, std::vector<float>& samples_out);
@@ -0,0 +1,187 @@
+#include "event_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+struct MappedEventLog {
+    std::atomic<bool> open{false};
+    EventLogHeader* header = nullptr;
+    EventRecord* records = nullptr;
+    uint32_t capacity = 0;
+    size_t mapped_bytes = 0;
+    std::chrono::steady_clock::time_point opened_at;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+MappedEventLog g_log;
+std::atomic<uint16_t> g_next_thread_number{1};
+thread_local uint16_t t_thread_number = 0;
+
+// Maps `bytes` of the file at `path` read-write, creating or resizing it. Sets `fresh` when the
+// file had to be created or resized, i.e. its previous contents cannot be a matching log.
+void* MapFile(const std::filesystem::path& path, size_t bytes, bool& fresh) {
+#if defined(_WIN32)
+    g_log.file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (g_log.file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER size{};
+    GetFileSizeEx(g_log.file, &size);
+    fresh = static_cast<size_t>(size.QuadPart) != bytes;
+    g_log.mapping = CreateFileMappingW(g_log.file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                       static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr); // Grows the file as needed
+    if (!g_log.mapping) {
+        CloseHandle(g_log.file);
+        g_log.file = INVALID_HANDLE_VALUE;
+        return nullptr;
+    }
+    void* view = MapViewOfFile(g_log.mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!view) {
+        CloseHandle(g_log.mapping);
+        CloseHandle(g_log.file);
+        g_log.mapping = nullptr;
+        g_log.file = INVALID_HANDLE_VALUE;
+    }
+    return view;
+#else
+    g_log.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (g_log.fd < 0) {
+        return nullptr;
+    }
+    struct stat info {};
+    fresh = fstat(g_log.fd, &info) != 0 || static_cast<size_t>(info.st_size) != bytes;
+    if (fresh && ftruncate(g_log.fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(g_log.fd);
+        g_log.fd = -1;
+        return nullptr;
+    }
+    void* view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, g_log.fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(g_log.fd);
+        g_log.fd = -1;
+        return nullptr;
+    }
+    return view;
+#endif
+}
+
+void UnmapFile(void* view, size_t bytes) {
+#if defined(_WIN32)
+    FlushViewOfFile(view, bytes);
+    UnmapViewOfFile(view);
+    CloseHandle(g_log.mapping);
+    CloseHandle(g_log.file);
+    g_log.mapping = nullptr;
+    g_log.file = INVALID_HANDLE_VALUE;
+#else
+    msync(view, bytes, MS_SYNC);
+    munmap(view, bytes);
+    ::close(g_log.fd);
+    g_log.fd = -1;
+#endif
+}
+
+bool HeaderMatches(const EventLogHeader& header, uint32_t capacity) {
+    return std::memcmp(header.magic, kEventLogMagic, sizeof(kEventLogMagic)) == 0 && header.version == kEventLogVersion &&
+           header.record_bytes == sizeof(EventRecord) && header.capacity == capacity;
+}
+
+} // namespace
+
+bool OpenEventLog(const std::filesystem::path& path, uint32_t capacity) {
+    if (IsEventLogOpen() || capacity == 0) {
+        return false;
+    }
+    const size_t bytes = kEventLogHeaderBytes + static_cast<size_t>(capacity) * sizeof(EventRecord);
+    bool fresh = false;
+    void* view = MapFile(path, bytes, fresh);
+    if (!view) {
+        spdlog::error("Event log: cannot map '{}'.", path.string());
+        return false;
+    }
+    auto* header = static_cast<EventLogHeader*>(view);
+    const bool continued = !fresh && HeaderMatches(*header, capacity);
+    if (!continued) {
+        std::memset(view, 0, bytes);
+        std::memcpy(header->magic, kEventLogMagic, sizeof(kEventLogMagic));
+        header->version = kEventLogVersion;
+        header->record_bytes = sizeof(EventRecord);
+        header->capacity = capacity;
+        header->next_sequence.store(0, std::memory_order_relaxed);
+    }
+    g_log.header = header;
+    g_log.records = reinterpret_cast<EventRecord*>(static_cast<char*>(view) + kEventLogHeaderBytes);
+    g_log.capacity = capacity;
+    g_log.mapped_bytes = bytes;
+    g_log.opened_at = std::chrono::steady_clock::now();
+    g_log.open.store(true, std::memory_order_release);
+    spdlog::info("Event log: {} '{}' ({} records).", continued ? "continuing" : "created", path.string(), capacity);
+#if defined(_WIN32)
+    LogEvent(EventType::SessionStart, static_cast<int64_t>(GetCurrentProcessId()));
+#else
+    LogEvent(EventType::SessionStart, static_cast<int64_t>(getpid()));
+#endif
+    return true;
+}
+
+void CloseEventLog() {
+    if (!IsEventLogOpen()) {
+        return;
+    }
+    LogEvent(EventType::SessionEnd, 0, std::chrono::duration<double>(std::chrono::steady_clock::now() - g_log.opened_at).count());
+    g_log.open.store(false, std::memory_order_release);
+    UnmapFile(g_log.header, g_log.mapped_bytes);
+    g_log.header = nullptr;
+    g_log.records = nullptr;
+}
+
+bool IsEventLogOpen() {
+    return g_log.open.load(std::memory_order_acquire);
+}
+
+void LogEvent(EventType type, int64_t value_int, double value, std::string_view text) {
+    if (!IsEventLogOpen()) {
+        return;
+    }
+    if (t_thread_number == 0) {
+        t_thread_number = g_next_thread_number.fetch_add(1, std::memory_order_relaxed);
+    }
+    const uint64_t sequence = g_log.header->next_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+    EventRecord& record = g_log.records[(sequence - 1) % g_log.capacity];
+    // Clear the commit marker first so a crash mid-write leaves the slot recognisably torn.
+    std::atomic_ref<uint64_t>(record.sequence).store(0, std::memory_order_relaxed);
+    record.time_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record.type = static_cast<uint16_t>(type);
+    record.thread = t_thread_number;
+    record.reserved = 0;
+    record.value_int = value_int;
+    record.value = value;
+    const size_t length = std::min(text.size(), kEventTextBytes);
+    if (length > 0) {
+        std::memcpy(record.text, text.data(), length);
+    }
+    std::memset(record.text + length, 0, kEventTextBytes - length);
+    std::atomic_ref<uint64_t>(record.sequence).store(sequence, std::memory_order_release);
+}
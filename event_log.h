@@ -0,0 +1,19 @@
+#pragma once
+
+#include "event_log_format.h"
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// Optional binary event log (--event-log[=path]). Records go straight into a memory-mapped ring
+// file, so logging an event costs a clock read and a 64-byte copy with no formatting, and the OS
+// still writes the pages back if the player crashes. An existing log with the same layout is
+// continued rather than truncated, so a restart after a crash keeps the history. Decode with the
+// EventLogDecode tool (tools/event_log_decode.cpp).
+
+bool OpenEventLog(const std::filesystem::path& path, uint32_t capacity = kEventLogDefaultCapacity);
+// Call once every thread that logs has stopped.
+void CloseEventLog();
+bool IsEventLogOpen();
+// Any thread; a no-op while no log is open. `text` is truncated to kEventTextBytes.
+void LogEvent(EventType type, int64_t value_int = 0, double value = 0.0, std::string_view text = {});
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of the binary event log, shared by the player and tools/event_log_decode.cpp.
+// The file is a kEventLogHeaderBytes header followed by `capacity` fixed-size records used as a
+// ring. A record's `sequence` is written last; 0 means the slot was never written, and a slot whose
+// sequence does not map back to its own index was torn by a crash mid-write.
+
+constexpr char kEventLogMagic[8] = {'A', 'P', 'E', 'V', 'L', 'O', 'G', '1'};
+constexpr uint32_t kEventLogVersion = 1;
+constexpr size_t kEventLogHeaderBytes = 4096;
+constexpr uint32_t kEventLogDefaultCapacity = 65536; // 4 MiB of records
+constexpr size_t kEventTextBytes = 24;
+
+enum class EventType : uint16_t {
+    SessionStart,
+    SessionEnd,
+    TrackOpened,
+    TrackOpenFailed,
+    PlaybackStarted,
+    PlaybackPaused,
+    PlaybackResumed,
+    TrackEnded,
+    VolumeChanged,
+    LibraryScanned,
+    LibraryAnalyzed,
+    RecordingStarted,
+    RecordingStopped,
+    StreamStarted,
+    StreamStopped,
+    ZoneAdded,
+    ZoneRemoved,
+    SlowFrame,
+    Error,
+    Count,
+};
+
+struct EventTypeInfo {
+    const char* name;
+    const char* int_label;   // Meaning of value_int, or null if unused
+    const char* value_label; // Meaning of value, or null if unused
+};
+
+constexpr std::array<EventTypeInfo, static_cast<size_t>(EventType::Count)> kEventTypeInfo = {{
+    {"SessionStart", "pid", nullptr},
+    {"SessionEnd", nullptr, "uptime_s"},
+    {"TrackOpened", "index", "open_ms"},
+    {"TrackOpenFailed", "result", nullptr},
+    {"PlaybackStarted", "index", nullptr},
+    {"PlaybackPaused", "index", nullptr},
+    {"PlaybackResumed", "index", nullptr},
+    {"TrackEnded", "index", nullptr},
+    {"VolumeChanged", nullptr, "volume"},
+    {"LibraryScanned", "tracks", "scan_ms"},
+    {"LibraryAnalyzed", "tracks", "analysis_ms"},
+    {"RecordingStarted", "sample_rate", nullptr},
+    {"RecordingStopped", "dropped_frames", "megabytes"},
+    {"StreamStarted", "port", nullptr},
+    {"StreamStopped", "listeners", "megabytes"},
+    {"ZoneAdded", "zones", nullptr},
+    {"ZoneRemoved", "zones", nullptr},
+    {"SlowFrame", nullptr, "frame_ms"},
+    {"Error", "code", nullptr},
+}};
+
+inline const EventTypeInfo* GetEventTypeInfo(uint16_t type) {
+    return type < kEventTypeInfo.size() ? &kEventTypeInfo[type] : nullptr;
+}
+
+struct EventRecord {
+    uint64_t sequence; // 1-based position in the log; written last
+    int64_t time_ns;   // System clock, nanoseconds since the Unix epoch
+    uint16_t type;     // EventType
+    uint16_t thread;   // Small per-process thread number
+    uint32_t reserved;
+    int64_t value_int;
+    double value;
+    char text[kEventTextBytes]; // Truncated, not necessarily terminated
+};
+static_assert(sizeof(EventRecord) == 64);
+
+struct EventLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_bytes;
+    uint32_t capacity;
+    uint32_t reserved;
+    std::atomic<uint64_t> next_sequence; // Last sequence handed out
+};
+static_assert(sizeof(EventLogHeader) <= kEventLogHeaderBytes);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
@@ -0,0 +1,265 @@
+#include "fingerprint.h"
+
+#include "dsp.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace {
+
+constexpr size_t kChromaBins = 12;
+constexpr size_t kClassifierWindow = 16; // Frames covered by one sub-fingerprint (~2 s)
+constexpr double kChromaMinFrequency = 28.0;
+constexpr double kChromaMaxFrequency = 3520.0;
+constexpr size_t kMinOverlap = 40;       // Sub-fingerprints (~5 s) needed for a meaningful comparison
+
+const FftPlan& GetFingerprintFftPlan() {
+    static const FftPlan plan = CreateFftPlan(kFingerprintFrameSize);
+    return plan;
+}
+
+const std::vector<int>& GetChromaBinMap() {
+    static const std::vector<int> bin_map = CreateChromaBinMap(kFingerprintFrameSize, kFingerprintSampleRate, kChromaMinFrequency, kChromaMaxFrequency);
+    return bin_map;
+}
+
+using ChromaFrame = std::array<float, kChromaBins>;
+
+std::vector<ChromaFrame> ComputeChromagram(const float* samples, size_t sample_count) {
+    std::vector<ChromaFrame> chroma;
+    if (sample_count < kFingerprintFrameSize) {
+        return chroma;
+    }
+    const FftPlan& plan = GetFingerprintFftPlan();
+    const std::vector<int>& bin_map = GetChromaBinMap();
+    FftScratch scratch;
+    std::vector<float> power(kFingerprintFrameSize / 2 + 1);
+
+    const size_t frame_count = (sample_count - kFingerprintFrameSize) / kFingerprintHopSize + 1;
+    chroma.resize(frame_count);
+    for (size_t t = 0; t < frame_count; ++t) {
+        ComputePowerSpectrum(plan, samples + t * kFingerprintHopSize, power.data(), scratch);
+        ChromaFrame& frame = chroma[t];
+        AccumulateChroma(power.data(), bin_map, frame.data());
+        float norm = std::sqrt(DspSumOfSquares(frame.data(), kChromaBins));
+        if (norm > 1e-6f) {
+            DspScale(frame.data(), 1.0f / norm, kChromaBins);
+        } else {
+            frame.fill(0.0f);
+        }
+    }
+
+    // Short temporal smoothing so single-frame codec artefacts do not flip bits.
+    static constexpr std::array<float, 5> kSmoothing = {0.25f, 0.75f, 1.0f, 0.75f, 0.25f};
+    std::vector<ChromaFrame> smoothed(frame_count);
+    for (size_t t = 0; t < frame_count; ++t) {
+        smoothed[t].fill(0.0f);
+        for (size_t tap = 0; tap < kSmoothing.size(); ++tap) {
+            size_t source = std::clamp<ptrdiff_t>(static_cast<ptrdiff_t>(t + tap) - 2, 0, static_cast<ptrdiff_t>(frame_count) - 1);
+            for (size_t c = 0; c < kChromaBins; ++c) {
+                smoothed[t][c] += kSmoothing[tap] * chroma[source][c];
+            }
+        }
+    }
+    return smoothed;
+}
+
+} // namespace
+
+void ComputeAcousticFingerprintFromSamples(const float* mono_samples, size_t sample_count, AcousticFingerprint& fingerprint_out) {
+    fingerprint_out.sub_fingerprints.clear();
+    std::vector<ChromaFrame> chroma = ComputeChromagram(mono_samples, sample_count);
+    if (chroma.size() < kClassifierWindow) {
+        return;
+    }
+
+    // Per-pitch-class running sums over time make every box filter O(1).
+    std::vector<ChromaFrame> integral(chroma.size() + 1);
+    integral[0].fill(0.0f);
+    for (size_t t = 0; t < chroma.size(); ++t) {
+        for (size_t c = 0; c < kChromaBins; ++c) {
+            integral[t + 1][c] = integral[t][c] + chroma[t][c];
+        }
+    }
+    auto box = [&](size_t c, size_t t0, size_t t1) { return integral[t1][c % kChromaBins] - integral[t0][c % kChromaBins]; };
+
+    const size_t count = chroma.size() - kClassifierWindow + 1;
+    fingerprint_out.sub_fingerprints.resize(count);
+    for (size_t t = 0; t < count; ++t) {
+        uint32_t bits = 0;
+        for (size_t c = 0; c < 12; ++c) {
+            // Bits 0-11: neighbouring pitch classes over half a window.
+            bits |= static_cast<uint32_t>(box(c, t, t + 8) > box(c + 1, t, t + 8)) << c;
+            // Bits 12-23: energy rising or falling within each pitch class.
+            bits |= static_cast<uint32_t>(box(c, t, t + 4) > box(c, t + 4, t + 8)) << (12 + c);
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            // Bits 24-31: fourth-apart pitch classes over the full window.
+            bits |= static_cast<uint32_t>(box(i * 5, t, t + kClassifierWindow) > box(i * 5 + 7, t, t + kClassifierWindow)) << (24 + i);
+        }
+        fingerprint_out.sub_fingerprints[t] = bits;
+    }
+}
+
+bool ComputeAcousticFingerprint(const std::string& filepath, AcousticFingerprint& fingerprint_out) {
+    TRACE_SCOPE("ComputeAcousticFingerprint");
+    std::vector<float> samples;
+    if (!DecodeFileToMono(filepath, kFingerprintSampleRate, kFingerprintMaxSeconds, samples)) {
+        fingerprint_out.sub_fingerprints.clear();
+        return false;
+    }
+    ComputeAcousticFingerprintFromSamples(samples.data(), samples.size(), fingerprint_out);
+    return !fingerprint_out.sub_fingerprints.empty();
+}
+
+float FingerprintSimilarity(const AcousticFingerprint& a, const AcousticFingerprint& b, int offset_b) {
+    const auto& fa = a.sub_fingerprints;
+    const auto& fb = b.sub_fingerprints;
+    ptrdiff_t begin = std::max<ptrdiff_t>(0, -offset_b);
+    ptrdiff_t end = std::min<ptrdiff_t>(static_cast<ptrdiff_t>(fa.size()), static_cast<ptrdiff_t>(fb.size()) - offset_b);
+    if (end - begin < static_cast<ptrdiff_t>(kMinOverlap)) {
+        return 0.0f;
+    }
+    size_t bit_errors = 0;
+    for (ptrdiff_t i = begin; i < end; ++i) {
+        bit_errors += std::popcount(fa[i] ^ fb[i + offset_b]);
+    }
+    return 1.0f - static_cast<float>(bit_errors) / (32.0f * static_cast<float>(end - begin));
+}
+
+// --- FingerprintIndex ---
+void FingerprintIndex::Add(uint32_t track_id, const AcousticFingerprint& fingerprint) {
+    AcousticFingerprint& kept = stored[track_id];
+    const auto& source = fingerprint.sub_fingerprints;
+    kept.sub_fingerprints.assign(source.begin(), source.begin() + std::min(source.size(), kIndexedSubFingerprints));
+    for (size_t offset = 0; offset < kept.sub_fingerprints.size(); offset += kIndexStride) {
+        buckets[kept.sub_fingerprints[offset] & kKeyMask].push_back({track_id, static_cast<uint32_t>(offset)});
+    }
+}
+
+std::vector<FingerprintMatch> FingerprintIndex::Query(const AcousticFingerprint& fingerprint, float min_similarity, size_t max_results) const {
+    // Vote for (track, alignment) pairs; a true duplicate piles its votes onto a single alignment.
+    std::unordered_map<uint64_t, uint32_t> votes;
+    const auto& query = fingerprint.sub_fingerprints;
+    const size_t query_length = std::min(query.size(), kIndexedSubFingerprints + kIndexStride);
+    for (size_t q = 0; q < query_length; ++q) {
+        auto it = buckets.find(query[q] & kKeyMask);
+        if (it == buckets.end() || it->second.size() > kMaxBucketSize) {
+            continue;
+        }
+        for (const Posting& posting : it->second) {
+            int32_t delta = static_cast<int32_t>(posting.offset) - static_cast<int32_t>(q);
+            ++votes[(static_cast<uint64_t>(posting.track_id) << 32) | static_cast<uint32_t>(delta)];
+        }
+    }
+
+    struct Candidate {
+        uint32_t track_id;
+        int offset;
+        uint32_t votes;
+    };
+    std::unordered_map<uint32_t, Candidate> best_per_track;
+    for (const auto& [key, count] : votes) {
+        uint32_t track_id = static_cast<uint32_t>(key >> 32);
+        int offset = static_cast<int32_t>(static_cast<uint32_t>(key));
+        auto [it, inserted] = best_per_track.try_emplace(track_id, Candidate{track_id, offset, count});
+        if (!inserted && count > it->second.votes) {
+            it->second = Candidate{track_id, offset, count};
+        }
+    }
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(best_per_track.size());
+    for (const auto& [track_id, candidate] : best_per_track) {
+        if (candidate.votes >= 2) {
+            candidates.push_back(candidate);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.votes > b.votes; });
+    if (candidates.size() > max_results * 4) {
+        candidates.resize(max_results * 4);
+    }
+
+    // Confirm candidates with the full bit error rate at the voted alignment.
+    std::vector<FingerprintMatch> matches;
+    for (const Candidate& candidate : candidates) {
+        const AcousticFingerprint& other = stored.at(candidate.track_id);
+        float similarity = FingerprintSimilarity(fingerprint, other, candidate.offset);
+        if (similarity >= min_similarity) {
+            matches.push_back({candidate.track_id, candidate.offset, similarity});
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const FingerprintMatch& a, const FingerprintMatch& b) { return a.similarity > b.similarity; });
+    if (matches.size() > max_results) {
+        matches.resize(max_results);
+    }
+    return matches;
+}
+
+void FingerprintIndex::Clear() {
+    buckets.clear();
+    stored.clear();
+}
+
+std::vector<std::vector<uint32_t>> FindNearDuplicateGroups(const std::vector<AcousticFingerprint>& fingerprints, float min_similarity, ThreadPool& pool) {
+    FingerprintIndex index;
+    for (uint32_t i = 0; i < fingerprints.size(); ++i) {
+        if (!fingerprints[i].sub_fingerprints.empty()) {
+            index.Add(i, fingerprints[i]);
+        }
+    }
+
+    // The index is read-only from here on, so queries fan out over the pool in chunks.
+    const size_t chunk_size = std::max<size_t>(1, fingerprints.size() / (pool.GetThreadCount() * 4));
+    std::vector<std::future<std::vector<std::pair<uint32_t, uint32_t>>>> chunk_results;
+    for (size_t begin = 0; begin < fingerprints.size(); begin += chunk_size) {
+        size_t end = std::min(fingerprints.size(), begin + chunk_size);
+        chunk_results.push_back(pool.Submit([&index, &fingerprints, min_similarity, begin, end] {
+            std::vector<std::pair<uint32_t, uint32_t>> edges;
+            for (size_t i = begin; i < end; ++i) {
+                if (fingerprints[i].sub_fingerprints.empty()) {
+                    continue;
+                }
+                for (const FingerprintMatch& match : index.Query(fingerprints[i], min_similarity)) {
+                    if (match.track_id != i) {
+                        edges.emplace_back(static_cast<uint32_t>(i), match.track_id);
+                    }
+                }
+            }
+            return edges;
+        }));
+    }
+
+    std::vector<uint32_t> parent(fingerprints.size());
+    for (uint32_t i = 0; i < parent.size(); ++i) {
+        parent[i] = i;
+    }
+    auto find_root = [&parent](uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    for (auto& chunk : chunk_results) {
+        for (const auto& [a, b] : chunk.get()) {
+            parent[find_root(a)] = find_root(b);
+        }
+    }
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> by_root;
+    for (uint32_t i = 0; i < parent.size(); ++i) {
+        by_root[find_root(i)].push_back(i);
+    }
+    std::vector<std::vector<uint32_t>> groups;
+    for (auto& [root, members] : by_root) {
+        if (members.size() > 1) {
+            groups.push_back(std::move(members));
+        }
+    }
+    std::sort(groups.begin(), groups.end());
+    return groups;
+}
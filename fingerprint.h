@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Chromaprint-style acoustic fingerprints: mono 11.025 kHz audio -> STFT -> 12-bin chroma ->
+// one 32-bit sub-fingerprint per hop. Re-encodes of the same recording produce fingerprints
+// with a low bit error rate even though their bytes differ completely.
+
+constexpr uint32_t kFingerprintSampleRate = 11025;
+constexpr size_t kFingerprintFrameSize = 4096;
+constexpr size_t kFingerprintHopSize = kFingerprintFrameSize / 3;
+constexpr double kFingerprintMaxSeconds = 120.0;
+
+struct AcousticFingerprint {
+    std::vector<uint32_t> sub_fingerprints;
+};
+
+bool ComputeAcousticFingerprint(const std::string& filepath, AcousticFingerprint& fingerprint_out);
+void ComputeAcousticFingerprintFromSamples(const float* mono_samples, size_t sample_count, AcousticFingerprint& fingerprint_out);
+
+// Fraction of matching bits (0..1) between two fingerprints at a given alignment.
+float FingerprintSimilarity(const AcousticFingerprint& a, const AcousticFingerprint& b, int offset_b);
+
+struct FingerprintMatch {
+    uint32_t track_id = 0;
+    int offset = 0;          // Alignment of the match relative to the query, in sub-fingerprints
+    float similarity = 0.0f;
+};
+
+// Inverted index over masked sub-fingerprints for near-duplicate lookups.
+// Only the first kIndexedSubFingerprints of each track are kept (every kIndexStride-th one is
+// posted), which bounds memory to roughly 2 KB of fingerprint + 1 KB of postings per track.
+class FingerprintIndex {
+public:
+    static constexpr size_t kIndexedSubFingerprints = 480; // ~60 s
+    static constexpr size_t kIndexStride = 4;
+    static constexpr uint32_t kKeyMask = 0xFF000FFFu;     // Drops the noisier temporal-onset bits
+    static constexpr size_t kMaxBucketSize = 4096;         // Keys this common carry no information
+
+    void Add(uint32_t track_id, const AcousticFingerprint& fingerprint);
+    std::vector<FingerprintMatch> Query(const AcousticFingerprint& fingerprint, float min_similarity, size_t max_results = 16) const;
+    void Clear();
+    size_t GetTrackCount() const { return stored.size(); }
+
+private:
+    struct Posting {
+        uint32_t track_id;
+        uint32_t offset;
+    };
+    std::unordered_map<uint32_t, std::vector<Posting>> buckets;
+    std::unordered_map<uint32_t, AcousticFingerprint> stored;
+};
+
+class ThreadPool;
+
+// Groups tracks whose fingerprints match each other (transitively). Queries run on `pool`.
+std::vector<std::vector<uint32_t>> FindNearDuplicateGroups(const std::vector<AcousticFingerprint>& fingerprints, float min_similarity, ThreadPool& pool);
@@ -0,0 +1,62 @@
+#include "frame_profiler.h"
+
+#if AUDIOPLAYER_PROFILER
+
+#include <algorithm>
+
+namespace {
+
+ProfilerSummary Summarize(const std::array<float, kProfilerHistory>& values, size_t count) {
+    ProfilerSummary summary;
+    if (count == 0) {
+        return summary;
+    }
+    float total = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        total += values[i];
+        summary.max_ms = std::max(summary.max_ms, values[i]);
+    }
+    summary.average_ms = total / static_cast<float>(count);
+    return summary;
+}
+
+} // namespace
+
+const char* GetFrameSectionName(FrameSection section) {
+    switch (section) {
+    case FrameSection::PollEvents: return "glfwPollEvents";
+    case FrameSection::MusicLoad: return "ProcessAsyncMusicLoadCompletion";
+    case FrameSection::AudioEvents: return "ProcessAudioEvents";
+    case FrameSection::OtherEvents: return "Other completions";
+    case FrameSection::RenderUI: return "RenderUI";
+    case FrameSection::ImGuiRender: return "ImGui::Render";
+    case FrameSection::PlatformWindows: return "RenderPlatformWindowsDefault";
+    case FrameSection::Swap: return "glfwSwapBuffers";
+    case FrameSection::Count: break;
+    }
+    return "?";
+}
+
+void BeginProfilerFrame(FrameProfiler& profiler) {
+    const auto now = FrameProfiler::Clock::now();
+    if (profiler.frame_start != FrameProfiler::Clock::time_point{}) {
+        for (size_t section = 0; section < kFrameSectionCount; ++section) {
+            profiler.section_ms[section][profiler.head] = profiler.current_ms[section];
+        }
+        profiler.frame_ms[profiler.head] = std::chrono::duration<float, std::milli>(now - profiler.frame_start).count();
+        profiler.head = (profiler.head + 1) % kProfilerHistory;
+        profiler.count = std::min(profiler.count + 1, kProfilerHistory);
+    }
+    profiler.current_ms.fill(0.0f);
+    profiler.frame_start = now;
+}
+
+ProfilerSummary SummarizeFrameTimes(const FrameProfiler& profiler) {
+    return Summarize(profiler.frame_ms, profiler.count);
+}
+
+ProfilerSummary SummarizeSection(const FrameProfiler& profiler, FrameSection section) {
+    return Summarize(profiler.section_ms[static_cast<size_t>(section)], profiler.count);
+}
+
+#endif
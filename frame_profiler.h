@@ -0,0 +1,81 @@
+#pragma once
+
+// Main-loop frame profiler: scoped timers accumulate per-section time for the current frame and
+// the last kProfilerHistory frames are kept for the overlay. Built into debug builds; release
+// builds compile it out unless AUDIOPLAYER_PROFILER is defined (CMake AUDIOPLAYER_ENABLE_PROFILER).
+
+#if !defined(AUDIOPLAYER_PROFILER) && !defined(NDEBUG)
+#define AUDIOPLAYER_PROFILER 1
+#endif
+
+#if AUDIOPLAYER_PROFILER
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+enum class FrameSection {
+    PollEvents,
+    MusicLoad,     // ProcessAsyncMusicLoadCompletion
+    AudioEvents,   // ProcessAudioEvents
+    OtherEvents,   // The remaining per-frame completions and zone updates
+    RenderUI,
+    ImGuiRender,   // ImGui::Render plus the OpenGL draw
+    PlatformWindows,
+    Swap,
+    Count,
+};
+
+constexpr size_t kFrameSectionCount = static_cast<size_t>(FrameSection::Count);
+constexpr size_t kProfilerHistory = 240; // Four seconds at 60 fps
+
+const char* GetFrameSectionName(FrameSection section);
+
+struct FrameProfiler {
+    using Clock = std::chrono::steady_clock;
+    std::array<std::array<float, kProfilerHistory>, kFrameSectionCount> section_ms{};
+    std::array<float, kProfilerHistory> frame_ms{}; // Start of one frame to the start of the next
+    size_t head = 0;                                // Next slot to write
+    size_t count = 0;
+    std::array<float, kFrameSectionCount> current_ms{};
+    Clock::time_point frame_start{};
+};
+
+// Closes the previous frame (if any) into the history and starts timing a new one.
+void BeginProfilerFrame(FrameProfiler& profiler);
+
+struct ProfilerSummary {
+    float average_ms = 0.0f;
+    float max_ms = 0.0f;
+};
+ProfilerSummary SummarizeFrameTimes(const FrameProfiler& profiler);
+ProfilerSummary SummarizeSection(const FrameProfiler& profiler, FrameSection section);
+
+class ScopedSectionTimer {
+public:
+    ScopedSectionTimer(FrameProfiler& profiler, FrameSection section)
+        : profiler(profiler), section(section), start(FrameProfiler::Clock::now()) {}
+    ~ScopedSectionTimer() {
+        const auto elapsed = FrameProfiler::Clock::now() - start;
+        profiler.current_ms[static_cast<size_t>(section)] += std::chrono::duration<float, std::milli>(elapsed).count();
+    }
+    ScopedSectionTimer(const ScopedSectionTimer&) = delete;
+    ScopedSectionTimer& operator=(const ScopedSectionTimer&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    FrameSection section;
+    FrameProfiler::Clock::time_point start;
+};
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+#define PROFILE_FRAME_BEGIN(profiler) BeginProfilerFrame(profiler)
+#define PROFILE_SECTION(profiler, section) ScopedSectionTimer PROFILER_CONCAT(profile_section_, __LINE__)(profiler, section)
+
+#else
+
+#define PROFILE_FRAME_BEGIN(profiler) ((void)0)
+#define PROFILE_SECTION(profiler, section) ((void)0)
+
+#endif
@@ -0,0 +1,146 @@
+#include "hot_log.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "fmt/args.h"
+
+namespace {
+
+constexpr auto kDrainInterval = std::chrono::milliseconds(5);
+constexpr int64_t kRateWindowNs = 1'000'000'000;
+
+// Bounded multi-producer ring: each cell's sequence says whether it is free for the producer at
+// that position or holds a record for the consumer.
+struct HotLogCell {
+    std::atomic<size_t> sequence;
+    HotLogRecord record;
+};
+
+struct HotLogRing {
+    std::unique_ptr<HotLogCell[]> cells;
+    alignas(64) std::atomic<size_t> enqueue_position{0};
+    alignas(64) size_t dequeue_position = 0; // Drain thread only
+    std::atomic<uint64_t> dropped{0};
+};
+
+HotLogRing g_ring;
+std::jthread g_drain_thread;
+
+int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FormatRecord(const HotLogRecord& record) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    for (uint32_t i = 0; i < record.arg_count; ++i) {
+        const HotLogArg& arg = record.args[i];
+        switch (arg.type) {
+        case HotLogArg::Type::Int: store.push_back(arg.i); break;
+        case HotLogArg::Type::Unsigned: store.push_back(arg.u); break;
+        case HotLogArg::Type::Double: store.push_back(arg.d); break;
+        case HotLogArg::Type::Bool: store.push_back(arg.u != 0); break;
+        case HotLogArg::Type::Text: store.push_back(std::string_view(record.text + arg.text.offset, arg.text.length)); break;
+        }
+    }
+    try {
+        std::string message = fmt::vformat(record.site->format, store);
+        if (record.suppressed > 0) {
+            message += fmt::format(" ({} similar messages suppressed)", record.suppressed);
+        }
+        spdlog::log(record.site->level, "{}", message);
+    } catch (const fmt::format_error& e) {
+        spdlog::error("Bad hot-path log format '{}': {}", record.site->format, e.what());
+    }
+}
+
+void DrainRing() {
+    while (true) {
+        HotLogCell& cell = g_ring.cells[g_ring.dequeue_position & (kHotLogRingRecords - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != g_ring.dequeue_position + 1) {
+            break; // Empty, or the next producer has not committed yet
+        }
+        FormatRecord(cell.record);
+        cell.sequence.store(g_ring.dequeue_position + kHotLogRingRecords, std::memory_order_release);
+        ++g_ring.dequeue_position;
+    }
+}
+
+void DrainLoop(std::stop_token stop_token) {
+    uint64_t reported_drops = 0;
+    while (!stop_token.stop_requested()) {
+        DrainRing();
+        const uint64_t dropped = g_ring.dropped.load(std::memory_order_relaxed);
+        if (dropped != reported_drops) {
+            spdlog::warn("Hot-path log ring full; {} messages lost.", dropped - reported_drops);
+            reported_drops = dropped;
+        }
+        std::this_thread::sleep_for(kDrainInterval);
+    }
+    DrainRing();
+}
+
+} // namespace
+
+void StartHotLog() {
+    if (g_drain_thread.joinable()) {
+        return;
+    }
+    if (!g_ring.cells) {
+        g_ring.cells = std::make_unique<HotLogCell[]>(kHotLogRingRecords);
+        for (size_t i = 0; i < kHotLogRingRecords; ++i) {
+            g_ring.cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    g_drain_thread = std::jthread(DrainLoop);
+}
+
+void StopHotLog() {
+    g_drain_thread = std::jthread(); // Requests stop and joins after a final drain
+}
+
+uint64_t GetHotLogDroppedCount() {
+    return g_ring.dropped.load(std::memory_order_relaxed);
+}
+
+bool AdmitHotLog(HotLogSite& site, uint32_t& suppressed_out) {
+    const int64_t now_ns = NowNanoseconds();
+    int64_t window_start = site.window_start_ns.load(std::memory_order_relaxed);
+    if (now_ns - window_start >= kRateWindowNs &&
+        site.window_start_ns.compare_exchange_strong(window_start, now_ns, std::memory_order_relaxed)) {
+        site.window_count.store(0, std::memory_order_relaxed);
+    }
+    if (site.window_count.fetch_add(1, std::memory_order_relaxed) >= site.max_per_second) {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed_out = site.suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+HotLogRecord* BeginHotLogRecord(size_t& position_out) {
+    if (!g_ring.cells) {
+        return nullptr; // StartHotLog not called
+    }
+    size_t position = g_ring.enqueue_position.load(std::memory_order_relaxed);
+    while (true) {
+        HotLogCell& cell = g_ring.cells[position & (kHotLogRingRecords - 1)];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (g_ring.enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                position_out = position;
+                return &cell.record;
+            }
+        } else if (sequence < position) {
+            g_ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr; // Full
+        } else {
+            position = g_ring.enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void CommitHotLogRecord(size_t position) {
+    g_ring.cells[position & (kHotLogRingRecords - 1)].sequence.store(position + 1, std::memory_order_release);
+}
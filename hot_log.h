@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "spdlog/spdlog.h"
+
+// Logging for the UI and audio threads. A HOT_LOG_* call records a pointer to its call site (level
+// and format string) plus up to kHotLogMaxArgs arguments in binary form into a lock-free ring; a
+// background thread formats the records and passes them to spdlog. Each call site lets through at
+// most kHotLogSiteBurst messages per second and reports how many it dropped on the next one that
+// gets through. Levels below AUDIOPLAYER_HOT_LOG_LEVEL compile to nothing. String arguments are
+// copied (truncated to kHotLogTextBytes in total), so a call never allocates.
+
+#ifndef AUDIOPLAYER_HOT_LOG_LEVEL
+#ifdef NDEBUG
+#define AUDIOPLAYER_HOT_LOG_LEVEL SPDLOG_LEVEL_INFO
+#else
+#define AUDIOPLAYER_HOT_LOG_LEVEL SPDLOG_LEVEL_DEBUG
+#endif
+#endif
+
+constexpr size_t kHotLogMaxArgs = 4;
+constexpr size_t kHotLogTextBytes = 128;
+constexpr uint32_t kHotLogSiteBurst = 10;
+constexpr size_t kHotLogRingRecords = 4096; // Power of two
+
+struct HotLogSite {
+    spdlog::level::level_enum level;
+    const char* format;
+    uint32_t max_per_second = kHotLogSiteBurst;
+    std::atomic<int64_t> window_start_ns{0};
+    std::atomic<uint32_t> window_count{0};
+    std::atomic<uint32_t> suppressed{0};
+};
+
+struct HotLogArg {
+    enum class Type : uint8_t { Int, Unsigned, Double, Bool, Text };
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        struct {
+            uint16_t offset;
+            uint16_t length;
+        } text;
+    };
+};
+
+struct HotLogRecord {
+    const HotLogSite* site;
+    uint32_t suppressed;
+    uint32_t arg_count;
+    HotLogArg args[kHotLogMaxArgs];
+    uint32_t text_used;
+    char text[kHotLogTextBytes];
+};
+
+// Starts the formatting thread; StopHotLog drains what is left. Call around the spdlog lifetime.
+void StartHotLog();
+void StopHotLog();
+uint64_t GetHotLogDroppedCount(); // Records lost to a full ring
+
+// Internals used by the macros.
+bool AdmitHotLog(HotLogSite& site, uint32_t& suppressed_out);
+HotLogRecord* BeginHotLogRecord(size_t& position_out); // Null when the ring is full
+void CommitHotLogRecord(size_t position);
+
+inline void EncodeHotLogArg(HotLogRecord& record, HotLogArg& arg, std::string_view value) {
+    const size_t length = std::min(value.size(), kHotLogTextBytes - record.text_used);
+    std::memcpy(record.text + record.text_used, value.data(), length);
+    arg.type = HotLogArg::Type::Text;
+    arg.text.offset = static_cast<uint16_t>(record.text_used);
+    arg.text.length = static_cast<uint16_t>(length);
+    record.text_used += static_cast<uint32_t>(length);
+}
+
+template <typename T>
+void EncodeHotLogArg(HotLogRecord& record, HotLogArg& arg, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        arg.type = HotLogArg::Type::Bool;
+        arg.u = value ? 1 : 0;
+    } else if constexpr (std::is_enum_v<T>) {
+        arg.type = HotLogArg::Type::Int;
+        arg.i = static_cast<int64_t>(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        arg.type = HotLogArg::Type::Int;
+        arg.i = value;
+    } else if constexpr (std::is_integral_v<T>) {
+        arg.type = HotLogArg::Type::Unsigned;
+        arg.u = value;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        arg.type = HotLogArg::Type::Double;
+        arg.d = value;
+    } else {
+        static_assert(std::is_convertible_v<const T&, std::string_view>, "HOT_LOG arguments must be numbers, bools or strings");
+        EncodeHotLogArg(record, arg, std::string_view(value));
+    }
+}
+
+template <typename... Args>
+void WriteHotLog(HotLogSite& site, const Args&... args) {
+    static_assert(sizeof...(Args) <= kHotLogMaxArgs, "Too many HOT_LOG arguments");
+    uint32_t suppressed = 0;
+    if (!AdmitHotLog(site, suppressed)) {
+        return;
+    }
+    size_t position = 0;
+    HotLogRecord* record = BeginHotLogRecord(position);
+    if (!record) {
+        return;
+    }
+    record->site = &site;
+    record->suppressed = suppressed;
+    record->arg_count = sizeof...(Args);
+    record->text_used = 0;
+    size_t index = 0;
+    (EncodeHotLogArg(*record, record->args[index++], args), ...);
+    CommitHotLogRecord(position);
+}
+
+// The dead `if` only type-checks the format string against the arguments at compile time.
+#define HOT_LOG_AT(level_value, level_enum, format, ...)                                                      \
+    do {                                                                                                       \
+        if constexpr (level_value >= AUDIOPLAYER_HOT_LOG_LEVEL) {                                              \
+            if (false) {                                                                                       \
+                (void)fmt::formatted_size(format __VA_OPT__(, ) __VA_ARGS__);                                  \
+            }                                                                                                  \
+            static HotLogSite hot_log_site{level_enum, format};                                                \
+            WriteHotLog(hot_log_site __VA_OPT__(, ) __VA_ARGS__);                                              \
+        }                                                                                                      \
+    } while (0)
+#define HOT_LOG_DEBUG(format, ...) HOT_LOG_AT(SPDLOG_LEVEL_DEBUG, spdlog::level::debug, format __VA_OPT__(, ) __VA_ARGS__)
+#define HOT_LOG_INFO(format, ...) HOT_LOG_AT(SPDLOG_LEVEL_INFO, spdlog::level::info, format __VA_OPT__(, ) __VA_ARGS__)
+#define HOT_LOG_WARN(format, ...) HOT_LOG_AT(SPDLOG_LEVEL_WARN, spdlog::level::warn, format __VA_OPT__(, ) __VA_ARGS__)
+#define HOT_LOG_ERROR(format, ...) HOT_LOG_AT(SPDLOG_LEVEL_ERROR, spdlog::level::err, format __VA_OPT__(, ) __VA_ARGS__)
@@ -0,0 +1,391 @@
+#include "http_stream.h"
+
+#include "event_log.h"
+#include "hot_log.h"
+#include "pcm_ring.h"
+#include "trace.h"
+#include "wav_format.h"
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+#if defined(__linux__)
+namespace {
+
+constexpr size_t kMaxRequestBytes = 8192;
+
+// --- Encoder ---
+// Waits for a full chunk in the ring, converts it to s16 and hands it to the server loop.
+void EncoderLoop(std::stop_token stop_token, HttpStream* stream) {
+    SetTraceThreadName("Stream Encoder");
+    const ma_uint32 channels = stream->channels;
+    while (!stop_token.stop_requested()) {
+        if (ma_pcm_rb_available_read(&stream->ring) < kHttpStreamChunkFrames) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        auto chunk = std::make_shared<std::vector<char>>(static_cast<size_t>(kHttpStreamChunkFrames) * channels * sizeof(int16_t));
+        auto* out = reinterpret_cast<int16_t*>(chunk->data());
+        ma_uint32 converted = 0;
+        while (converted < kHttpStreamChunkFrames) {
+            ma_uint32 count = kHttpStreamChunkFrames - converted;
+            void* frames = nullptr;
+            if (ma_pcm_rb_acquire_read(&stream->ring, &count, &frames) != MA_SUCCESS || count == 0) {
+                break;
+            }
+            ma_pcm_f32_to_s16(out + static_cast<size_t>(converted) * channels, frames, static_cast<ma_uint64>(count) * channels,
+                              ma_dither_mode_triangle);
+            ma_pcm_rb_commit_read(&stream->ring, count);
+            converted += count;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stream->chunk_mutex);
+            stream->ready_chunks.push_back(std::move(chunk));
+        }
+        stream->stats.chunks_encoded.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t signal = 1;
+        (void)!write(stream->wake_fd, &signal, sizeof(signal));
+    }
+}
+
+// --- Server ---
+struct HttpClient {
+    int fd = -1;
+    std::string request;
+    bool streaming = false;
+    std::deque<HttpStreamChunk> queue;
+    size_t offset = 0; // Bytes of queue.front() already sent
+};
+
+// Sends as much of the client's queue as the socket takes, straight from the shared chunks.
+// False if the connection failed.
+bool FlushClient(HttpClient& client, HttpStreamStats& stats) {
+    constexpr size_t kMaxIov = 16;
+    while (!client.queue.empty()) {
+        iovec iov[kMaxIov];
+        size_t iov_count = 0;
+        for (auto it = client.queue.begin(); it != client.queue.end() && iov_count < kMaxIov; ++it, ++iov_count) {
+            const size_t skip = iov_count == 0 ? client.offset : 0;
+            iov[iov_count].iov_base = const_cast<char*>((*it)->data() + skip);
+            iov[iov_count].iov_len = (*it)->size() - skip;
+        }
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = iov_count;
+        const ssize_t sent = sendmsg(client.fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        stats.bytes_sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+        size_t remaining = static_cast<size_t>(sent);
+        while (remaining > 0) {
+            const size_t left = client.queue.front()->size() - client.offset;
+            if (remaining < left) {
+                client.offset += remaining;
+                break;
+            }
+            remaining -= left;
+            client.queue.pop_front();
+            client.offset = 0;
+        }
+    }
+    return true;
+}
+
+// Reads the request; once the headers are complete, a GET starts the stream. False to disconnect.
+bool ReadClientRequest(HttpStream& stream, HttpClient& client) {
+    char buffer[1024];
+    while (true) {
+        const ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            break;
+        }
+        if (!client.streaming) {
+            client.request.append(buffer, static_cast<size_t>(received));
+        }
+    }
+    if (client.streaming || client.request.find("\r\n\r\n") == std::string::npos) {
+        return client.request.size() <= kMaxRequestBytes;
+    }
+    if (!client.request.starts_with("GET ")) {
+        static const char kNotAllowed[] = "HTTP/1.0 405 Method Not Allowed\r\nAllow: GET\r\nConnection: close\r\n\r\n";
+        (void)!send(client.fd, kNotAllowed, sizeof(kNotAllowed) - 1, MSG_NOSIGNAL);
+        return false;
+    }
+    client.streaming = true;
+    client.request.clear();
+    client.request.shrink_to_fit();
+    client.queue.push_back(stream.response_header);
+    stream.stats.listeners.fetch_add(1, std::memory_order_relaxed);
+    return FlushClient(client, stream.stats);
+}
+
+void CloseClient(HttpStream& stream, std::unordered_map<int, HttpClient>& clients, int fd) {
+    auto it = clients.find(fd);
+    if (it == clients.end()) {
+        return;
+    }
+    if (it->second.streaming) {
+        stream.stats.listeners.fetch_sub(1, std::memory_order_relaxed);
+    }
+    epoll_ctl(stream.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    clients.erase(it);
+}
+
+void AcceptClients(HttpStream& stream, std::unordered_map<int, HttpClient>& clients) {
+    while (true) {
+        const int fd = accept4(stream.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // EAGAIN: backlog drained
+        }
+        if (static_cast<int>(clients.size()) >= kHttpStreamMaxListeners) {
+            close(fd);
+            continue;
+        }
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        // Edge-triggered for both directions: a socket is only revisited when it can make progress.
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        if (epoll_ctl(stream.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        clients[fd].fd = fd;
+    }
+}
+
+// Appends newly encoded chunks to every listener's queue and pushes them out.
+void DistributeChunks(HttpStream& stream, std::unordered_map<int, HttpClient>& clients, std::vector<HttpStreamChunk>& incoming) {
+    uint64_t signal_count = 0;
+    (void)!read(stream.wake_fd, &signal_count, sizeof(signal_count));
+    {
+        std::lock_guard<std::mutex> lock(stream.chunk_mutex);
+        incoming.swap(stream.ready_chunks);
+    }
+    std::vector<int> to_close;
+    for (auto& [fd, client] : clients) {
+        if (!client.streaming) {
+            continue;
+        }
+        if (client.queue.size() + incoming.size() > kHttpStreamMaxQueuedChunks) {
+            stream.stats.listeners_dropped.fetch_add(1, std::memory_order_relaxed);
+            to_close.push_back(fd);
+            continue;
+        }
+        client.queue.insert(client.queue.end(), incoming.begin(), incoming.end());
+        if (!FlushClient(client, stream.stats)) {
+            to_close.push_back(fd);
+        }
+    }
+    incoming.clear();
+    for (int fd : to_close) {
+        CloseClient(stream, clients, fd);
+    }
+}
+
+void ServerLoop(std::stop_token stop_token, HttpStream* stream) {
+    SetTraceThreadName("Stream Server");
+    std::unordered_map<int, HttpClient> clients;
+    std::vector<HttpStreamChunk> incoming;
+    epoll_event events[64];
+    while (!stop_token.stop_requested()) {
+        const int ready = epoll_wait(stream->epoll_fd, events, 64, 100);
+        for (int i = 0; i < ready; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == stream->listen_fd) {
+                AcceptClients(*stream, clients);
+                continue;
+            }
+            if (fd == stream->wake_fd) {
+                DistributeChunks(*stream, clients, incoming);
+                continue;
+            }
+            auto it = clients.find(fd);
+            if (it == clients.end()) {
+                continue;
+            }
+            bool keep = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0;
+            if (keep && (events[i].events & (EPOLLIN | EPOLLRDHUP))) {
+                keep = ReadClientRequest(*stream, it->second);
+            }
+            if (keep && (events[i].events & EPOLLOUT)) {
+                keep = FlushClient(it->second, stream->stats);
+            }
+            if (!keep) {
+                CloseClient(*stream, clients, fd);
+            }
+        }
+    }
+    while (!clients.empty()) {
+        CloseClient(*stream, clients, clients.begin()->first);
+    }
+}
+
+void CloseDescriptors(HttpStream& stream) {
+    for (int* fd : {&stream.listen_fd, &stream.epoll_fd, &stream.wake_fd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+bool OpenListener(HttpStream& stream, uint16_t port, bool allow_remote) {
+    stream.listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    stream.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    stream.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stream.listen_fd < 0 || stream.epoll_fd < 0 || stream.wake_fd < 0) {
+        spdlog::error("HTTP stream: failed to create descriptors: {}", std::strerror(errno));
+        return false;
+    }
+    const int enable = 1;
+    setsockopt(stream.listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(allow_remote ? INADDR_ANY : INADDR_LOOPBACK);
+    if (bind(stream.listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(stream.listen_fd, 64) != 0) {
+        spdlog::error("HTTP stream: cannot listen on port {}: {}", port, std::strerror(errno));
+        return false;
+    }
+    for (int fd : {stream.listen_fd, stream.wake_fd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(stream.epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+    return true;
+}
+
+HttpStreamChunk BuildResponseHeader(ma_uint32 channels, ma_uint32 sample_rate) {
+    static const char kHeaders[] = "HTTP/1.0 200 OK\r\n"
+                                   "Content-Type: audio/wav\r\n"
+                                   "Cache-Control: no-cache, no-store\r\n"
+                                   "Connection: close\r\n"
+                                   "icy-name: AudioPlayer\r\n"
+                                   "\r\n";
+    const auto wav_header = BuildWavHeader(channels, sample_rate, 16, false, kWavUnknownSize);
+    auto header = std::make_shared<std::vector<char>>(kHeaders, kHeaders + sizeof(kHeaders) - 1);
+    header->insert(header->end(), wav_header.begin(), wav_header.end());
+    return header;
+}
+
+} // namespace
+#endif
+
+bool StartHttpStream(HttpStream& stream, ma_uint32 channels, ma_uint32 sample_rate, uint16_t port, bool allow_remote) {
+#if defined(__linux__)
+    if (stream.running) {
+        return true;
+    }
+    if (stream.ring_initialized && (stream.channels != channels || stream.sample_rate != sample_rate)) {
+        spdlog::error("HTTP stream: output format changed; restart the player to stream.");
+        return false;
+    }
+    if (!stream.ring_initialized) {
+        // Allocated once and kept: the audio thread may still be inside a write when a stream stops.
+        ma_result result = ma_pcm_rb_init(ma_format_f32, channels, kHttpStreamRingFrames, nullptr, nullptr, &stream.ring);
+        if (result != MA_SUCCESS) {
+            spdlog::error("HTTP stream: failed to allocate ring buffer: {}", ma_result_description(result));
+            return false;
+        }
+        stream.ring_initialized = true;
+    }
+    ma_pcm_rb_reset(&stream.ring);
+    stream.channels = channels;
+    stream.sample_rate = sample_rate;
+    stream.port = port;
+    if (!OpenListener(stream, port, allow_remote)) {
+        CloseDescriptors(stream);
+        return false;
+    }
+    stream.response_header = BuildResponseHeader(channels, sample_rate);
+    stream.ready_chunks.clear();
+    stream.stats.dropped_frames.store(0);
+    stream.server_thread = std::jthread(ServerLoop, &stream);
+    stream.encoder_thread = std::jthread(EncoderLoop, &stream);
+    stream.capturing.store(true, std::memory_order_release);
+    stream.running = true;
+    LogEvent(EventType::StreamStarted, port);
+    spdlog::info("HTTP stream listening on {}:{} ({} ch, {} Hz, 16-bit WAV).", allow_remote ? "0.0.0.0" : "127.0.0.1", port, channels,
+                 sample_rate);
+    return true;
+#else
+    (void)stream;
+    (void)channels;
+    (void)sample_rate;
+    (void)port;
+    (void)allow_remote;
+    spdlog::error("HTTP streaming is only available on Linux.");
+    return false;
+#endif
+}
+
+void StopHttpStream(HttpStream& stream) {
+    if (!stream.running) {
+        return;
+    }
+    stream.capturing.store(false, std::memory_order_release);
+    LogEvent(EventType::StreamStopped, stream.stats.listeners.load(), stream.stats.bytes_sent.load() / (1024.0 * 1024.0));
+    stream.encoder_thread = std::jthread(); // Requests stop and joins
+    stream.server_thread = std::jthread();
+#if defined(__linux__)
+    CloseDescriptors(stream);
+#endif
+    stream.ready_chunks.clear();
+    stream.running = false;
+    spdlog::info("HTTP stream stopped ({:.1f} MB sent).", stream.stats.bytes_sent.load() / (1024.0 * 1024.0));
+}
+
+void UninitializeHttpStream(HttpStream& stream) {
+    StopHttpStream(stream);
+    if (stream.ring_initialized) {
+        ma_pcm_rb_uninit(&stream.ring);
+        stream.ring_initialized = false;
+    }
+}
+
+void WriteHttpStreamFrames(HttpStream& stream, const float* frames, ma_uint64 frame_count) {
+    if (!stream.capturing.load(std::memory_order_acquire)) {
+        return;
+    }
+    const ma_uint64 written = WritePcmRing(&stream.ring, stream.channels, frames, frame_count);
+    if (written < frame_count) {
+        stream.stats.dropped_frames.fetch_add(frame_count - written, std::memory_order_relaxed);
+        HOT_LOG_WARN("HTTP stream: ring buffer full, dropped {} frames.", frame_count - written);
+    }
+}
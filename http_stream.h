@@ -0,0 +1,61 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Live HTTP stream of the engine output, Icecast-style: clients GET any path and receive an
+// endless WAV stream. The audio thread copies the mix into a lock-free ring; an encoder thread
+// turns it into fixed-size chunks, and a single epoll loop sends each chunk to every listener.
+// Chunks are immutable and shared, so an extra listener costs a reference, not a copy.
+// The stream is 16-bit PCM, as no compressed encoder is bundled. Linux only (epoll).
+
+using HttpStreamChunk = std::shared_ptr<const std::vector<char>>;
+
+constexpr uint16_t kHttpStreamDefaultPort = 8000;
+constexpr ma_uint32 kHttpStreamChunkFrames = 2048;  // ~43 ms at 48 kHz
+constexpr ma_uint32 kHttpStreamRingFrames = 65536;  // Over a second of slack for the encoder
+constexpr size_t kHttpStreamMaxQueuedChunks = 96;   // A listener further behind than this is dropped
+constexpr int kHttpStreamMaxListeners = 256;
+
+struct HttpStreamStats {
+    std::atomic<int> listeners{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> chunks_encoded{0};
+    std::atomic<uint64_t> dropped_frames{0};     // Ring overruns on the audio thread
+    std::atomic<uint64_t> listeners_dropped{0};  // Disconnected for falling too far behind
+};
+
+struct HttpStream {
+    ma_pcm_rb ring{};
+    bool ring_initialized = false;
+    ma_uint32 channels = 0;
+    ma_uint32 sample_rate = 0;
+    uint16_t port = kHttpStreamDefaultPort;
+    std::atomic<bool> capturing{false};
+    bool running = false;
+
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    int wake_fd = -1; // eventfd the encoder signals when chunks are ready
+    std::mutex chunk_mutex;
+    std::vector<HttpStreamChunk> ready_chunks; // Encoder -> server hand-off
+    HttpStreamChunk response_header;           // HTTP headers plus the WAV header, shared by all listeners
+
+    std::jthread encoder_thread;
+    std::jthread server_thread;
+    HttpStreamStats stats;
+};
+
+// Listens on `port` (loopback only unless `allow_remote`) and starts capturing. False on failure.
+bool StartHttpStream(HttpStream& stream, ma_uint32 channels, ma_uint32 sample_rate, uint16_t port, bool allow_remote);
+void StopHttpStream(HttpStream& stream);
+// Releases the ring. Call once the engine no longer runs the audio callback.
+void UninitializeHttpStream(HttpStream& stream);
+
+// Audio thread: queue `frame_count` interleaved f32 frames. Never blocks or allocates.
+void WriteHttpStreamFrames(HttpStream& stream, const float* frames, ma_uint64 frame_count);
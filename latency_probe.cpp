@@ -0,0 +1,135 @@
+#include "latency_probe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RecordLatency(LatencyProbe& probe, float latency_ms) {
+    const size_t bin = std::min(static_cast<size_t>(std::max(0.0f, latency_ms) / kLatencyHistogramBinMs), kLatencyHistogramBins - 1);
+    probe.histogram[bin].fetch_add(1, std::memory_order_relaxed);
+    const uint32_t count = probe.measurements.load(std::memory_order_relaxed);
+    probe.min_ms.store(count == 0 ? latency_ms : std::min(probe.min_ms.load(std::memory_order_relaxed), latency_ms), std::memory_order_relaxed);
+    probe.max_ms.store(count == 0 ? latency_ms : std::max(probe.max_ms.load(std::memory_order_relaxed), latency_ms), std::memory_order_relaxed);
+    probe.total_ms.store(probe.total_ms.load(std::memory_order_relaxed) + latency_ms, std::memory_order_relaxed);
+    probe.last_ms.store(latency_ms, std::memory_order_relaxed);
+    probe.measurements.store(count + 1, std::memory_order_release);
+}
+
+} // namespace
+
+double GetPlaybackDeviceLatency(const ma_device* device) {
+    if (!device || device->sampleRate == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(device->playback.internalPeriodSizeInFrames) * device->playback.internalPeriods / device->sampleRate;
+}
+
+void StampLatencyClick(LatencyProbe& probe) {
+    if (probe.enabled) {
+        probe.click_ns = NowNanoseconds();
+    }
+}
+
+void ArmLatencyProbe(LatencyProbe& probe, ma_sound* sound, double output_latency_seconds) {
+    if (!probe.enabled || probe.click_ns == 0) {
+        return;
+    }
+    probe.armed.store(0, std::memory_order_relaxed);
+    probe.sound.store(sound, std::memory_order_relaxed);
+    probe.armed_click_ns.store(probe.click_ns, std::memory_order_relaxed);
+    probe.output_latency_ns.store(static_cast<int64_t>(output_latency_seconds * 1e9), std::memory_order_relaxed);
+    probe.sound_start_time.store(ma_sound_get_time_in_pcm_frames(sound), std::memory_order_relaxed);
+    probe.armed.store(probe.next_token++, std::memory_order_release);
+    if (probe.next_token == 0) {
+        probe.next_token = 1;
+    }
+    probe.click_ns = 0;
+}
+
+void DisarmLatencyProbe(LatencyProbe& probe) {
+    probe.armed.store(0, std::memory_order_release);
+}
+
+void ResetLatencyStats(LatencyProbe& probe) {
+    for (auto& bin : probe.histogram) {
+        bin.store(0, std::memory_order_relaxed);
+    }
+    probe.measurements.store(0, std::memory_order_relaxed);
+    probe.timeouts.store(0, std::memory_order_relaxed);
+    probe.last_ms.store(0.0f, std::memory_order_relaxed);
+    probe.min_ms.store(0.0f, std::memory_order_relaxed);
+    probe.max_ms.store(0.0f, std::memory_order_relaxed);
+    probe.total_ms.store(0.0, std::memory_order_relaxed);
+}
+
+double EstimateLatencyPercentile(const LatencyProbe& probe, double fraction) {
+    uint64_t total = 0;
+    for (const auto& bin : probe.histogram) {
+        total += bin.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    const auto target = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kLatencyHistogramBins; ++i) {
+        seen += probe.histogram[i].load(std::memory_order_relaxed);
+        if (seen >= std::max<uint64_t>(target, 1)) {
+            return (i + 1) * kLatencyHistogramBinMs;
+        }
+    }
+    return kLatencyHistogramBins * kLatencyHistogramBinMs;
+}
+
+void ProcessLatencyProbe(LatencyProbe& probe, const float* frames, ma_uint64 frame_count, ma_uint32 channels, ma_uint32 sample_rate) {
+    uint32_t token = probe.armed.load(std::memory_order_acquire);
+    if (token == 0) {
+        return;
+    }
+    if (token != probe.audio_token) {
+        probe.audio_token = token;
+        probe.sound_rendered = false;
+    }
+    const int64_t now_ns = NowNanoseconds();
+    const int64_t click_ns = probe.armed_click_ns.load(std::memory_order_relaxed);
+
+    ma_uint64 first_frame = 0;
+    if (!probe.sound_rendered) {
+        // The sound's local clock only advances while it is rendered, so the first advance marks
+        // the period it entered the mix, and how far into that period it started.
+        ma_sound* sound = probe.sound.load(std::memory_order_relaxed);
+        const ma_uint64 rendered = ma_sound_get_time_in_pcm_frames(sound) - probe.sound_start_time.load(std::memory_order_relaxed);
+        if (rendered == 0) {
+            if (now_ns - click_ns > kLatencyTimeoutNs && probe.armed.compare_exchange_strong(token, 0, std::memory_order_relaxed)) {
+                probe.timeouts.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+        probe.sound_rendered = true;
+        first_frame = rendered < frame_count ? frame_count - rendered : 0;
+    }
+
+    const float* sample = frames + first_frame * channels;
+    for (ma_uint64 frame = first_frame; frame < frame_count; ++frame) {
+        for (ma_uint32 channel = 0; channel < channels; ++channel, ++sample) {
+            if (std::abs(*sample) > kLatencySilenceThreshold) {
+                if (!probe.armed.compare_exchange_strong(token, 0, std::memory_order_relaxed)) {
+                    return; // Re-armed or disarmed by the UI thread meanwhile
+                }
+                const int64_t audible_ns =
+                    now_ns + static_cast<int64_t>(frame * 1'000'000'000ull / sample_rate) + probe.output_latency_ns.load(std::memory_order_relaxed);
+                RecordLatency(probe, static_cast<float>(audible_ns - click_ns) / 1e6f);
+                return;
+            }
+        }
+    }
+    if (now_ns - click_ns > kLatencyTimeoutNs && probe.armed.compare_exchange_strong(token, 0, std::memory_order_relaxed)) {
+        probe.timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+}
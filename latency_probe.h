@@ -0,0 +1,58 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// End-to-end play latency: from a Play/Next click to the first non-silent frame of the new track
+// reaching the device. The UI thread stamps the click and, once the sound has started, arms the
+// probe. The engine process callback watches the sound's local frame counter to find the first
+// period it was rendered into, scans the mix from there for signal, and places that frame at the
+// device using the callback time plus the device's reported latency.
+
+constexpr float kLatencySilenceThreshold = 1e-4f; // -80 dBFS
+constexpr double kLatencyHistogramBinMs = 5.0;
+constexpr size_t kLatencyHistogramBins = 100;      // 0-500 ms; the last bin also counts anything slower
+constexpr int64_t kLatencyTimeoutNs = 5'000'000'000;
+
+struct LatencyProbe {
+    bool enabled = false;  // UI thread only
+    int64_t click_ns = 0;  // UI thread only: the click waiting for its sound to start
+
+    // Armed measurement, published by the UI thread through `armed` (0 = idle).
+    std::atomic<uint32_t> armed{0};
+    uint32_t next_token = 1;
+    std::atomic<ma_sound*> sound{nullptr};
+    std::atomic<int64_t> armed_click_ns{0};
+    std::atomic<int64_t> output_latency_ns{0};
+    std::atomic<ma_uint64> sound_start_time{0}; // Sound's local frame count when armed
+
+    // Audio thread only.
+    uint32_t audio_token = 0;
+    bool sound_rendered = false;
+
+    // Results, written by the audio thread.
+    std::array<std::atomic<uint32_t>, kLatencyHistogramBins> histogram{};
+    std::atomic<uint32_t> measurements{0};
+    std::atomic<uint32_t> timeouts{0};
+    std::atomic<float> last_ms{0.0f};
+    std::atomic<float> min_ms{0.0f};
+    std::atomic<float> max_ms{0.0f};
+    std::atomic<double> total_ms{0.0};
+};
+
+// Output latency the device reports: its internal buffer, in seconds.
+double GetPlaybackDeviceLatency(const ma_device* device);
+
+// UI thread. Stamp on the click; arm after ma_sound_start; disarm before the sound is uninitialised.
+void StampLatencyClick(LatencyProbe& probe);
+void ArmLatencyProbe(LatencyProbe& probe, ma_sound* sound, double output_latency_seconds);
+void DisarmLatencyProbe(LatencyProbe& probe);
+void ResetLatencyStats(LatencyProbe& probe);
+// Latency below which `fraction` of the measurements fall, from the histogram (bin upper edge).
+double EstimateLatencyPercentile(const LatencyProbe& probe, double fraction);
+
+// Audio thread: call from the engine process callback with the rendered mix.
+void ProcessLatencyProbe(LatencyProbe& probe, const float* frames, ma_uint64 frame_count, ma_uint32 channels, ma_uint32 sample_rate);
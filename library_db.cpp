@@ -0,0 +1,145 @@
+#include "library_db.h"
+
+#include <charconv>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr std::string_view kDatabaseHeader = "# AudioPlayer library v2";
+constexpr std::string_view kDatabaseHeaderV1 = "# AudioPlayer library v1"; // No silence bounds
+
+std::vector<std::string_view> SplitTabs(std::string_view line) {
+    std::vector<std::string_view> fields;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string_view::npos ? std::string_view::npos : tab - start));
+        if (tab == std::string_view::npos) {
+            break;
+        }
+        start = tab + 1;
+    }
+    return fields;
+}
+
+template <typename T>
+bool ParseField(std::string_view field, T& value_out) {
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value_out);
+    return result.ec == std::errc{};
+}
+
+} // namespace
+
+bool GetFileStamp(const std::string& filepath, FileStamp& stamp_out) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(filepath, ec);
+    if (ec) {
+        return false;
+    }
+    auto write_time = std::filesystem::last_write_time(filepath, ec);
+    if (ec) {
+        return false;
+    }
+    stamp_out.file_size = size;
+    stamp_out.modified_time = write_time.time_since_epoch().count();
+    return true;
+}
+
+bool LibraryDatabase::Load(const std::filesystem::path& db_path) {
+    records.clear();
+    std::ifstream in(db_path);
+    if (!in) {
+        spdlog::info("No library database at '{}', starting empty.", db_path.string());
+        return false;
+    }
+    std::string line;
+    if (!std::getline(in, line) || (line != kDatabaseHeader && line != kDatabaseHeaderV1)) {
+        spdlog::warn("Library database '{}' has an unknown format, ignoring it.", db_path.string());
+        return false;
+    }
+    const bool has_silence_bounds = line == kDatabaseHeader;
+
+    size_t skipped = 0;
+    while (std::getline(in, line)) {
+        // path, size, mtime, analyzed, bpm, key, key confidence[, silence detected, start, end, rate]
+        auto fields = SplitTabs(line);
+        LibraryRecord record;
+        int analyzed = 0;
+        if (fields.size() < 7 || !ParseField(fields[1], record.file_size) || !ParseField(fields[2], record.modified_time) ||
+            !ParseField(fields[3], analyzed) || !ParseField(fields[4], record.analysis.bpm) ||
+            !ParseField(fields[5], record.analysis.musical_key) || !ParseField(fields[6], record.analysis.key_confidence)) {
+            ++skipped;
+            continue;
+        }
+        record.analyzed = analyzed != 0;
+        SilenceBounds& silence = record.analysis.silence;
+        int silence_detected = 0;
+        if (!has_silence_bounds) {
+            record.analyzed = false; // Re-analyse so v1 rows pick up silence bounds
+        } else if (fields.size() < 11 || !ParseField(fields[7], silence_detected) || !ParseField(fields[8], silence.start_frame) ||
+                   !ParseField(fields[9], silence.end_frame) || !ParseField(fields[10], silence.sample_rate)) {
+            ++skipped;
+            continue;
+        }
+        silence.detected = silence_detected != 0;
+        records.emplace(std::string(fields[0]), record);
+    }
+    if (skipped > 0) {
+        spdlog::warn("Skipped {} malformed library database rows.", skipped);
+    }
+    spdlog::info("Loaded {} library records from '{}'.", records.size(), db_path.string());
+    return true;
+}
+
+bool LibraryDatabase::Save(const std::filesystem::path& db_path) const {
+    // Write to a temporary file and rename so a crash never leaves a truncated database.
+    std::filesystem::path temp_path = db_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        if (!out) {
+            spdlog::error("Could not write library database '{}'.", temp_path.string());
+            return false;
+        }
+        out << kDatabaseHeader << '\n';
+        for (const auto& [path, record] : records) {
+            out << path << '\t' << record.file_size << '\t' << record.modified_time << '\t' << (record.analyzed ? 1 : 0) << '\t'
+                << record.analysis.bpm << '\t' << record.analysis.musical_key << '\t' << record.analysis.key_confidence << '\t'
+                << (record.analysis.silence.detected ? 1 : 0) << '\t' << record.analysis.silence.start_frame << '\t'
+                << record.analysis.silence.end_frame << '\t' << record.analysis.silence.sample_rate << '\n';
+        }
+        if (!out) {
+            spdlog::error("Failed while writing library database '{}'.", temp_path.string());
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, db_path, ec);
+    if (ec) {
+        spdlog::error("Could not replace library database '{}': {}", db_path.string(), ec.message());
+        return false;
+    }
+    spdlog::debug("Saved {} library records to '{}'.", records.size(), db_path.string());
+    return true;
+}
+
+const LibraryRecord* LibraryDatabase::Find(const std::string& filepath) const {
+    auto it = records.find(filepath);
+    return it != records.end() ? &it->second : nullptr;
+}
+
+const LibraryRecord* LibraryDatabase::FindCurrent(const std::string& filepath, const FileStamp& stamp) const {
+    const LibraryRecord* record = Find(filepath);
+    if (record && record->file_size == stamp.file_size && record->modified_time == stamp.modified_time) {
+        return record;
+    }
+    return nullptr;
+}
+
+void LibraryDatabase::Put(const std::string& filepath, const LibraryRecord& record) {
+    records[filepath] = record;
+}
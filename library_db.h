@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+#include "track_analysis.h"
+
+// Persistent per-track metadata cache, stored as a tab-separated file next to the music.
+// Records are keyed by path and invalidated when a file's size or modification time changes.
+
+constexpr const char* kLibraryDatabaseFilename = ".audioplayer_library.tsv";
+
+struct LibraryRecord {
+    uint64_t file_size = 0;
+    int64_t modified_time = 0;
+    bool analyzed = false;
+    TrackAnalysis analysis;
+};
+
+struct FileStamp {
+    uint64_t file_size = 0;
+    int64_t modified_time = 0;
+};
+
+bool GetFileStamp(const std::string& filepath, FileStamp& stamp_out);
+
+class LibraryDatabase {
+public:
+    bool Load(const std::filesystem::path& db_path);
+    bool Save(const std::filesystem::path& db_path) const;
+
+    const LibraryRecord* Find(const std::string& filepath) const;
+    // Returns the record only if it still describes the file on disk.
+    const LibraryRecord* FindCurrent(const std::string& filepath, const FileStamp& stamp) const;
+    void Put(const std::string& filepath, const LibraryRecord& record);
+
+    const std::unordered_map<std::string, LibraryRecord>& GetRecords() const { return records; }
+    size_t GetRecordCount() const { return records.size(); }
+
+private:
+    std::unordered_map<std::string, LibraryRecord> records;
+};
@@ -0,0 +1,273 @@
+#include "limiter_node.h"
+
+#include "dsp.h"
+#include "trace.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr ma_uint32 kLimiterBlockFrames = 256;
+constexpr size_t kTruePeakTaps = 16;
+constexpr ma_uint32 kTruePeakDelay = kTruePeakTaps / 2; // Detection refers to the sample this many frames back
+constexpr int kTruePeakPhases = 3;         // Interpolated points at 1/4, 1/2 and 3/4
+constexpr float kSoftClipKneeRatio = 0.9f; // Soft clipping starts at 90% of the ceiling
+constexpr float kCpuLoadSmoothing = 0.05f;
+
+// Windowed-sinc interpolators for the points between x[n-8] and x[n-7].
+const std::array<std::array<float, kTruePeakTaps>, kTruePeakPhases>& GetTruePeakCoefficients() {
+    static const auto coefficients = [] {
+        std::array<std::array<float, kTruePeakTaps>, kTruePeakPhases> result{};
+        for (int phase = 0; phase < kTruePeakPhases; ++phase) {
+            double fraction = (phase + 1) / 4.0;
+            double sum = 0.0;
+            for (size_t k = 0; k < kTruePeakTaps; ++k) {
+                double x = (kTruePeakDelay - 1.0) + fraction - static_cast<double>(k);
+                double sinc = x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+                double w = x / kTruePeakDelay; // Blackman window over the tap span
+                double window = 0.42 + 0.5 * std::cos(std::numbers::pi * w) + 0.08 * std::cos(2.0 * std::numbers::pi * w);
+                result[phase][k] = static_cast<float>(sinc * window);
+                sum += sinc * window;
+            }
+            for (float& c : result[phase]) {
+                c = static_cast<float>(c / sum);
+            }
+        }
+        return result;
+    }();
+    return coefficients;
+}
+
+void ResetLimiterState(LimiterNode* limiter, float lookahead_ms) {
+    float clamped_ms = std::clamp(lookahead_ms, kLimiterMinLookaheadMs, kLimiterMaxLookaheadMs);
+    limiter->lookahead_frames = std::clamp<ma_uint32>(static_cast<ma_uint32>(std::lround(clamped_ms * limiter->sample_rate / 1000.0f)), 1u,
+                                                      limiter->max_lookahead_frames);
+    limiter->delay_frames = limiter->lookahead_frames + kTruePeakDelay;
+    limiter->applied_lookahead_ms = lookahead_ms;
+    limiter->frame_counter = 0;
+    std::fill(limiter->history.begin(), limiter->history.end(), 0.0f);
+    limiter->deque_head = 0;
+    limiter->deque_size = 0;
+    std::fill(limiter->box_window.begin(), limiter->box_window.begin() + limiter->lookahead_frames, 1.0f);
+    limiter->release_gain = 1.0f;
+    std::fill(limiter->true_peak_history.begin(), limiter->true_peak_history.end(), 0.0f);
+    limiter->true_peak_position = 0;
+}
+
+// Computes one gain per frame for `frame_count` frames of interleaved `input`.
+float ComputeBlockGains(LimiterNode* limiter, const float* input, ma_uint32 frame_count, float ceiling, float release_coefficient) {
+    const auto& coefficients = GetTruePeakCoefficients();
+    const ma_uint32 channels = limiter->channels;
+    const size_t lookahead = limiter->lookahead_frames;
+    const size_t window = lookahead + 1;
+    const size_t deque_capacity = limiter->deque_values.size();
+    float* targets = limiter->box_window.data() + lookahead;
+
+    for (ma_uint32 i = 0; i < frame_count; ++i) {
+        // Detector: sample peak and inter-sample peaks around the frame kTruePeakDelay back.
+        const size_t position = limiter->true_peak_position;
+        float detected = 0.0f;
+        for (ma_uint32 c = 0; c < channels; ++c) {
+            float* ring = &limiter->true_peak_history[c * 2 * kTruePeakTaps];
+            const float sample = input[i * channels + c];
+            ring[position] = sample;
+            ring[position + kTruePeakTaps] = sample;
+            const float* taps = ring + position + 1; // Oldest first
+            detected = std::max(detected, std::fabs(taps[kTruePeakTaps - 1 - kTruePeakDelay]));
+            for (const auto& phase : coefficients) {
+                detected = std::max(detected, std::fabs(DspDotProduct(taps, phase.data(), kTruePeakTaps)));
+            }
+        }
+        limiter->true_peak_position = (position + 1) % kTruePeakTaps;
+
+        // Sliding maximum over the lookahead window: a monotonically decreasing deque.
+        const ma_uint64 frame = limiter->frame_counter++;
+        while (limiter->deque_size > 0) {
+            size_t back = (limiter->deque_head + limiter->deque_size - 1) % deque_capacity;
+            if (limiter->deque_values[back] > detected) {
+                break;
+            }
+            --limiter->deque_size;
+        }
+        size_t slot = (limiter->deque_head + limiter->deque_size) % deque_capacity;
+        limiter->deque_values[slot] = detected;
+        limiter->deque_frames[slot] = frame;
+        ++limiter->deque_size;
+        if (limiter->deque_frames[limiter->deque_head] + window <= frame) {
+            limiter->deque_head = (limiter->deque_head + 1) % deque_capacity;
+            --limiter->deque_size;
+        }
+        const float window_peak = limiter->deque_values[limiter->deque_head];
+        targets[i] = window_peak > ceiling ? ceiling / window_peak : 1.0f;
+    }
+
+    // Box filter over the lookahead: every value it averages already accounts for the peak, so
+    // the smoothed gain is at or below target by the time the peak reaches the output. The window
+    // sum at frame i is the sum before the block plus the running sum of (entering - leaving); the
+    // starting sum is recomputed each block so rounding never accumulates.
+    const float* leaving = limiter->box_window.data();
+    float* attack_gains = limiter->box_gains.data();
+    float window_sum = 0.0f;
+    for (size_t k = 0; k < lookahead; ++k) {
+        window_sum += leaving[k];
+    }
+    DspSubtract(targets, leaving, attack_gains, frame_count);
+    DspPrefixSum(attack_gains, frame_count, window_sum);
+    DspScale(attack_gains, 1.0f / static_cast<float>(lookahead), frame_count);
+    std::memmove(limiter->box_window.data(), limiter->box_window.data() + frame_count, lookahead * sizeof(float));
+
+    // Release: follow decreases immediately, recover exponentially. Each gain depends on the one
+    // before, so this recursion stays scalar; it is one compare and one multiply-add per frame.
+    float min_gain = 1.0f;
+    float release_gain = limiter->release_gain;
+    for (ma_uint32 i = 0; i < frame_count; ++i) {
+        const float attack_gain = attack_gains[i];
+        if (attack_gain < release_gain) {
+            release_gain = attack_gain;
+        } else {
+            release_gain += (attack_gain - release_gain) * release_coefficient;
+        }
+        limiter->block_gains[i] = release_gain;
+        min_gain = std::min(min_gain, release_gain);
+    }
+    limiter->release_gain = release_gain;
+    return min_gain;
+}
+
+void SoftClip(float* samples, size_t count, float ceiling) {
+    const float knee = ceiling * kSoftClipKneeRatio;
+    if (DspPeakAbs(samples, count) <= knee) {
+        return; // Common case: nothing near the ceiling
+    }
+    const float range = ceiling - knee;
+    for (size_t i = 0; i < count; ++i) {
+        float magnitude = std::fabs(samples[i]);
+        if (magnitude > knee) {
+            float shaped = knee + range * std::tanh((magnitude - knee) / range);
+            samples[i] = std::copysign(shaped, samples[i]);
+        }
+    }
+}
+
+void ProcessLimiterNode(ma_node* node, const float** frames_in, ma_uint32* frame_count_in, float** frames_out, ma_uint32* frame_count_out) {
+    TRACE_SCOPE("ProcessLimiterNode");
+    (void)frame_count_in;
+    auto* limiter = static_cast<LimiterNode*>(node);
+    const auto process_start = std::chrono::steady_clock::now();
+    const ma_uint32 channels = limiter->channels;
+    const ma_uint32 frame_count = *frame_count_out;
+    const float* input = (frames_in != nullptr) ? frames_in[0] : nullptr;
+    float* output = frames_out[0];
+
+    const bool enabled = limiter->enabled.load(std::memory_order_relaxed);
+    if (!enabled) {
+        if (input) {
+            std::memcpy(output, input, static_cast<size_t>(frame_count) * channels * sizeof(float));
+        } else {
+            std::memset(output, 0, static_cast<size_t>(frame_count) * channels * sizeof(float));
+        }
+        limiter->was_enabled = false;
+        limiter->gain_reduction_db.store(0.0f, std::memory_order_relaxed);
+        return;
+    }
+
+    const float lookahead_ms = limiter->lookahead_ms.load(std::memory_order_relaxed);
+    if (lookahead_ms != limiter->applied_lookahead_ms || !limiter->was_enabled) {
+        ResetLimiterState(limiter, lookahead_ms);
+        limiter->was_enabled = true;
+    }
+    const float ceiling = std::pow(10.0f, limiter->ceiling_db.load(std::memory_order_relaxed) / 20.0f);
+    const float release_frames = std::max(1.0f, limiter->release_ms.load(std::memory_order_relaxed) * limiter->sample_rate / 1000.0f);
+    const float release_coefficient = 1.0f - std::exp(-1.0f / release_frames);
+    const bool soft_clip = limiter->soft_clip.load(std::memory_order_relaxed);
+
+    float min_gain = 1.0f;
+    const size_t delay_samples = static_cast<size_t>(limiter->delay_frames) * channels;
+    for (ma_uint32 offset = 0; offset < frame_count; offset += kLimiterBlockFrames) {
+        const ma_uint32 block = std::min(kLimiterBlockFrames, frame_count - offset);
+        const size_t block_samples = static_cast<size_t>(block) * channels;
+        float* block_input = limiter->history.data() + delay_samples;
+        if (input) {
+            std::memcpy(block_input, input + static_cast<size_t>(offset) * channels, block_samples * sizeof(float));
+        } else {
+            std::memset(block_input, 0, block_samples * sizeof(float));
+        }
+
+        min_gain = std::min(min_gain, ComputeBlockGains(limiter, block_input, block, ceiling, release_coefficient));
+
+        // Apply gains to the delayed audio with the vector kernel, then shift the delay line.
+        float* expanded = limiter->expanded_gains.data();
+        for (ma_uint32 i = 0; i < block; ++i) {
+            std::fill_n(expanded + static_cast<size_t>(i) * channels, channels, limiter->block_gains[i]);
+        }
+        float* block_output = output + static_cast<size_t>(offset) * channels;
+        DspMultiply(limiter->history.data(), expanded, block_output, block_samples);
+        std::memmove(limiter->history.data(), limiter->history.data() + block_samples, delay_samples * sizeof(float));
+
+        if (soft_clip) {
+            SoftClip(block_output, block_samples, ceiling);
+        }
+    }
+
+    limiter->gain_reduction_db.store(20.0f * std::log10(std::max(min_gain, 1e-6f)), std::memory_order_relaxed);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - process_start).count();
+    const double block_duration = static_cast<double>(frame_count) / limiter->sample_rate;
+    float load = limiter->cpu_load.load(std::memory_order_relaxed);
+    load += (static_cast<float>(elapsed / block_duration) - load) * kCpuLoadSmoothing;
+    limiter->cpu_load.store(load, std::memory_order_relaxed);
+}
+
+ma_node_vtable g_limiter_node_vtable = {
+    ProcessLimiterNode,
+    nullptr,
+    1, // Input buses
+    1, // Output buses
+    MA_NODE_FLAG_CONTINUOUS_PROCESSING // Keep flushing the delay line after the input goes quiet
+};
+
+} // namespace
+
+ma_result InitializeLimiterNode(ma_node_graph* node_graph, const LimiterNodeConfig& config, LimiterNode* limiter) {
+    limiter->channels = config.channels;
+    limiter->sample_rate = config.sample_rate;
+    limiter->max_lookahead_frames = static_cast<ma_uint32>(std::ceil(kLimiterMaxLookaheadMs * config.sample_rate / 1000.0f));
+    limiter->lookahead_ms.store(config.lookahead_ms);
+    limiter->ceiling_db.store(config.ceiling_db);
+    limiter->release_ms.store(config.release_ms);
+    limiter->soft_clip.store(config.soft_clip);
+
+    const size_t max_delay_frames = limiter->max_lookahead_frames + kTruePeakDelay;
+    limiter->history.assign((max_delay_frames + kLimiterBlockFrames) * config.channels, 0.0f);
+    limiter->deque_values.assign(limiter->max_lookahead_frames + 2, 0.0f);
+    limiter->deque_frames.assign(limiter->max_lookahead_frames + 2, 0);
+    limiter->box_window.assign(limiter->max_lookahead_frames + kLimiterBlockFrames, 1.0f);
+    limiter->box_gains.assign(kLimiterBlockFrames, 1.0f);
+    limiter->true_peak_history.assign(2 * static_cast<size_t>(kTruePeakTaps) * config.channels, 0.0f);
+    limiter->block_gains.assign(kLimiterBlockFrames, 1.0f);
+    limiter->expanded_gains.assign(static_cast<size_t>(kLimiterBlockFrames) * config.channels, 1.0f);
+    ResetLimiterState(limiter, config.lookahead_ms);
+
+    ma_uint32 bus_channels[1] = {config.channels};
+    ma_node_config node_config = ma_node_config_init();
+    node_config.vtable = &g_limiter_node_vtable;
+    node_config.pInputChannels = bus_channels;
+    node_config.pOutputChannels = bus_channels;
+    ma_result result = ma_node_init(node_graph, &node_config, nullptr, &limiter->base);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Failed to initialize limiter node: {}", ma_result_description(result));
+        return result;
+    }
+    spdlog::info("Limiter node initialized ({} ch, {} Hz, {:.1f} ms lookahead, ceiling {:.1f} dBTP).", config.channels,
+                 config.sample_rate, config.lookahead_ms, config.ceiling_db);
+    return MA_SUCCESS;
+}
+
+void UninitializeLimiterNode(LimiterNode* limiter) {
+    ma_node_uninit(&limiter->base, nullptr);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <atomic>
+#include <vector>
+
+// True-peak lookahead brickwall limiter with a soft clipper, as a custom node placed in front
+// of the engine endpoint. Detection uses 4x polyphase interpolation, a monotonic-deque sliding
+// maximum (O(1) per sample) and a box-filtered attack that reaches the target gain exactly
+// when the peak leaves the delay line. The box filter runs a block at a time on the vector
+// kernels; the release is a recursion and stays per sample. All buffers are allocated at init time.
+
+constexpr float kLimiterMinLookaheadMs = 1.0f;
+constexpr float kLimiterMaxLookaheadMs = 5.0f;
+
+struct LimiterNodeConfig {
+    ma_uint32 channels = 2;
+    ma_uint32 sample_rate = 48000;
+    float lookahead_ms = 2.0f;
+    float ceiling_db = -1.0f;
+    float release_ms = 60.0f;
+    bool soft_clip = true;
+};
+
+struct LimiterNode {
+    ma_node_base base; // Must be first: miniaudio addresses the node through its base
+
+    ma_uint32 channels = 0;
+    ma_uint32 sample_rate = 0;
+    ma_uint32 max_lookahead_frames = 0;
+
+    // Parameters, written from the UI thread and picked up at the next audio block.
+    std::atomic<bool> enabled{true};
+    std::atomic<float> lookahead_ms{2.0f};
+    std::atomic<float> ceiling_db{-1.0f};
+    std::atomic<float> release_ms{60.0f};
+    std::atomic<bool> soft_clip{true};
+
+    // Meters for the UI.
+    std::atomic<float> gain_reduction_db{0.0f};
+    std::atomic<float> cpu_load{0.0f}; // Fraction of real time spent in the node
+
+    // Audio-thread state.
+    float applied_lookahead_ms = -1.0f;
+    bool was_enabled = true;
+    ma_uint32 lookahead_frames = 0;
+    ma_uint32 delay_frames = 0;
+    ma_uint64 frame_counter = 0;
+    std::vector<float> history;            // Interleaved delay line followed by the current block
+    std::vector<float> deque_values;       // Sliding-maximum ring (monotonically decreasing)
+    std::vector<ma_uint64> deque_frames;
+    size_t deque_head = 0;
+    size_t deque_size = 0;
+    std::vector<float> box_window;         // Previous lookahead_frames targets, then the current block's
+    std::vector<float> box_gains;          // Attack gains for the current block
+    float release_gain = 1.0f;
+    std::vector<float> true_peak_history;  // Per channel: a ring of recent input, stored twice so the taps are contiguous
+    size_t true_peak_position = 0;
+    std::vector<float> block_gains;
+    std::vector<float> expanded_gains;     // block_gains repeated per channel for the SIMD multiply
+};
+
+ma_result InitializeLimiterNode(ma_node_graph* node_graph, const LimiterNodeConfig& config, LimiterNode* limiter);
+void UninitializeLimiterNode(LimiterNode* limiter);
@@ -0,0 +1,173 @@
+#include "load_policy.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr size_t kProbeBytes = 4096;
+
+uint32_t GetLe16(const unsigned char* in) {
+    return in[0] | (in[1] << 8);
+}
+
+uint32_t GetLe32(const unsigned char* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+uint32_t GetBe32(const unsigned char* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+}
+
+bool ParseWavHeader(const unsigned char* data, size_t size, TrackLoadInfo& info) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    uint32_t byte_rate = 0;
+    for (size_t offset = 12; offset + 8 <= size;) {
+        const uint32_t chunk_size = GetLe32(data + offset + 4);
+        if (std::memcmp(data + offset, "fmt ", 4) == 0 && offset + 24 <= size) {
+            info.channels = GetLe16(data + offset + 10);
+            info.sample_rate = GetLe32(data + offset + 12);
+            byte_rate = GetLe32(data + offset + 16);
+        } else if (std::memcmp(data + offset, "data", 4) == 0) {
+            if (byte_rate == 0) {
+                return false;
+            }
+            // Streams written live leave the size unknown; the rest of the file is then the data.
+            const uint64_t data_bytes = std::min<uint64_t>(chunk_size, info.file_size - (offset + 8));
+            info.duration_seconds = static_cast<double>(data_bytes) / byte_rate;
+            return true;
+        }
+        offset += 8 + chunk_size + (chunk_size & 1);
+    }
+    return false;
+}
+
+// Layer III only. A Xing/Info header gives the exact frame count; otherwise the bit rate of the
+// first frame is taken as constant.
+bool ParseMp3Header(const unsigned char* data, size_t size, uint64_t audio_start, TrackLoadInfo& info) {
+    static constexpr std::array<uint32_t, 15> kBitratesMpeg1 = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320};
+    static constexpr std::array<uint32_t, 15> kBitratesMpeg2 = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160};
+    static constexpr std::array<uint32_t, 3> kSampleRates = {44100, 48000, 32000};
+
+    for (size_t offset = 0; offset + 4 <= size; ++offset) {
+        const unsigned char* frame = data + offset;
+        if (frame[0] != 0xFF || (frame[1] & 0xE0) != 0xE0) {
+            continue;
+        }
+        const uint32_t version = (frame[1] >> 3) & 3; // 0 = MPEG 2.5, 2 = MPEG 2, 3 = MPEG 1
+        const uint32_t layer = (frame[1] >> 1) & 3;   // 1 = Layer III
+        const uint32_t bitrate_index = frame[2] >> 4;
+        const uint32_t rate_index = (frame[2] >> 2) & 3;
+        if (version == 1 || layer != 1 || bitrate_index == 0 || bitrate_index == 15 || rate_index == 3) {
+            continue;
+        }
+        const bool mpeg1 = version == 3;
+        const bool mono = (frame[3] >> 6) == 3;
+        info.sample_rate = kSampleRates[rate_index] >> (mpeg1 ? 0 : version == 2 ? 1 : 2);
+        info.channels = mono ? 1 : 2;
+        const uint32_t samples_per_frame = mpeg1 ? 1152 : 576;
+
+        const size_t side_info = mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+        const size_t xing = offset + 4 + side_info;
+        if (xing + 12 <= size && (std::memcmp(data + xing, "Xing", 4) == 0 || std::memcmp(data + xing, "Info", 4) == 0) &&
+            (GetBe32(data + xing + 4) & 1) != 0) {
+            info.duration_seconds = static_cast<double>(GetBe32(data + xing + 8)) * samples_per_frame / info.sample_rate;
+            return true;
+        }
+        const uint32_t bitrate_kbps = (mpeg1 ? kBitratesMpeg1 : kBitratesMpeg2)[bitrate_index];
+        const uint64_t audio_bytes = info.file_size > audio_start + offset ? info.file_size - audio_start - offset : 0;
+        info.duration_seconds = static_cast<double>(audio_bytes) * 8.0 / (bitrate_kbps * 1000.0);
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+const char* GetTrackLoadModeName(TrackLoadMode mode) {
+    switch (mode) {
+    case TrackLoadMode::Stream: return "stream";
+    case TrackLoadMode::Decode: return "decode";
+    case TrackLoadMode::Compressed: return "compressed";
+    }
+    return "unknown";
+}
+
+ma_uint32 GetTrackLoadFlags(TrackLoadMode mode) {
+    switch (mode) {
+    case TrackLoadMode::Stream: return MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM;
+    case TrackLoadMode::Decode: return MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE;
+    case TrackLoadMode::Compressed: return 0; // A data buffer holding the encoded file
+    }
+    return MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM;
+}
+
+bool ProbeTrackFile(const std::string& filepath, TrackLoadInfo& info, double& read_ms_out) {
+    std::ifstream in(filepath, std::ios::binary);
+    std::array<unsigned char, kProbeBytes> buffer{};
+    const auto read_start = std::chrono::steady_clock::now();
+    in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    read_ms_out = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - read_start).count();
+    size_t size = static_cast<size_t>(in.gcount());
+    if (size == 0) {
+        return false;
+    }
+    if (ParseWavHeader(buffer.data(), size, info)) {
+        return true;
+    }
+
+    // Skip an ID3v2 tag, which may hold cover art far larger than the probe.
+    uint64_t audio_start = 0;
+    if (size >= 10 && std::memcmp(buffer.data(), "ID3", 3) == 0) {
+        audio_start = 10 + ((buffer[6] & 0x7F) << 21 | (buffer[7] & 0x7F) << 14 | (buffer[8] & 0x7F) << 7 | (buffer[9] & 0x7F));
+        if (buffer[5] & 0x10) {
+            audio_start += 10; // Footer
+        }
+        if (audio_start + 4 > size) {
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(audio_start));
+            in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+            size = static_cast<size_t>(in.gcount());
+        } else {
+            std::memmove(buffer.data(), buffer.data() + audio_start, size - audio_start);
+            size -= static_cast<size_t>(audio_start);
+        }
+    }
+    return ParseMp3Header(buffer.data(), size, audio_start, info);
+}
+
+double EstimateStorageLatency(std::vector<double> read_ms) {
+    if (read_ms.empty()) {
+        return 0.0;
+    }
+    auto middle = read_ms.begin() + read_ms.size() / 2;
+    std::nth_element(read_ms.begin(), middle, read_ms.end());
+    return *middle;
+}
+
+uint64_t EstimateResidentBytes(const TrackLoadInfo& info, TrackLoadMode mode) {
+    switch (mode) {
+    case TrackLoadMode::Stream: return 0;
+    case TrackLoadMode::Decode: return static_cast<uint64_t>(info.duration_seconds * info.sample_rate) * info.channels * sizeof(float);
+    case TrackLoadMode::Compressed: return info.file_size;
+    }
+    return 0;
+}
+
+TrackLoadMode ChooseTrackLoadMode(const TrackLoadInfo& info, const LoadPolicyConfig& config, double storage_latency_ms) {
+    const bool format_known = info.duration_seconds > 0.0 && info.sample_rate > 0 && info.channels > 0;
+    if (format_known && info.duration_seconds <= config.decode_max_seconds &&
+        EstimateResidentBytes(info, TrackLoadMode::Decode) <= config.memory_budget_bytes) {
+        return TrackLoadMode::Decode;
+    }
+    if (info.file_size > 0 && storage_latency_ms >= config.slow_storage_ms && info.file_size <= config.compressed_max_bytes &&
+        info.file_size <= config.memory_budget_bytes) {
+        return TrackLoadMode::Compressed;
+    }
+    return TrackLoadMode::Stream;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How the main player opens a track. Short files (jingles, idents, cues) are decoded into memory
+// up front; files that fit the budget are held in memory still encoded when the storage is slow,
+// so playback never waits on it; everything else, such as hour-long mixes, is streamed.
+
+enum class TrackLoadMode {
+    Stream,     // Decoded a page at a time from storage
+    Decode,     // Fully decoded to PCM in memory
+    Compressed, // Whole file in memory, decoded as it plays
+};
+
+const char* GetTrackLoadModeName(TrackLoadMode mode);
+// MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_* for the mode.
+ma_uint32 GetTrackLoadFlags(TrackLoadMode mode);
+
+struct LoadPolicyConfig {
+    double decode_max_seconds = 30.0;
+    uint64_t compressed_max_bytes = 64ull << 20;
+    double slow_storage_ms = 10.0;              // First-read latency from which long files are held compressed
+    uint64_t memory_budget_bytes = 256ull << 20; // For the one memory-resident track the player holds
+};
+
+// What the scan learnt about a file. Duration and format are zero when unknown.
+struct TrackLoadInfo {
+    uint64_t file_size = 0;
+    int64_t modified_time = 0; // As in FileStamp, so library records can be matched without a stat
+    double duration_seconds = 0.0;
+    uint32_t sample_rate = 0;
+    uint32_t channels = 0;
+};
+
+// Reads the WAV or MP3 header to estimate duration and format (MP3 assumes a constant bit rate).
+// `read_ms_out` receives the time taken by the first read, a sample of the storage latency.
+bool ProbeTrackFile(const std::string& filepath, TrackLoadInfo& info, double& read_ms_out);
+// Median of the read latencies collected while probing, or 0 with none.
+double EstimateStorageLatency(std::vector<double> read_ms);
+
+// Bytes the mode would keep in memory, from the probed size and format (0 for Stream).
+uint64_t EstimateResidentBytes(const TrackLoadInfo& info, TrackLoadMode mode);
+TrackLoadMode ChooseTrackLoadMode(const TrackLoadInfo& info, const LoadPolicyConfig& config, double storage_latency_ms);
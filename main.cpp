@@ -5,14 +5,43 @@
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "miniaudio.h"
+#include <array>
+#include <charconv>
 #include <filesystem>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <future>
 #include <atomic>
 #include <chrono>
+#include <ctime>
 #include <thread>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "event_log.h"
+#include "fingerprint.h"
+#include "frame_profiler.h"
+#include "hot_log.h"
+#include "http_stream.h"
+#include "latency_probe.h"
+#include "library_db.h"
+#include "limiter_node.h"
+#include "load_policy.h"
+#include "output_recorder.h"
+#include "rcu_cell.h"
+#include "resource_jobs.h"
+#include "soundboard.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "track_analysis.h"
+#include "track_prefetch.h"
+#include "track_source.h"
+#include "track_staging.h"
+#include "volume_node.h"
+#include "zones.h"
 
 #include "spdlog/spdlog.h"
 #include "spdlog/async.h"
@@ -27,29 +56,219 @@ void glfw_error_callback(int error, const char* description) {
     spdlog::error("GLFW Error [{}]: {}", error, description);
 }
 
+// Track list from a scan, with what the load policy needs to know about each file.
+struct MusicScanResult {
+    std::vector<std::string> tracks;
+    std::vector<TrackLoadInfo> load_info; // Parallel to tracks
+    double storage_latency_ms = 0.0;
+};
+
+// Main player track lifecycle. Opening runs on the resource manager's job thread and is polled by
+// ProcessTrackOpenCompletion; Ready is opened but paused.
+enum class TrackOpenState { Idle, Opening, Ready, Playing, Failed };
+
+// A library table row in view order, with the analysis columns resolved by the control code.
+struct LibraryRow {
+    int track_index = 0;
+    float bpm = 0.0f; // 0 = not analysed
+    int musical_key = kUnknownKey;
+};
+
+// What the player window renders, published by the control code and never modified once published.
+// The track table is shared between snapshots until the library is rescanned, and the library rows
+// until the view is re-sorted or re-analysed. The Zones, Cue Pads, Recording, HTTP Stream, Limiter,
+// Duplicate Finder and diagnostics panels still read PlayerState directly and must stay on the
+// control thread.
+struct PlayerSnapshot {
+    uint64_t version = 0;
+    std::shared_ptr<const std::vector<std::string>> track_list;
+    uint64_t track_list_version = 0;
+    int current_track_index = 0;
+    bool is_playing = false;
+    float volume = 1.0f;
+    TrackOpenState track_open_state = TrackOpenState::Idle;
+    bool is_loading_music = false;
+    bool startup_complete = false;
+    std::string music_directory;
+    ResamplerQuality resampler_quality = ResamplerQuality::Medium;
+
+    std::shared_ptr<const std::vector<LibraryRow>> library_rows;
+    uint64_t library_view_version = 0;
+    bool is_analyzing_library = false;
+    int analysis_total = 0;
+    bool trim_silence_enabled = true;
+    bool bpm_match_enabled = false;
+    float bpm_match_tolerance = 0.05f;
+};
+
+// Player window actions, queued by the UI and applied by ProcessPlayerCommands on the control side.
+enum class PlayerCommandType {
+    RefreshLibrary,
+    PlayPause,
+    NextTrack,
+    PlayTrack,       // track_index
+    SetVolume,       // value
+    SetResampler,    // index = ResamplerQuality
+    SetTrimSilence,  // flag
+    SetBpmMatch,     // flag
+    SetBpmTolerance, // value
+    SortLibrary,     // index = column, flag = descending
+};
+
+struct PlayerCommand {
+    PlayerCommandType type;
+    int index = 0;
+    float value = 0.0f;
+    bool flag = false;
+};
+
 // Player State Structure
 struct PlayerState {
+    // Decodes at each file's native rate; conversion to the device rate happens per sound.
+    ma_resource_manager resource_manager{};
+    bool resource_manager_initialized = false;
+    // Its job threads: sized from the core count, grown as streams open.
+    ResourceJobConfig resource_job_config;
+    ResourceJobPool resource_jobs;
+    uint64_t reported_stream_stalls = 0;
     ma_engine engine{};
     ma_sound sound{};
+    std::unique_ptr<TrackSource> track_source; // Backs `sound`
     bool sound_initialized = false;
+    TrackOpenState track_open_state = TrackOpenState::Idle;
+
+    // Open in flight. Superseded opens wait in abandoned_sources until their job finishes.
+    std::unique_ptr<TrackSource> opening_source;
+    int opening_track_index = -1;
+    std::string opening_filepath; // Taken at open time; track_list may be replaced before it completes
+    FileStamp opening_stamp;      // From the scan, for the silence trim lookup
+    std::chrono::steady_clock::time_point opening_start_time;
+    std::vector<std::unique_ptr<TrackSource>> abandoned_sources;
+    ResamplerQuality resampler_quality = ResamplerQuality::Medium;
+
+    // Master bus: every sound feeds this group -> limiter -> master volume -> endpoint.
+    ma_sound_group master_bus{};
+    LimiterNode limiter;
+    VolumeNode master_volume;
+    bool master_chain_initialized = false;
+
+    // Extra output zones. They share resource_manager, so a track playing in several zones is decoded once.
+    ma_context device_context{};
+    bool device_context_initialized = false;
+    std::vector<PlaybackDeviceInfo> playback_devices;
+    int selected_zone_device = -1; // -1 = system default
+    std::vector<std::unique_ptr<Zone>> zones;
+
+    // Cue pads: decoded into memory and played from a preallocated voice pool on the master bus.
+    Soundboard soundboard;
+    std::filesystem::path cue_directory = "./cues/";
+
+    // Live HTTP stream of the output mix, tapped in the engine process callback.
+    HttpStream http_stream;
+    int http_stream_port = kHttpStreamDefaultPort;
+    bool http_stream_allow_remote = false;
+    OutputRecorder output_recorder;
+
+    // Main output clock, the reference synced zones are locked to.
+    DeviceClock output_clock;
+    DriftEstimator output_drift_estimator;
+    double next_sync_sample_time = 0.0;
 
     std::vector<std::string> track_list;
+    uint64_t track_list_version = 0; // Bumped whenever track_list is replaced
+    std::vector<TrackLoadInfo> track_load_info; // Parallel to track_list
+    double storage_latency_ms = 0.0;           // Median first-read time measured by the last scan
+    LoadPolicyConfig load_policy;
+    // Page-cache warming of the next tracks and eviction of finished ones.
+    TrackPrefetcher prefetcher;
+    bool prefetch_enabled = true;
+    int prefetch_track_count = kPrefetchDefaultTracks;
+    // Local copies of the next tracks, opened instead of the source; see track_staging.h.
+    TrackStagingCache staging;
+    bool staging_enabled = false; // Turned on by --stage-tracks or a slow first scan
     int current_track_index = 0;
     bool is_playing = false;
     float volume = 1.0f;
 
+    // Read-only view of the fields above for RenderUI; see PublishPlayerSnapshot. The UI's changes come
+    // back through `commands`.
+    RcuCell<PlayerSnapshot> snapshot;
+    std::mutex command_mutex;
+    std::vector<PlayerCommand> commands; // Guarded by command_mutex
+
     std::filesystem::path music_directory = "./music/";
 
-    std::future<std::vector<std::string>> music_load_future;
+    std::future<MusicScanResult> music_load_future;
     std::atomic<bool> is_loading_music{false};
     bool was_playing_before_async_load = false;
     std::string playing_song_before_async_load;
 
     std::atomic<bool> track_ended_flag{false};
+    std::atomic<uint64_t> pending_trace_flow{0}; // Playback start waiting for its first audio period, when tracing
+    LatencyProbe latency_probe;
+
+    // Shared pool for library-wide background work. Declared before the futures that wait on it.
+    ThreadPool worker_pool;
+
+    // Cold start: the engine and the library cache come up on background threads while the window
+    // opens. Until both are in, the loop renders a placeholder and skips the Process* steps.
+    std::future<bool> audio_init_future;
+    std::future<void> library_load_future;
+    std::future<std::unique_ptr<ImFontAtlas>> font_atlas_future;
+    std::unique_ptr<ImFontAtlas> font_atlas; // Shared with the ImGui context, so it outlives DestroyContext
+    bool startup_complete = false;
+
+    std::future<std::vector<CuePad>> cue_load_future; // Decodes on worker_pool
+    std::atomic<bool> is_loading_cues{false};
+
+    std::future<std::vector<std::vector<std::string>>> duplicate_scan_future;
+    std::atomic<bool> is_scanning_duplicates{false};
+    std::shared_ptr<std::atomic<int>> duplicate_scan_progress = std::make_shared<std::atomic<int>>(0);
+    int duplicate_scan_total = 0;
+    std::vector<std::vector<std::string>> duplicate_groups;
+    bool duplicate_scan_completed = false;
+
+    LibraryDatabase library_db;
+    std::future<std::vector<std::pair<std::string, LibraryRecord>>> analysis_future;
+    std::atomic<bool> is_analyzing_library{false};
+    std::shared_ptr<std::atomic<int>> analysis_progress = std::make_shared<std::atomic<int>>(0);
+    int analysis_total = 0;
+
+    // Library table ordering (indices into track_list) and the BPM queue constraint.
+    std::vector<int> library_view_order;
+    bool library_view_dirty = true;
+    uint64_t library_view_version = 0; // Bumped by every RebuildLibraryView
+    int library_sort_column = 0;
+    bool library_sort_descending = false;
+    bool bpm_match_enabled = false;
+    float bpm_match_tolerance = 0.05f;
+    bool trim_silence_enabled = true;
 
     bool show_music_player_window = true; // For ImGui window closing
+    bool show_diagnostics_window = false;
+    bool use_viewports = false; // --viewports: one native window per ImGui window
+
+    // Render-on-change: frames with no input and no new snapshot skip ImGui and keep the last swap.
+    bool always_render_ui = false;
+    uint64_t rendered_snapshot_version = 0;
+    uint64_t rendered_ui_event_count = 0;
+    int ui_settle_frames = 0;
+    double last_ui_render_time = 0.0;
+    uint64_t ui_frames_rendered = 0;
+    uint64_t ui_frames_skipped = 0;
+    double ui_present_seconds = 0.0; // ImGui::Render through the platform windows, summed over rendered frames
+#if AUDIOPLAYER_PROFILER
+    FrameProfiler frame_profiler;
+    bool show_profiler_window = false;
+#endif
 };
 
+// File name part of a track path, without allocating (for hot-path log messages).
+std::string_view GetFileNamePart(std::string_view path) {
+    const size_t separator = path.find_last_of("/\\");
+    return separator == std::string_view::npos ? path : path.substr(separator + 1);
+}
+
 // Miniaudio Sound End Callback
 void sound_end_callback(void* pUserData, ma_sound* pSound) {
     if (pUserData == nullptr) {
@@ -61,6 +280,24 @@ void sound_end_callback(void* pUserData, ma_sound* pSound) {
 }
 
 
+// Runs on the main device's audio thread after the engine renders each period.
+void engine_process_callback(void* pUserData, float* pFramesOut, ma_uint64 frameCount) {
+    (void)pFramesOut;
+    SetTraceThreadName("Audio");
+    TRACE_SCOPE("EngineProcess");
+    auto* state = static_cast<PlayerState*>(pUserData);
+    if (state->pending_trace_flow.load(std::memory_order_relaxed) != 0) {
+        const uint64_t flow_id = state->pending_trace_flow.exchange(0, std::memory_order_acquire);
+        TRACE_FLOW_END("PlaybackStart", flow_id);
+        TRACE_INSTANT("FirstAudioOut");
+    }
+    RecordDeviceClock(state->output_clock, frameCount);
+    ProcessLatencyProbe(state->latency_probe, pFramesOut, frameCount, ma_engine_get_channels(&state->engine), ma_engine_get_sample_rate(&state->engine));
+    WriteHttpStreamFrames(state->http_stream, pFramesOut, frameCount);
+    WriteOutputRecorderFrames(state->output_recorder, pFramesOut, frameCount);
+    ProcessSoundboardAudio(state->soundboard);
+}
+
 // --- Initialization Functions ---
 void InitializeSpdlog() {
     try {
@@ -72,8 +309,9 @@ void InitializeSpdlog() {
         spdlog::flush_on(spdlog::level::debug);
         #else
         spdlog::set_level(spdlog::level::info);
-        spdlog::flush_on(spdlog::level::info);
+        spdlog::flush_on(spdlog::level::warn); // Info lines are flushed by the async thread in batches
         #endif
+        StartHotLog();
         spdlog::info("Asynchronous Spdlog initialized.");
     } catch (const spdlog::spdlog_ex& ex) {
         fprintf(stderr, "Spdlog async initialization failed: %s\n", ex.what());
@@ -81,14 +319,18 @@ void InitializeSpdlog() {
 }
 
 
-bool InitializeGLFW(GLFWwindow*& window, const char* window_title) {
+// Single-window mode (the default) makes the GLFW window itself the player window. With viewports,
+// the GLFW window is a hidden 1x1 backend and every ImGui window gets its own native window.
+bool InitializeGLFW(GLFWwindow*& window, const char* window_title, bool use_viewports) {
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit()) {
         spdlog::critical("Failed to initialize GLFW");
         return false;
     }
 
-    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Keep backend window hidden
+    if (use_viewports) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Keep backend window hidden
+    }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -96,7 +338,8 @@ bool InitializeGLFW(GLFWwindow*& window, const char* window_title) {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-    window = glfwCreateWindow(1, 1, window_title, nullptr, nullptr); // Hidden backend window
+    window = use_viewports ? glfwCreateWindow(1, 1, window_title, nullptr, nullptr) // Hidden backend window
+                           : glfwCreateWindow(560, 720, window_title, nullptr, nullptr);
     if (!window) {
         spdlog::critical("Failed to create GLFW window");
         glfwTerminate();
@@ -118,15 +361,109 @@ bool InitializeGLEW() {
     return true;
 }
 
-bool InitializeImGui(GLFWwindow* window, ImGuiIO*& io_ptr) {
+// --- UI Events ---
+// Bumped by every GLFW event that can change what is on screen: input, resize and expose. NeedsUiRender
+// compares it with the count at the last rendered frame. Input callbacks are installed over the ImGui
+// backend's and forward to them; GLFW calls them on the main thread from glfwPollEvents.
+uint64_t g_ui_event_count = 0;
+
+struct UiInputCallbacks {
+    GLFWcursorposfun cursor_pos = nullptr;
+    GLFWmousebuttonfun mouse_button = nullptr;
+    GLFWscrollfun scroll = nullptr;
+    GLFWkeyfun key = nullptr;
+    GLFWcharfun character = nullptr;
+    GLFWwindowfocusfun focus = nullptr;
+    GLFWcursorenterfun cursor_enter = nullptr;
+};
+UiInputCallbacks g_imgui_input_callbacks; // The backend installs the same functions on every window
+void (*g_imgui_create_window)(ImGuiViewport*) = nullptr;
+
+void OnUiCursorPos(GLFWwindow* window, double x, double y) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.cursor_pos) g_imgui_input_callbacks.cursor_pos(window, x, y);
+}
+void OnUiMouseButton(GLFWwindow* window, int button, int action, int mods) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.mouse_button) g_imgui_input_callbacks.mouse_button(window, button, action, mods);
+}
+void OnUiScroll(GLFWwindow* window, double x, double y) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.scroll) g_imgui_input_callbacks.scroll(window, x, y);
+}
+void OnUiKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.key) g_imgui_input_callbacks.key(window, key, scancode, action, mods);
+}
+void OnUiChar(GLFWwindow* window, unsigned int codepoint) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.character) g_imgui_input_callbacks.character(window, codepoint);
+}
+void OnUiFocus(GLFWwindow* window, int focused) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.focus) g_imgui_input_callbacks.focus(window, focused);
+}
+void OnUiCursorEnter(GLFWwindow* window, int entered) {
+    ++g_ui_event_count;
+    if (g_imgui_input_callbacks.cursor_enter) g_imgui_input_callbacks.cursor_enter(window, entered);
+}
+void OnUiFramebufferSize(GLFWwindow*, int, int) {
+    ++g_ui_event_count;
+}
+void OnUiWindowRefresh(GLFWwindow*) {
+    ++g_ui_event_count; // Exposed or damaged: the last swap may no longer be on screen
+}
+
+// Call once per window, after the ImGui backend has installed its callbacks on it.
+void InstallUiEventCallbacks(GLFWwindow* window) {
+    auto keep = [](auto& slot, auto previous) {
+        if (previous) slot = previous;
+    };
+    keep(g_imgui_input_callbacks.cursor_pos, glfwSetCursorPosCallback(window, OnUiCursorPos));
+    keep(g_imgui_input_callbacks.mouse_button, glfwSetMouseButtonCallback(window, OnUiMouseButton));
+    keep(g_imgui_input_callbacks.scroll, glfwSetScrollCallback(window, OnUiScroll));
+    keep(g_imgui_input_callbacks.key, glfwSetKeyCallback(window, OnUiKey));
+    keep(g_imgui_input_callbacks.character, glfwSetCharCallback(window, OnUiChar));
+    keep(g_imgui_input_callbacks.focus, glfwSetWindowFocusCallback(window, OnUiFocus));
+    keep(g_imgui_input_callbacks.cursor_enter, glfwSetCursorEnterCallback(window, OnUiCursorEnter));
+    glfwSetFramebufferSizeCallback(window, OnUiFramebufferSize);
+    glfwSetWindowRefreshCallback(window, OnUiWindowRefresh);
+}
+
+// Viewport windows are created by the backend as ImGui windows leave the main one.
+void CreateViewportWindowWithUiEvents(ImGuiViewport* viewport) {
+    g_imgui_create_window(viewport);
+    InstallUiEventCallbacks(static_cast<GLFWwindow*>(viewport->PlatformHandle));
+    ++g_ui_event_count;
+}
+
+// Rasterises the font atlas on a worker thread, overlapping the GLFW window and GL context creation.
+// It is a standalone atlas built before the ImGui context exists: ImGui's allocator counts into the
+// current context, so building alongside any other ImGui call would race on it.
+std::future<std::unique_ptr<ImFontAtlas>> StartFontAtlasBuild() {
+    return std::async(std::launch::async, [] {
+        auto atlas = std::make_unique<ImFontAtlas>();
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+        return atlas;
+    });
+}
+
+// Waits for the atlas and creates the context around it; `font_atlas` must outlive the context.
+bool InitializeImGui(GLFWwindow* window, ImGuiIO*& io_ptr, bool use_viewports, std::future<std::unique_ptr<ImFontAtlas>>& font_atlas_future,
+                     std::unique_ptr<ImFontAtlas>& font_atlas) {
+    font_atlas = font_atlas_future.get(); // The OpenGL backend uploads it on the first frame
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    ImGui::CreateContext(font_atlas.get());
     ImGuiIO& io = ImGui::GetIO();
     io_ptr = &io;
 
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable; // Ensure viewports are enabled
+    if (use_viewports) {
+        io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+    }
 
     ImGui::StyleColorsDark();
     ImGuiStyle& style = ImGui::GetStyle();
@@ -139,6 +476,11 @@ bool InitializeImGui(GLFWwindow* window, ImGuiIO*& io_ptr) {
         spdlog::critical("Failed to initialize ImGui GLFW backend");
         return false;
     }
+    InstallUiEventCallbacks(window);
+    if (ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO(); use_viewports && platform_io.Platform_CreateWindow) {
+        g_imgui_create_window = platform_io.Platform_CreateWindow;
+        platform_io.Platform_CreateWindow = CreateViewportWindowWithUiEvents;
+    }
     if (!ImGui_ImplOpenGL3_Init("#version 330")) {
         spdlog::critical("Failed to initialize ImGui OpenGL3 backend");
         return false;
@@ -148,17 +490,67 @@ bool InitializeImGui(GLFWwindow* window, ImGuiIO*& io_ptr) {
 }
 
 bool InitializeMiniaudio(PlayerState& state) {
-    ma_result result = ma_engine_init(nullptr, &state.engine);
+    ma_resource_manager_config resource_manager_config = ma_resource_manager_config_init();
+    resource_manager_config.decodedFormat = ma_format_f32;
+    resource_manager_config.decodedSampleRate = 0; // Native rate, so the selected resampler does the conversion
+    ResolveResourceJobConfig(state.resource_job_config, std::thread::hardware_concurrency());
+    ConfigureResourceManagerJobs(resource_manager_config, state.resource_job_config);
+    ma_result result = ma_resource_manager_init(&resource_manager_config, &state.resource_manager);
+    if (result != MA_SUCCESS) {
+        spdlog::critical("Failed to initialize resource manager: {}", ma_result_description(result));
+        LogEvent(EventType::Error, result, 0.0, "resource manager init");
+        return false;
+    }
+    state.resource_manager_initialized = true;
+    StartResourceJobPool(state.resource_jobs, &state.resource_manager, state.resource_job_config);
+
+    ma_engine_config engine_config = ma_engine_config_init();
+    engine_config.pResourceManager = &state.resource_manager;
+    engine_config.onProcess = engine_process_callback;
+    engine_config.pProcessUserData = &state;
+    result = ma_engine_init(&engine_config, &state.engine);
     if (result != MA_SUCCESS) {
         spdlog::critical("Failed to initialize miniaudio engine: {}", ma_result_description(result));
+        LogEvent(EventType::Error, result, 0.0, "engine init");
         return false;
     }
     state.sound_initialized = false;
     spdlog::info("Miniaudio engine initialized successfully.");
+
+    LimiterNodeConfig limiter_config;
+    limiter_config.channels = ma_engine_get_channels(&state.engine);
+    limiter_config.sample_rate = ma_engine_get_sample_rate(&state.engine);
+    result = InitializeLimiterNode(ma_engine_get_node_graph(&state.engine), limiter_config, &state.limiter);
+    if (result != MA_SUCCESS) {
+        return false;
+    }
+    result = InitializeVolumeNode(ma_engine_get_node_graph(&state.engine), limiter_config.channels, limiter_config.sample_rate, state.volume,
+                                  &state.master_volume);
+    if (result != MA_SUCCESS) {
+        UninitializeLimiterNode(&state.limiter);
+        return false;
+    }
+    result = ma_sound_group_init(&state.engine, 0, nullptr, &state.master_bus);
+    if (result != MA_SUCCESS) {
+        spdlog::critical("Failed to initialize master bus: {}", ma_result_description(result));
+        UninitializeVolumeNode(&state.master_volume);
+        UninitializeLimiterNode(&state.limiter);
+        return false;
+    }
+    ma_node_attach_output_bus(&state.master_volume, 0, ma_engine_get_endpoint(&state.engine), 0);
+    ma_node_attach_output_bus(&state.limiter, 0, &state.master_volume, 0);
+    ma_node_attach_output_bus(&state.master_bus, 0, &state.limiter, 0);
+    state.master_chain_initialized = true;
+
+    if (!InitializeSoundboard(state.soundboard, &state.engine, &state.master_bus)) {
+        spdlog::warn("Cue pads are unavailable.");
+    }
     return true;
 }
 
 std::vector<std::string> ScanMusicDirectoryWorker(const std::filesystem::path& music_dir_path) {
+    SetTraceThreadName("Music Scan");
+    TRACE_SCOPE("ScanMusicDirectory");
     std::vector<std::string> found_tracks;
     if (!std::filesystem::exists(music_dir_path)) {
         spdlog::warn("Music directory '{}' does not exist. Attempting to create it.", music_dir_path.string());
@@ -193,7 +585,40 @@ std::vector<std::string> ScanMusicDirectoryWorker(const std::filesystem::path& m
     return found_tracks;
 }
 
+// Lists the tracks, then probes the headers of the files small enough to be held in memory. Larger
+// files are always streamed, so they are not read here.
+MusicScanResult ScanMusicLibraryWorker(const std::filesystem::path& music_dir_path, LoadPolicyConfig load_policy) {
+    MusicScanResult result;
+    result.tracks = ScanMusicDirectoryWorker(music_dir_path);
+    TRACE_SCOPE("ProbeTrackFiles");
+    result.load_info.resize(result.tracks.size());
+    std::vector<double> read_ms;
+    for (size_t i = 0; i < result.tracks.size(); ++i) {
+        TrackLoadInfo& info = result.load_info[i];
+        FileStamp stamp;
+        if (!GetFileStamp(result.tracks[i], stamp)) {
+            continue;
+        }
+        info.file_size = stamp.file_size;
+        info.modified_time = stamp.modified_time;
+        if (info.file_size > std::max(load_policy.compressed_max_bytes, load_policy.memory_budget_bytes)) {
+            continue;
+        }
+        double probe_ms = 0.0;
+        if (!ProbeTrackFile(result.tracks[i], info, probe_ms)) {
+            spdlog::debug("Could not read the header of '{}'; it will be streamed.", result.tracks[i]);
+        }
+        read_ms.push_back(probe_ms);
+    }
+    result.storage_latency_ms = EstimateStorageLatency(std::move(read_ms));
+    spdlog::info("Probed {} tracks; storage first-read latency {:.2f} ms.", result.tracks.size(), result.storage_latency_ms);
+    return result;
+}
+
 bool InitializeAndPlaySound(PlayerState& state, int track_index_to_play, bool start_playing); // Forward declaration
+void UninitializeCurrentSound(PlayerState& state);
+void AbandonTrackOpen(PlayerState& state);
+void TriggerLibraryAnalysisAsync(PlayerState& state); // Forward declaration
 
 void TriggerLoadMusicFilesAsync(PlayerState& state, bool is_initial_load = false) {
     if (state.is_loading_music) {
@@ -210,33 +635,50 @@ void TriggerLoadMusicFilesAsync(PlayerState& state, bool is_initial_load = false
         } else {
             state.playing_song_before_async_load.clear();
         }
+        AbandonTrackOpen(state); // Its track index refers to the list being replaced
         if (state.sound_initialized) {
             ma_sound_stop(&state.sound);
             spdlog::info("Sound stopped due to music list refresh.");
-            ma_sound_uninit(&state.sound);
-            state.sound_initialized = false;
-            spdlog::debug("Uninitialized current sound due to music list refresh.");
+            UninitializeCurrentSound(state);
         }
         state.is_playing = false;
     }
-    state.music_load_future = std::async(std::launch::async, ScanMusicDirectoryWorker, state.music_directory);
+    state.music_load_future = std::async(std::launch::async, ScanMusicLibraryWorker, state.music_directory, state.load_policy);
 }
 
 void ProcessAsyncMusicLoadCompletion(PlayerState& state) {
     if (state.is_loading_music && state.music_load_future.valid()) {
         if (state.music_load_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             spdlog::info("Asynchronous music loading finished.");
+            // Play or Next during the scan opened a track of the list being replaced.
+            AbandonTrackOpen(state);
+            if (state.sound_initialized) {
+                ma_sound_stop(&state.sound);
+                UninitializeCurrentSound(state);
+            }
             try {
-                state.track_list = state.music_load_future.get();
+                MusicScanResult scan = state.music_load_future.get();
+                state.track_list = std::move(scan.tracks);
+                state.track_load_info = std::move(scan.load_info);
+                state.storage_latency_ms = scan.storage_latency_ms;
                 if (state.track_list.empty()) {
                     spdlog::warn("No audio files (.mp3, .wav) found in '{}'.", state.music_directory.string());
                 } else {
                     spdlog::info("Loaded {} tracks.", state.track_list.size());
                 }
+                LogEvent(EventType::LibraryScanned, static_cast<int64_t>(state.track_list.size()));
             } catch (const std::exception& e) {
                 spdlog::error("Exception during async music load get: {}", e.what());
                 state.track_list.clear();
+                state.track_load_info.clear();
             }
+            if (state.track_list_version == 0 && !state.staging_enabled && state.storage_latency_ms >= state.load_policy.slow_storage_ms) {
+                spdlog::info("Music storage is slow ({:.1f} ms per first read); staging upcoming tracks to '{}'.", state.storage_latency_ms,
+                             state.staging.directory.string());
+                state.staging_enabled = true;
+            }
+            ++state.track_list_version;
+            RequestStagedTrackCheck(state.staging); // The rescan may have found changed files
 
             state.current_track_index = 0;
             state.is_playing = false;
@@ -254,8 +696,338 @@ void ProcessAsyncMusicLoadCompletion(PlayerState& state) {
             state.was_playing_before_async_load = false;
             state.playing_song_before_async_load.clear();
             state.is_loading_music = false;
+            state.library_view_dirty = true;
+            TriggerLibraryAnalysisAsync(state);
+        }
+    }
+}
+
+// --- Duplicate Detection ---
+constexpr float kDuplicateMinSimilarity = 0.80f;
+
+std::vector<std::vector<std::string>> FindDuplicateTracksWorker(ThreadPool& pool, std::vector<std::string> tracks, std::shared_ptr<std::atomic<int>> progress) {
+    auto scan_start = std::chrono::steady_clock::now();
+    std::vector<std::future<AcousticFingerprint>> pending;
+    pending.reserve(tracks.size());
+    for (const auto& track : tracks) {
+        pending.push_back(pool.Submit([&track, progress] {
+            AcousticFingerprint fingerprint;
+            if (!ComputeAcousticFingerprint(track, fingerprint)) {
+                spdlog::debug("No fingerprint for '{}'.", track);
+            }
+            progress->fetch_add(1);
+            return fingerprint;
+        }));
+    }
+
+    std::vector<AcousticFingerprint> fingerprints;
+    fingerprints.reserve(tracks.size());
+    for (auto& future : pending) {
+        fingerprints.push_back(future.get());
+    }
+    auto fingerprint_end = std::chrono::steady_clock::now();
+
+    std::vector<std::vector<std::string>> groups;
+    for (const auto& members : FindNearDuplicateGroups(fingerprints, kDuplicateMinSimilarity, pool)) {
+        std::vector<std::string>& group = groups.emplace_back();
+        for (uint32_t index : members) {
+            group.push_back(tracks[index]);
+        }
+    }
+    auto scan_end = std::chrono::steady_clock::now();
+    spdlog::info("Fingerprinted {} tracks in {} ms, matched in {} ms.", tracks.size(),
+                 std::chrono::duration_cast<std::chrono::milliseconds>(fingerprint_end - scan_start).count(),
+                 std::chrono::duration_cast<std::chrono::milliseconds>(scan_end - fingerprint_end).count());
+    return groups;
+}
+
+void TriggerDuplicateScanAsync(PlayerState& state) {
+    if (state.is_scanning_duplicates) {
+        spdlog::info("Duplicate scan already in progress.");
+        return;
+    }
+    if (state.track_list.empty()) {
+        spdlog::warn("Duplicate scan requested, but no tracks are loaded.");
+        return;
+    }
+    spdlog::info("Starting acoustic duplicate scan over {} tracks...", state.track_list.size());
+    state.is_scanning_duplicates = true;
+    state.duplicate_scan_progress->store(0);
+    state.duplicate_scan_total = static_cast<int>(state.track_list.size());
+    state.duplicate_scan_future = std::async(std::launch::async, FindDuplicateTracksWorker, std::ref(state.worker_pool), state.track_list, state.duplicate_scan_progress);
+}
+
+void ProcessDuplicateScanCompletion(PlayerState& state) {
+    if (state.is_scanning_duplicates && state.duplicate_scan_future.valid()) {
+        if (state.duplicate_scan_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            try {
+                state.duplicate_groups = state.duplicate_scan_future.get();
+                spdlog::info("Duplicate scan finished: {} group(s) of near-identical tracks.", state.duplicate_groups.size());
+            } catch (const std::exception& e) {
+                spdlog::error("Exception during duplicate scan: {}", e.what());
+                state.duplicate_groups.clear();
+            }
+            state.duplicate_scan_completed = true;
+            state.is_scanning_duplicates = false;
+        }
+    }
+}
+
+// --- Library Analysis ---
+struct AnalysisJob {
+    std::string filepath;
+    bool has_current_record = false;
+    FileStamp cached_stamp;
+};
+
+std::filesystem::path GetLibraryDatabasePath(const PlayerState& state) {
+    return state.music_directory / kLibraryDatabaseFilename;
+}
+
+void InitializeLibraryDatabase(PlayerState& state) {
+    state.library_db.Load(GetLibraryDatabasePath(state));
+    state.library_view_dirty = true;
+}
+
+// --- Startup ---
+void LogStartupStage(const char* stage, std::chrono::steady_clock::time_point stage_start, std::chrono::steady_clock::time_point launch_time) {
+    const auto now = std::chrono::steady_clock::now();
+    spdlog::info("Startup: {} took {:.1f} ms ({:.1f} ms after launch).", stage,
+                 std::chrono::duration<double, std::milli>(now - stage_start).count(),
+                 std::chrono::duration<double, std::milli>(now - launch_time).count());
+}
+
+// Starts the work that does not need the GL context: the audio engine, the library cache and the
+// initial music scan.
+void StartBackgroundStartup(PlayerState& state, std::chrono::steady_clock::time_point launch_time) {
+    state.audio_init_future = std::async(std::launch::async, [&state, launch_time] {
+        SetTraceThreadName("Startup");
+        const auto start = std::chrono::steady_clock::now();
+        const bool initialized = InitializeMiniaudio(state);
+        LogStartupStage("audio engine", start, launch_time);
+        return initialized;
+    });
+    state.library_load_future = std::async(std::launch::async, [&state, launch_time] {
+        const auto start = std::chrono::steady_clock::now();
+        InitializeLibraryDatabase(state);
+        LogStartupStage("library cache", start, launch_time);
+    });
+    TriggerLoadMusicFilesAsync(state, true);
+}
+
+// Adds job threads as streams open and reports new page-boundary stalls.
+void ProcessResourceJobs(PlayerState& state) {
+    const StreamStallStats& stalls = GetStreamStallStats();
+    GrowResourceJobPool(state.resource_jobs, stalls.active_streams.load(std::memory_order_relaxed));
+    SampleJobQueue(state.resource_jobs);
+    const uint64_t stall_count = stalls.stalls.load(std::memory_order_relaxed);
+    if (stall_count > state.reported_stream_stalls) {
+        HOT_LOG_WARN("Streaming fell behind {} time(s) ({:.1f} ms of audio missed so far); queue depth {}.", stall_count - state.reported_stream_stalls,
+                     stalls.stalled_us.load(std::memory_order_relaxed) / 1000.0, state.resource_jobs.queue_depth);
+        state.reported_stream_stalls = stall_count;
+    }
+}
+
+// Returns false if the audio engine failed to start.
+bool ProcessStartupCompletion(PlayerState& state) {
+    if (state.audio_init_future.valid() && state.audio_init_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        if (!state.audio_init_future.get()) {
+            return false;
+        }
+    }
+    if (state.library_load_future.valid() && state.library_load_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            state.library_load_future.get();
+        } catch (const std::exception& e) {
+            spdlog::error("Exception while loading the library database: {}", e.what());
+        }
+    }
+    state.startup_complete = !state.audio_init_future.valid() && !state.library_load_future.valid();
+    return true;
+}
+
+std::vector<std::pair<std::string, LibraryRecord>> AnalyzeLibraryWorker(ThreadPool& pool, std::vector<AnalysisJob> jobs, std::shared_ptr<std::atomic<int>> progress) {
+    auto analysis_start = std::chrono::steady_clock::now();
+    std::vector<std::future<std::optional<std::pair<std::string, LibraryRecord>>>> pending;
+    pending.reserve(jobs.size());
+    for (const auto& job : jobs) {
+        pending.push_back(pool.Submit([&job, progress]() -> std::optional<std::pair<std::string, LibraryRecord>> {
+            FileStamp stamp;
+            bool stamped = GetFileStamp(job.filepath, stamp);
+            if (stamped && job.has_current_record && job.cached_stamp.file_size == stamp.file_size &&
+                job.cached_stamp.modified_time == stamp.modified_time) {
+                progress->fetch_add(1);
+                return std::nullopt; // Cached analysis is still valid
+            }
+            LibraryRecord record;
+            record.file_size = stamp.file_size;
+            record.modified_time = stamp.modified_time;
+            record.analyzed = AnalyzeTrack(job.filepath, record.analysis);
+            spdlog::debug("Analyzed '{}': {:.1f} BPM, key {}.", job.filepath, record.analysis.bpm, GetKeyName(record.analysis.musical_key));
+            progress->fetch_add(1);
+            return std::make_pair(job.filepath, record);
+        }));
+    }
+
+    std::vector<std::pair<std::string, LibraryRecord>> results;
+    for (auto& future : pending) {
+        if (auto result = future.get()) {
+            results.push_back(std::move(*result));
+        }
+    }
+    spdlog::info("Library analysis: {} of {} tracks needed analysis, took {} ms.", results.size(), jobs.size(),
+                 std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - analysis_start).count());
+    return results;
+}
+
+void TriggerLibraryAnalysisAsync(PlayerState& state) {
+    if (state.is_analyzing_library || state.track_list.empty()) {
+        return;
+    }
+    std::vector<AnalysisJob> jobs;
+    jobs.reserve(state.track_list.size());
+    for (const auto& track : state.track_list) {
+        AnalysisJob& job = jobs.emplace_back();
+        job.filepath = track;
+        if (const LibraryRecord* record = state.library_db.Find(track); record && record->analyzed) {
+            job.has_current_record = true;
+            job.cached_stamp = {record->file_size, record->modified_time};
+        }
+    }
+    spdlog::info("Starting tempo/key analysis over {} tracks...", jobs.size());
+    state.is_analyzing_library = true;
+    state.analysis_progress->store(0);
+    state.analysis_total = static_cast<int>(jobs.size());
+    state.analysis_future = std::async(std::launch::async, AnalyzeLibraryWorker, std::ref(state.worker_pool), std::move(jobs), state.analysis_progress);
+}
+
+void ProcessLibraryAnalysisCompletion(PlayerState& state) {
+    if (state.is_analyzing_library && state.analysis_future.valid()) {
+        if (state.analysis_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            try {
+                auto results = state.analysis_future.get();
+                LogEvent(EventType::LibraryAnalyzed, static_cast<int64_t>(results.size()));
+                for (const auto& [filepath, record] : results) {
+                    state.library_db.Put(filepath, record);
+                }
+                if (!results.empty()) {
+                    state.library_db.Save(GetLibraryDatabasePath(state));
+                    state.library_view_dirty = true;
+                }
+            } catch (const std::exception& e) {
+                spdlog::error("Exception during library analysis: {}", e.what());
+            }
+            state.is_analyzing_library = false;
+        }
+    }
+}
+
+const LibraryRecord* FindAnalyzedRecord(const PlayerState& state, int track_index) {
+    const LibraryRecord* record = state.library_db.Find(state.track_list[track_index]);
+    return record && record->analyzed ? record : nullptr;
+}
+
+float GetTrackBpm(const PlayerState& state, int track_index) {
+    const LibraryRecord* record = FindAnalyzedRecord(state, track_index);
+    return record ? record->analysis.bpm : 0.0f;
+}
+
+void RebuildLibraryView(PlayerState& state) {
+    const int track_count = static_cast<int>(state.track_list.size());
+    state.library_view_order.resize(track_count);
+    for (int i = 0; i < track_count; ++i) {
+        state.library_view_order[i] = i;
+    }
+
+    auto key_of = [&state](int index) {
+        const LibraryRecord* record = FindAnalyzedRecord(state, index);
+        return record ? record->analysis.musical_key : kUnknownKey;
+    };
+    auto less = [&](int a, int b) {
+        switch (state.library_sort_column) {
+            case 1:
+                return std::filesystem::path(state.track_list[a]).filename() < std::filesystem::path(state.track_list[b]).filename();
+            case 2: {
+                // Unanalysed tracks sort after everything else in either direction.
+                float bpm_a = GetTrackBpm(state, a), bpm_b = GetTrackBpm(state, b);
+                if ((bpm_a > 0.0f) != (bpm_b > 0.0f)) return (bpm_a > 0.0f) != state.library_sort_descending;
+                return bpm_a < bpm_b;
+            }
+            case 3: {
+                int key_a = key_of(a), key_b = key_of(b);
+                if ((key_a >= 0) != (key_b >= 0)) return (key_a >= 0) != state.library_sort_descending;
+                return key_a < key_b;
+            }
+            default:
+                return a < b;
+        }
+    };
+    std::stable_sort(state.library_view_order.begin(), state.library_view_order.end(), [&](int a, int b) {
+        return state.library_sort_descending ? less(b, a) : less(a, b);
+    });
+    state.library_view_dirty = false;
+    ++state.library_view_version;
+}
+
+// Next track in library view order, honouring the BPM constraint when enabled.
+int SelectNextTrackIndex(PlayerState& state) {
+    if (state.library_view_dirty || state.library_view_order.size() != state.track_list.size()) {
+        RebuildLibraryView(state);
+    }
+    const int track_count = static_cast<int>(state.library_view_order.size());
+    auto it = std::find(state.library_view_order.begin(), state.library_view_order.end(), state.current_track_index);
+    const int view_position = it != state.library_view_order.end() ? static_cast<int>(it - state.library_view_order.begin()) : -1;
+    const int sequential_next = state.library_view_order[(view_position + 1) % track_count];
+    if (!state.bpm_match_enabled) {
+        return sequential_next;
+    }
+
+    float current_bpm = GetTrackBpm(state, state.current_track_index);
+    if (current_bpm <= 0.0f) {
+        spdlog::debug("BPM match enabled, but the current track has no tempo yet.");
+        return sequential_next;
+    }
+    for (int step = 1; step < track_count; ++step) {
+        int candidate = state.library_view_order[(view_position + step + track_count) % track_count];
+        float bpm = GetTrackBpm(state, candidate);
+        if (bpm > 0.0f && std::fabs(bpm - current_bpm) <= current_bpm * state.bpm_match_tolerance) {
+            return candidate;
+        }
+    }
+    spdlog::debug("No track within {:.0f}% of {:.1f} BPM; continuing in order.", state.bpm_match_tolerance * 100.0f, current_bpm);
+    return sequential_next;
+}
+
+// The tracks HandleNextTrack would play after the current one: its pick, then library view order.
+std::vector<std::string> GetUpcomingTracks(PlayerState& state, int count) {
+    std::vector<std::string> upcoming;
+    if (state.track_list.empty() || count <= 0) {
+        return upcoming;
+    }
+    const int next_track_index = SelectNextTrackIndex(state); // Also brings library_view_order up to date
+    const int track_count = static_cast<int>(state.library_view_order.size());
+    auto it = std::find(state.library_view_order.begin(), state.library_view_order.end(), next_track_index);
+    const int view_position = static_cast<int>(it - state.library_view_order.begin());
+    for (int step = 0; step < track_count && static_cast<int>(upcoming.size()) < count; ++step) {
+        const int index = state.library_view_order[(view_position + step) % track_count];
+        if (index != state.current_track_index) {
+            upcoming.push_back(state.track_list[index]);
         }
     }
+    return upcoming;
+}
+
+// The I/O threads are started here, the first time their feature is on; either may be switched on
+// later from the diagnostics window or, for staging, by a slow first scan.
+void PrefetchUpcomingTracks(PlayerState& state) {
+    if (state.staging_enabled) {
+        // The copy reads the whole file anyway; warming the source as well would fetch it twice.
+        StartTrackStaging(state.staging);
+        StageUpcomingTracks(state.staging, GetUpcomingTracks(state, state.prefetch_track_count));
+    } else if (state.prefetch_enabled) {
+        StartTrackPrefetcher(state.prefetcher);
+        WarmUpcomingTracks(state.prefetcher, GetUpcomingTracks(state, state.prefetch_track_count), kPrefetchDefaultBytes);
+    }
 }
 
 void StopCurrentSound(PlayerState& state) {
@@ -266,19 +1038,107 @@ void StopCurrentSound(PlayerState& state) {
         } else {
              spdlog::info("Sound stopped (track info unavailable).");
         }
+        state.track_open_state = TrackOpenState::Ready;
     }
     state.is_playing = false;
 }
 
 void UninitializeCurrentSound(PlayerState& state) {
+    DisarmLatencyProbe(state.latency_probe); // The audio thread must not sample a sound being torn down
     if (state.sound_initialized) {
         ma_sound_uninit(&state.sound);
+        UninitializeTrackSource(state.track_source.get());
+        state.track_source.reset();
         state.sound_initialized = false;
+        state.track_open_state = TrackOpenState::Idle;
         spdlog::debug("Uninitialized current sound.");
     }
 }
 
+// Hands an unfinished open to abandoned_sources, so switching tracks never waits for a slow file.
+void AbandonTrackOpen(PlayerState& state) {
+    if (!state.opening_source) {
+        return;
+    }
+    HOT_LOG_DEBUG("Abandoning open of track {}.", state.opening_track_index);
+    state.abandoned_sources.push_back(std::move(state.opening_source));
+    state.opening_track_index = -1;
+    state.opening_filepath.clear();
+    if (state.track_open_state == TrackOpenState::Opening) {
+        state.track_open_state = TrackOpenState::Idle;
+    }
+}
+
+// Frees abandoned opens whose jobs have finished. With `wait`, blocks for the rest (shutdown).
+void ReapAbandonedTrackOpens(PlayerState& state, bool wait) {
+    std::erase_if(state.abandoned_sources, [wait](const std::unique_ptr<TrackSource>& source) {
+        if (wait) {
+            WaitForTrackSourceOpen(source.get());
+        } else if (!IsTrackSourceOpenComplete(source.get())) {
+            return false;
+        }
+        UninitializeTrackSource(source.get());
+        return true;
+    });
+}
+
+// The size and modification time the last scan recorded for a track; no file system access.
+FileStamp GetScannedFileStamp(const PlayerState& state, int track_index) {
+    if (track_index < 0 || track_index >= static_cast<int>(state.track_load_info.size())) {
+        return {};
+    }
+    const TrackLoadInfo& info = state.track_load_info[track_index];
+    return {info.file_size, info.modified_time};
+}
+
+// Restricts playback to the track's audible region. The end callback then fires at the trimmed end,
+// so the next track starts as soon as the audible part of this one is over. `stamp` comes from the
+// scan: statting the file here would put the mount's latency back on the UI thread.
+void ApplySilenceTrim(PlayerState& state, ma_sound* sound, const std::string& filepath, const FileStamp& stamp) {
+    if (!state.trim_silence_enabled) {
+        return;
+    }
+    const LibraryRecord* record = state.library_db.FindCurrent(filepath, stamp);
+    if (!record || !record->analyzed || !record->analysis.silence.detected) {
+        return;
+    }
+
+    // Bounds are stored at the file's native rate; a resampling data source runs at the engine rate.
+    const SilenceBounds& silence = record->analysis.silence;
+    ma_uint32 source_rate = 0;
+    if (ma_sound_get_data_format(sound, nullptr, nullptr, &source_rate, nullptr, 0) != MA_SUCCESS || source_rate == 0) {
+        return;
+    }
+    const double scale = static_cast<double>(source_rate) / silence.sample_rate;
+    const ma_uint64 begin = static_cast<ma_uint64>(silence.start_frame * scale);
+    const ma_uint64 end = static_cast<ma_uint64>(silence.end_frame * scale);
+    ma_result result = ma_data_source_set_range_in_pcm_frames(ma_sound_get_data_source(sound), begin, end);
+    if (result != MA_SUCCESS) {
+        spdlog::warn("Could not apply silence trim to '{}': {}", filepath, ma_result_description(result));
+        return;
+    }
+    spdlog::debug("Trimmed '{}' to frames [{}, {}) at {} Hz.", std::filesystem::path(filepath).filename().string(), begin, end, source_rate);
+}
+
+double GetMainOutputLatency(PlayerState& state) {
+    return GetPlaybackDeviceLatency(ma_engine_get_device(&state.engine));
+}
+
+// Links a playback start to the audio period that first renders it in exported traces.
+void TracePlaybackStart(PlayerState& state) {
+    if (!IsTracingEnabled()) {
+        return;
+    }
+    const uint64_t flow_id = NewTraceFlowId();
+    TRACE_FLOW_BEGIN("PlaybackStart", flow_id);
+    state.pending_trace_flow.store(flow_id, std::memory_order_release);
+}
+
+// Starts opening a track without blocking; ProcessTrackOpenCompletion finishes it on a later frame.
+// `start_playing` is recorded in is_playing, so Play/Pause during the open decides whether it starts.
 bool InitializeAndPlaySound(PlayerState& state, int track_index_to_play, bool start_playing) {
+    TRACE_SCOPE("InitializeAndPlaySound");
+    AbandonTrackOpen(state);
     UninitializeCurrentSound(state);
 
     if (state.track_list.empty() || track_index_to_play < 0 || track_index_to_play >= static_cast<int>(state.track_list.size())) {
@@ -287,57 +1147,124 @@ bool InitializeAndPlaySound(PlayerState& state, int track_index_to_play, bool st
         return false;
     }
 
-    const char* filepath = state.track_list[track_index_to_play].c_str();
-    ma_uint32 flags = MA_SOUND_FLAG_STREAM;
-    ma_result result = ma_sound_init_from_file(&state.engine, filepath, flags, nullptr, nullptr, &state.sound);
+    const std::string& filepath = state.track_list[track_index_to_play];
+    if (state.prefetch_enabled && track_index_to_play != state.current_track_index && state.current_track_index >= 0 &&
+        state.current_track_index < static_cast<int>(state.track_list.size())) {
+        EvictFinishedTrack(state.prefetcher, state.track_list[state.current_track_index]);
+    }
+    state.current_track_index = track_index_to_play;
+    const TrackLoadInfo& load_info = state.track_load_info[track_index_to_play];
+    std::string open_path = state.staging_enabled ? FindStagedTrack(state.staging, filepath) : std::string();
+    const bool staged = !open_path.empty();
+    if (!staged) {
+        open_path = filepath;
+    }
+    // A staged copy is on local disk, so the measured network latency does not apply to it.
+    const TrackLoadMode load_mode = ChooseTrackLoadMode(load_info, state.load_policy, staged ? 0.0 : state.storage_latency_ms);
+    state.opening_source = std::make_unique<TrackSource>();
+    ma_result result = BeginTrackSourceOpen(&state.resource_manager, open_path, GetTrackLoadFlags(load_mode), state.opening_source.get());
+    if (result != MA_SUCCESS) {
+        spdlog::error("Failed to open '{}': {}", filepath, ma_result_description(result));
+        LogEvent(EventType::TrackOpenFailed, result, 0.0, GetFileNamePart(filepath));
+        UninitializeTrackSource(state.opening_source.get());
+        state.opening_source.reset();
+        state.track_open_state = TrackOpenState::Failed;
+        state.is_playing = false;
+        return false;
+    }
+    state.opening_track_index = track_index_to_play;
+    state.opening_filepath = filepath;
+    state.opening_stamp = GetScannedFileStamp(state, track_index_to_play);
+    state.opening_start_time = std::chrono::steady_clock::now();
+    state.track_open_state = TrackOpenState::Opening;
+    state.is_playing = start_playing;
+    HOT_LOG_DEBUG("Opening ({}, {:.1f} s{}): {}", GetTrackLoadModeName(load_mode), load_info.duration_seconds, staged ? ", staged" : "",
+                  GetFileNamePart(filepath));
+    return true;
+}
 
+// Polled once per frame: turns a finished open into the current sound and starts it if requested.
+void ProcessTrackOpenCompletion(PlayerState& state) {
+    ReapAbandonedTrackOpens(state, false);
+    if (!state.opening_source || !IsTrackSourceOpenComplete(state.opening_source.get())) {
+        return;
+    }
+    TRACE_SCOPE("ProcessTrackOpenCompletion");
+    std::unique_ptr<TrackSource> source = std::move(state.opening_source);
+    const int track_index = state.opening_track_index;
+    state.opening_track_index = -1;
+    const std::string filepath = std::move(state.opening_filepath);
+    state.opening_filepath.clear();
+
+    ma_result result = FinishTrackSourceOpen(source.get(), filepath, state.resampler_quality, ma_engine_get_sample_rate(&state.engine));
+    if (result == MA_SUCCESS) {
+        result = ma_sound_init_from_data_source(&state.engine, GetTrackDataSource(source.get()), 0, &state.master_bus, &state.sound);
+    }
     if (result != MA_SUCCESS) {
         spdlog::error("Failed to initialize sound from file '{}': {}", filepath, ma_result_description(result));
+        LogEvent(EventType::TrackOpenFailed, result, 0.0, GetFileNamePart(filepath));
+        UninitializeTrackSource(source.get());
         state.sound_initialized = false;
         state.is_playing = false;
-        return false;
+        state.track_open_state = TrackOpenState::Failed;
+        return;
     }
 
+    state.track_source = std::move(source);
     state.sound_initialized = true;
-    state.current_track_index = track_index_to_play;
-    ma_sound_set_volume(&state.sound, state.volume);
     ma_sound_set_end_callback(&state.sound, sound_end_callback, &state);
-    spdlog::info("Sound initialized: {}", std::filesystem::path(filepath).filename().string());
+    ApplySilenceTrim(state, &state.sound, filepath, state.opening_stamp);
+    HOT_LOG_INFO("Sound initialized: {}", GetFileNamePart(filepath));
+    LogEvent(EventType::TrackOpened, track_index,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state.opening_start_time).count(), GetFileNamePart(filepath));
 
-    if (start_playing) {
+    if (state.is_playing) {
         ma_sound_start(&state.sound);
-        state.is_playing = true;
-        spdlog::info("Playback started: {}", std::filesystem::path(filepath).filename().string());
+        TracePlaybackStart(state);
+        ArmLatencyProbe(state.latency_probe, &state.sound, GetMainOutputLatency(state));
+        state.track_open_state = TrackOpenState::Playing;
+        LogEvent(EventType::PlaybackStarted, track_index);
+        HOT_LOG_INFO("Playback started: {}", GetFileNamePart(filepath));
     } else {
-        state.is_playing = false;
+        state.track_open_state = TrackOpenState::Ready;
     }
-    return true;
+    PrefetchUpcomingTracks(state);
 }
 
 void HandlePlayPause(PlayerState& state) {
+    TRACE_SCOPE("HandlePlayPause");
     if (state.track_list.empty()) {
-        spdlog::warn("Play/Pause clicked, but no tracks are loaded.");
+        HOT_LOG_WARN("Play/Pause clicked, but no tracks are loaded.");
         return;
     }
      if (state.current_track_index < 0 || state.current_track_index >= static_cast<int>(state.track_list.size())) {
-        spdlog::error("Play/Pause: Invalid current track index {}.", state.current_track_index);
+        HOT_LOG_ERROR("Play/Pause: Invalid current track index {}.", state.current_track_index);
         return;
     }
-    std::string current_track_name = std::filesystem::path(state.track_list[state.current_track_index]).filename().string();
+    std::string_view current_track_name = GetFileNamePart(state.track_list[state.current_track_index]);
 
     if (state.is_playing) {
-        spdlog::info("Pause button clicked for: {}", current_track_name);
+        HOT_LOG_INFO("Pause button clicked for: {}", current_track_name);
         if (state.sound_initialized) {
             ma_sound_stop(&state.sound);
+            state.track_open_state = TrackOpenState::Ready;
         }
-        state.is_playing = false;
-        spdlog::info("Playback paused: {}", current_track_name);
+        state.is_playing = false; // While opening, the track stays paused once it is in
+        LogEvent(EventType::PlaybackPaused, state.current_track_index);
+        HOT_LOG_INFO("Playback paused: {}", current_track_name);
     } else {
-        spdlog::info("Play button clicked for: {}", current_track_name);
-        if (state.sound_initialized && !ma_sound_is_playing(&state.sound)) {
+        HOT_LOG_INFO("Play button clicked for: {}", current_track_name);
+        StampLatencyClick(state.latency_probe);
+        if (state.track_open_state == TrackOpenState::Opening) {
+            state.is_playing = true; // Starts as soon as the open completes
+        } else if (state.sound_initialized && !ma_sound_is_playing(&state.sound)) {
             ma_sound_start(&state.sound);
+            TracePlaybackStart(state);
+            ArmLatencyProbe(state.latency_probe, &state.sound, GetMainOutputLatency(state));
             state.is_playing = true;
-            spdlog::info("Playback resumed: {}", current_track_name);
+            state.track_open_state = TrackOpenState::Playing;
+            LogEvent(EventType::PlaybackResumed, state.current_track_index);
+            HOT_LOG_INFO("Playback resumed: {}", current_track_name);
         } else {
             InitializeAndPlaySound(state, state.current_track_index, true);
         }
@@ -345,95 +1272,1062 @@ void HandlePlayPause(PlayerState& state) {
 }
 
 void HandleNextTrack(PlayerState& state) {
+    TRACE_SCOPE("HandleNextTrack");
     if (state.track_list.empty()) {
-        spdlog::warn("Next track triggered, but no tracks are loaded.");
+        HOT_LOG_WARN("Next track triggered, but no tracks are loaded.");
         return;
     }
-    spdlog::info("Next track triggered.");
-    int next_track_index = (state.current_track_index + 1) % state.track_list.size();
+    HOT_LOG_INFO("Next track triggered.");
+    StampLatencyClick(state.latency_probe);
+    int next_track_index = SelectNextTrackIndex(state);
     bool was_playing = state.is_playing;
 
-    InitializeAndPlaySound(state, next_track_index, was_playing);
-    if (was_playing && !state.is_playing && state.sound_initialized) {
-         spdlog::warn("Tried to auto-play next track, but an issue occurred or it was not started by InitializeAndPlaySound.");
-    } else if (was_playing && state.is_playing) {
-        spdlog::info("Now playing next track: {}", std::filesystem::path(state.track_list[next_track_index]).filename().string());
-    } else if (!was_playing) {
-        spdlog::info("Selected next track (paused/stopped): {}", std::filesystem::path(state.track_list[next_track_index]).filename().string());
+    if (!InitializeAndPlaySound(state, next_track_index, was_playing)) {
+         HOT_LOG_WARN("Could not open the next track.");
+    } else if (was_playing) {
+        HOT_LOG_INFO("Opening next track to play: {}", GetFileNamePart(state.track_list[next_track_index]));
+    } else {
+        HOT_LOG_INFO("Selected next track (paused/stopped): {}", GetFileNamePart(state.track_list[next_track_index]));
     }
 }
 
+// Called on every slider tick: only publishes the target. The audio thread picks up the latest value
+// once per block and ramps to it, so rapid updates coalesce naturally.
 void HandleVolumeChange(PlayerState& state, float new_volume) {
-    spdlog::debug("Volume slider interaction. New attempted volume: {:.2f}", new_volume);
     state.volume = new_volume;
-    if (state.sound_initialized) {
-        ma_sound_set_volume(&state.sound, state.volume);
-        spdlog::info("Volume set to: {:.2f}", state.volume);
-    } else {
-        spdlog::debug("Volume changed to {:.2f}, but no sound is currently initialized to apply it to.", state.volume);
+    SetVolumeNodeTarget(&state.master_volume, state.volume);
+}
+
+// --- Zones ---
+bool EnsureDeviceContext(PlayerState& state) {
+    if (state.device_context_initialized) {
+        return true;
+    }
+    ma_result result = ma_context_init(nullptr, 0, nullptr, &state.device_context);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Failed to initialize audio device context: {}", ma_result_description(result));
+        return false;
     }
+    state.device_context_initialized = true;
+    EnumeratePlaybackDevices(&state.device_context, state.playback_devices);
+    return true;
 }
 
-// --- Main Loop and Rendering ---
-void RenderUI(PlayerState& state) {
-    // If the window is marked for closure (e.g. by user clicking 'x'), don't attempt to render it.
-    // The main loop will catch this state and terminate.
-    if (!state.show_music_player_window) {
+void AddZone(PlayerState& state) {
+    if (!EnsureDeviceContext(state)) {
         return;
     }
+    const PlaybackDeviceInfo* device = nullptr;
+    if (state.selected_zone_device >= 0 && state.selected_zone_device < static_cast<int>(state.playback_devices.size())) {
+        device = &state.playback_devices[state.selected_zone_device];
+    }
+    std::string name = "Zone " + std::to_string(state.zones.size() + 1);
+    if (auto zone = CreateZone(&state.device_context, &state.resource_manager, name, device)) {
+        state.zones.push_back(std::move(zone));
+        LogEvent(EventType::ZoneAdded, static_cast<int64_t>(state.zones.size()), 0.0, name);
+    }
+}
 
-    // Pass &state.show_music_player_window to ImGui::Begin.
-    // If the user clicks the 'x' on the ImGui window, ImGui will set this to false.
-    // ImGui::Begin returns false if the window is collapsed, among other things.
-    // We must always call ImGui::End() if ImGui::Begin() was called.
-    if (ImGui::Begin("Music Player", &state.show_music_player_window)) {
-        // ----- UI Content -----
-        if (state.is_loading_music) {
-            ImGui::Text("Loading music files...");
-            ImGui::BeginDisabled(); // Disable button while loading
-        }
-        if (ImGui::Button("Refresh Music List")) {
-            spdlog::info("'Refresh Music List' button clicked.");
-            TriggerLoadMusicFilesAsync(state);
-        }
-        if (state.is_loading_music) {
-            ImGui::EndDisabled();
-        }
-        ImGui::Separator();
+void PlayTrackInZone(PlayerState& state, Zone& zone, int track_index) {
+    if (track_index < 0 || track_index >= static_cast<int>(state.track_list.size())) {
+        spdlog::warn("Zone '{}': track index {} is out of range.", zone.name, track_index);
+        return;
+    }
+    if (BeginZoneTrackOpen(zone, &state.resource_manager, track_index, state.track_list[track_index])) {
+        zone.play_when_open = true; // Started by ProcessZoneEvents
+    }
+}
 
-        if (!state.track_list.empty()) {
-            if (state.current_track_index < 0 || state.current_track_index >= static_cast<int>(state.track_list.size())) {
-                spdlog::warn("Track index {} is out of bounds (0-{}). Resetting to 0.", state.current_track_index, state.track_list.size() -1 );
-                state.current_track_index = 0;
-                if(state.is_playing) StopCurrentSound(state);
-                UninitializeCurrentSound(state);
-            }
+void QueueTrackInZone(PlayerState& state, Zone& zone, int track_index) {
+    if (!zone.sound_initialized && !zone.opening_source) {
+        PlayTrackInZone(state, zone, track_index);
+        return;
+    }
+    zone.queue.push_back(track_index);
+    spdlog::debug("Zone '{}': queued track {} ({} waiting).", zone.name, track_index, zone.queue.size());
+}
 
-            if (state.current_track_index >= 0 && state.current_track_index < static_cast<int>(state.track_list.size())) {
-                std::string track_name = std::filesystem::path(state.track_list[state.current_track_index]).filename().string();
-                ImGui::Text("Now Playing: %s", track_name.c_str());
+void HandleZoneNext(PlayerState& state, Zone& zone) {
+    if (zone.queue.empty()) {
+        UnloadZoneTrack(zone);
+        zone.current_track_index = -1;
+        spdlog::info("Zone '{}': queue finished.", zone.name);
+        return;
+    }
+    int next_index = zone.queue.front();
+    zone.queue.pop_front();
+    PlayTrackInZone(state, zone, next_index);
+}
 
-                if (ImGui::Button(state.is_playing ? "Pause" : "Play")) {
-                    HandlePlayPause(state);
-                }
+// --- Zone Sync ---
+constexpr double kSyncPhaseGain = 0.01;         // Ratio correction per second of alignment error
+constexpr double kSyncMaxPhaseCorrection = 500e-6;
+constexpr double kSyncPhaseSmoothing = 0.05;    // EWMA weight per estimator sample
+constexpr double kSyncResyncThreshold = 0.1;    // Seconds of error before a hard seek
+
+double GetSoundPositionSeconds(ma_sound* sound) {
+    ma_uint64 cursor = 0;
+    ma_uint32 rate = 0;
+    if (ma_sound_get_cursor_in_pcm_frames(sound, &cursor) != MA_SUCCESS ||
+        ma_sound_get_data_format(sound, nullptr, nullptr, &rate, nullptr, 0) != MA_SUCCESS || rate == 0) {
+        return -1.0;
+    }
+    return static_cast<double>(cursor) / rate;
+}
 
-                ImGui::SameLine();
+// Seeks the zone so its audible position matches the main output's, allowing for both devices' latency.
+void AlignZoneToMain(PlayerState& state, Zone& zone) {
+    double main_position = GetSoundPositionSeconds(&state.sound);
+    ma_uint32 zone_rate = 0;
+    if (main_position < 0.0 || ma_sound_get_data_format(&zone.sound, nullptr, nullptr, &zone_rate, nullptr, 0) != MA_SUCCESS) {
+        return;
+    }
+    double target = std::max(0.0, main_position - GetMainOutputLatency(state) + GetZoneOutputLatency(zone));
+    ma_sound_seek_to_pcm_frame(&zone.sound, static_cast<ma_uint64>(target * zone_rate));
+    zone.phase_error_seconds = 0.0;
+}
+
+void SetZoneSync(Zone& zone, bool enabled) {
+    zone.sync_to_main = enabled;
+    zone.drift_correction_enabled.store(enabled);
+    zone.ratio_adjustment.store(1.0);
+    ResetDriftEstimator(zone.drift_estimator);
+    zone.drift_ppm = 0.0;
+    zone.correction_ppm = 0.0;
+    zone.phase_error_seconds = 0.0;
+    zone.resync_count = 0;
+    zone.queue.clear();
+    if (enabled) {
+        UnloadZoneTrack(zone); // Reloaded and aligned on the next sync pass
+        zone.current_track_index = -1;
+    }
+    spdlog::info("Zone '{}' {} the main output.", zone.name, enabled ? "now follows" : "no longer follows");
+}
+
+// Keeps a synced zone on the main player's track and play state.
+void FollowMainPlayer(PlayerState& state, Zone& zone) {
+    if (!state.sound_initialized) {
+        if (zone.is_playing) {
+            PauseZone(zone);
+        }
+        return;
+    }
+    if (!zone.sound_initialized || zone.current_track_index != state.current_track_index) {
+        // Aligned and started on a later pass, once the open has completed.
+        if (zone.opening_track_index != state.current_track_index) {
+            BeginZoneTrackOpen(zone, &state.resource_manager, state.current_track_index, state.track_list[state.current_track_index]);
+        }
+        return;
+    }
+    if (state.is_playing && !zone.is_playing) {
+        AlignZoneToMain(state, zone);
+        StartZone(zone);
+    } else if (!state.is_playing && zone.is_playing) {
+        PauseZone(zone);
+    }
+}
+
+// Measures each synced zone's clock against the main output and steers its drift resampler:
+// the rate term cancels measured drift, the phase term slowly pulls the audible positions together.
+void UpdateZoneSync(PlayerState& state, double now) {
+    bool any_synced = false;
+    for (auto& zone : state.zones) {
+        if (zone->sync_to_main) {
+            FollowMainPlayer(state, *zone);
+            any_synced = true;
+        }
+    }
+    if (!any_synced || now < state.next_sync_sample_time) {
+        return;
+    }
+    state.next_sync_sample_time = now + kDriftSampleInterval;
+
+    uint64_t frames = 0;
+    int64_t time_ns = 0;
+    if (ReadDeviceClock(state.output_clock, frames, time_ns)) {
+        AddDriftSample(state.output_drift_estimator, time_ns * 1e-9, static_cast<double>(frames));
+    }
+    const double reference_rate = EstimateDeviceRate(state.output_drift_estimator);
+    const ma_uint32 reference_nominal = ma_engine_get_sample_rate(&state.engine);
+
+    for (auto& zone_ptr : state.zones) {
+        Zone& zone = *zone_ptr;
+        if (!zone.sync_to_main) {
+            continue;
+        }
+        if (ReadDeviceClock(zone.clock, frames, time_ns)) {
+            AddDriftSample(zone.drift_estimator, time_ns * 1e-9, static_cast<double>(frames));
+        }
+        zone.drift_ppm = ComputeDriftPpm(reference_rate, reference_nominal, EstimateDeviceRate(zone.drift_estimator), zone.device.sampleRate);
+
+        if (state.is_playing && zone.is_playing) {
+            double main_position = GetSoundPositionSeconds(&state.sound);
+            double zone_position = GetSoundPositionSeconds(&zone.sound);
+            if (main_position >= 0.0 && zone_position >= 0.0) {
+                double error = (zone_position - GetZoneOutputLatency(zone)) - (main_position - GetMainOutputLatency(state));
+                if (std::abs(error) > kSyncResyncThreshold) {
+                    spdlog::warn("Zone '{}' was {:.1f} ms off the main output; re-seeking.", zone.name, error * 1000.0);
+                    AlignZoneToMain(state, zone);
+                    ++zone.resync_count;
+                } else {
+                    zone.phase_error_seconds += (error - zone.phase_error_seconds) * kSyncPhaseSmoothing;
+                }
+            }
+        }
+        double correction = std::clamp(-kSyncPhaseGain * zone.phase_error_seconds, -kSyncMaxPhaseCorrection, kSyncMaxPhaseCorrection);
+        zone.correction_ppm = correction * 1e6;
+        zone.ratio_adjustment.store(1.0 / (1.0 + zone.drift_ppm * 1e-6) + correction);
+    }
+}
+
+void ProcessZoneEvents(PlayerState& state) {
+    for (auto& zone : state.zones) {
+        if (ProcessZoneTrackOpen(*zone, state.resampler_quality)) {
+            const int index = zone->current_track_index;
+            // The list may have been replaced while the open was in flight; its stamp is then unknown.
+            const bool listed = index < static_cast<int>(state.track_list.size()) && state.track_list[index] == zone->current_filepath;
+            ApplySilenceTrim(state, &zone->sound, zone->current_filepath, listed ? GetScannedFileStamp(state, index) : FileStamp{});
+            if (zone->play_when_open && !zone->sync_to_main) {
+                StartZone(*zone);
+                spdlog::info("Zone '{}' playing: {}", zone->name, std::filesystem::path(zone->current_filepath).filename().string());
+            }
+            zone->play_when_open = false;
+        }
+        // Synced zones change track when the main player does.
+        if (zone->track_ended_flag.exchange(false) && zone->is_playing && !zone->sync_to_main) {
+            HandleZoneNext(state, *zone);
+        }
+    }
+    UpdateZoneSync(state, glfwGetTime());
+}
+
+void DestroyAllZones(PlayerState& state) {
+    for (auto& zone : state.zones) {
+        DestroyZone(*zone);
+    }
+    state.zones.clear();
+    if (state.device_context_initialized) {
+        ma_context_uninit(&state.device_context);
+        state.device_context_initialized = false;
+    }
+}
+
+// --- Cue Pads ---
+std::vector<CuePad> LoadCuePadsWorker(ThreadPool& pool, std::filesystem::path cue_dir_path, ma_uint32 channels, ma_uint32 sample_rate) {
+    std::vector<std::string> files;
+    try {
+        if (!std::filesystem::exists(cue_dir_path)) {
+            std::filesystem::create_directories(cue_dir_path);
+            spdlog::info("Created cue directory: '{}'", cue_dir_path.string());
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(cue_dir_path)) {
+            if (entry.is_regular_file()) {
+                std::string extension = entry.path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+                if (extension == ".mp3" || extension == ".wav") {
+                    files.push_back(entry.path().string());
+                }
+            }
+        }
+    } catch (const std::filesystem::filesystem_error& e) {
+        spdlog::error("Filesystem error while reading cue directory '{}': {}", cue_dir_path.string(), e.what());
+    }
+    std::sort(files.begin(), files.end());
+
+    auto load_start = std::chrono::steady_clock::now();
+    std::vector<std::future<std::optional<CuePad>>> pending;
+    pending.reserve(files.size());
+    for (const auto& file : files) {
+        pending.push_back(pool.Submit([&file, channels, sample_rate]() -> std::optional<CuePad> {
+            CuePad pad;
+            if (!DecodeCuePad(file, channels, sample_rate, pad)) {
+                return std::nullopt;
+            }
+            return pad;
+        }));
+    }
+    std::vector<CuePad> pads;
+    size_t total_bytes = 0;
+    for (auto& future : pending) {
+        if (auto pad = future.get()) {
+            total_bytes += pad->samples.size() * sizeof(float);
+            pads.push_back(std::move(*pad));
+        }
+    }
+    spdlog::info("Decoded {} cue pads ({:.1f} MB resident) in {} ms.", pads.size(), total_bytes / (1024.0 * 1024.0),
+                 std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - load_start).count());
+    return pads;
+}
+
+void TriggerCueLoadAsync(PlayerState& state) {
+    if (state.is_loading_cues || !state.soundboard.initialized) {
+        return;
+    }
+    spdlog::info("Loading cue pads from '{}'...", state.cue_directory.string());
+    state.is_loading_cues = true;
+    state.cue_load_future = std::async(std::launch::async, LoadCuePadsWorker, std::ref(state.worker_pool), state.cue_directory,
+                                       ma_engine_get_channels(&state.engine), ma_engine_get_sample_rate(&state.engine));
+}
+
+void ProcessCueLoadCompletion(PlayerState& state) {
+    if (state.is_loading_cues && state.cue_load_future.valid()) {
+        if (state.cue_load_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            try {
+                ReplaceCuePads(state.soundboard, state.cue_load_future.get());
+            } catch (const std::exception& e) {
+                spdlog::error("Exception while loading cue pads: {}", e.what());
+            }
+            state.is_loading_cues = false;
+        }
+    }
+}
+
+// --- Main Loop and Rendering ---
+// --- UI Snapshot ---
+// Control side: repairs a current track index left pointing past the end of the track list.
+void ValidateCurrentTrack(PlayerState& state) {
+    if (state.track_list.empty() || (state.current_track_index >= 0 && state.current_track_index < static_cast<int>(state.track_list.size()))) {
+        return;
+    }
+    HOT_LOG_WARN("Track index {} is out of bounds (0-{}). Resetting to 0.", state.current_track_index, state.track_list.size() - 1);
+    state.current_track_index = 0;
+    if (state.is_playing) StopCurrentSound(state);
+    UninitializeCurrentSound(state);
+}
+
+// UI side: queues an action for the control code; it takes effect from the next frame's snapshot.
+void PostPlayerCommand(PlayerState& state, const PlayerCommand& command) {
+    std::lock_guard lock(state.command_mutex);
+    state.commands.push_back(command);
+}
+
+// Control side: applies the actions the UI queued since the last frame, in order.
+void ProcessPlayerCommands(PlayerState& state) {
+    std::vector<PlayerCommand> commands;
+    {
+        std::lock_guard lock(state.command_mutex);
+        commands.swap(state.commands);
+    }
+    for (const PlayerCommand& command : commands) {
+        switch (command.type) {
+            case PlayerCommandType::RefreshLibrary:
+                TriggerLoadMusicFilesAsync(state);
+                break;
+            case PlayerCommandType::PlayPause:
+                HandlePlayPause(state);
+                break;
+            case PlayerCommandType::NextTrack:
+                HandleNextTrack(state);
+                break;
+            case PlayerCommandType::PlayTrack:
+                if (command.index >= 0 && command.index < static_cast<int>(state.track_list.size())) {
+                    InitializeAndPlaySound(state, command.index, true);
+                }
+                break;
+            case PlayerCommandType::SetVolume:
+                HandleVolumeChange(state, command.value);
+                break;
+            case PlayerCommandType::SetResampler:
+                state.resampler_quality = static_cast<ResamplerQuality>(command.index);
+                spdlog::info("Resampler set to {} (applies from the next track).", GetResamplerQualityName(state.resampler_quality));
+                break;
+            case PlayerCommandType::SetTrimSilence:
+                state.trim_silence_enabled = command.flag;
+                break;
+            case PlayerCommandType::SetBpmMatch:
+                state.bpm_match_enabled = command.flag;
+                break;
+            case PlayerCommandType::SetBpmTolerance:
+                state.bpm_match_tolerance = command.value;
+                break;
+            case PlayerCommandType::SortLibrary:
+                state.library_sort_column = command.index;
+                state.library_sort_descending = command.flag;
+                state.library_view_dirty = true;
+                break;
+        }
+    }
+}
+
+// Control side: publishes a new snapshot if anything the UI shows has changed since the last one.
+// The track table is copied only when track_list_version moves on, the rows when the view is rebuilt.
+void PublishPlayerSnapshot(PlayerState& state) {
+    // Until startup completes, the library database belongs to the loader thread.
+    if (state.startup_complete && (state.library_view_dirty || state.library_view_order.size() != state.track_list.size())) {
+        RebuildLibraryView(state);
+    }
+    const PlayerSnapshot* current = state.snapshot.Read();
+    const bool is_loading_music = state.is_loading_music.load();
+    const bool is_analyzing_library = state.is_analyzing_library.load();
+    if (current && current->track_list_version == state.track_list_version && current->library_view_version == state.library_view_version &&
+        current->current_track_index == state.current_track_index && current->is_playing == state.is_playing &&
+        current->track_open_state == state.track_open_state && current->volume == state.volume && current->is_loading_music == is_loading_music &&
+        current->startup_complete == state.startup_complete && current->resampler_quality == state.resampler_quality &&
+        current->is_analyzing_library == is_analyzing_library && current->trim_silence_enabled == state.trim_silence_enabled &&
+        current->bpm_match_enabled == state.bpm_match_enabled && current->bpm_match_tolerance == state.bpm_match_tolerance) {
+        state.snapshot.Reclaim();
+        return;
+    }
+    auto snapshot = std::make_unique<PlayerSnapshot>();
+    snapshot->version = current ? current->version + 1 : 1;
+    if (current && current->track_list_version == state.track_list_version) {
+        snapshot->track_list = current->track_list;
+    } else {
+        snapshot->track_list = std::make_shared<const std::vector<std::string>>(state.track_list);
+    }
+    snapshot->track_list_version = state.track_list_version;
+    snapshot->current_track_index = state.current_track_index;
+    snapshot->is_playing = state.is_playing;
+    snapshot->track_open_state = state.track_open_state;
+    snapshot->volume = state.volume;
+    snapshot->is_loading_music = is_loading_music;
+    snapshot->startup_complete = state.startup_complete;
+    snapshot->music_directory = state.music_directory.string();
+    snapshot->resampler_quality = state.resampler_quality;
+    if (current && current->library_view_version == state.library_view_version) {
+        snapshot->library_rows = current->library_rows;
+    } else {
+        auto rows = std::make_shared<std::vector<LibraryRow>>();
+        rows->reserve(state.library_view_order.size());
+        for (const int track_index : state.library_view_order) {
+            const LibraryRecord* record = FindAnalyzedRecord(state, track_index);
+            rows->push_back({track_index, record ? record->analysis.bpm : 0.0f, record ? record->analysis.musical_key : kUnknownKey});
+        }
+        snapshot->library_rows = std::move(rows);
+    }
+    snapshot->library_view_version = state.library_view_version;
+    snapshot->is_analyzing_library = is_analyzing_library;
+    snapshot->analysis_total = state.analysis_total;
+    snapshot->trim_silence_enabled = state.trim_silence_enabled;
+    snapshot->bpm_match_enabled = state.bpm_match_enabled;
+    snapshot->bpm_match_tolerance = state.bpm_match_tolerance;
+    state.snapshot.Publish(std::move(snapshot));
+}
+
+void RenderLibraryTable(PlayerState& state, const PlayerSnapshot& snapshot) {
+    if (snapshot.is_analyzing_library) {
+        ImGui::Text("Analyzing tempo and key... %d / %d", state.analysis_progress->load(), snapshot.analysis_total);
+    }
+    bool trim_silence = snapshot.trim_silence_enabled;
+    if (ImGui::Checkbox("Trim leading/trailing silence", &trim_silence)) {
+        PostPlayerCommand(state, {PlayerCommandType::SetTrimSilence, 0, 0.0f, trim_silence});
+    }
+    bool bpm_match = snapshot.bpm_match_enabled;
+    if (ImGui::Checkbox("Keep next track within", &bpm_match)) {
+        PostPlayerCommand(state, {PlayerCommandType::SetBpmMatch, 0, 0.0f, bpm_match});
+    }
+    ImGui::SameLine();
+    float tolerance_percent = snapshot.bpm_match_tolerance * 100.0f;
+    ImGui::SetNextItemWidth(120.0f);
+    if (ImGui::SliderFloat("% BPM", &tolerance_percent, 1.0f, 20.0f, "%.0f")) {
+        PostPlayerCommand(state, {PlayerCommandType::SetBpmTolerance, 0, tolerance_percent / 100.0f});
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders |
+                                  ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+    if (!ImGui::BeginTable("library", 4, flags, ImVec2(0.0f, 240.0f))) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthFixed, 36.0f, 0);
+    ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_WidthStretch, 0.0f, 1);
+    ImGui::TableSetupColumn("BPM", ImGuiTableColumnFlags_WidthFixed, 56.0f, 2);
+    ImGui::TableSetupColumn("Key", ImGuiTableColumnFlags_WidthFixed, 44.0f, 3);
+    ImGui::TableHeadersRow();
+
+    if (ImGuiTableSortSpecs* sort_specs = ImGui::TableGetSortSpecs(); sort_specs && sort_specs->SpecsDirty) {
+        if (sort_specs->SpecsCount > 0) {
+            PostPlayerCommand(state, {PlayerCommandType::SortLibrary, static_cast<int>(sort_specs->Specs[0].ColumnUserID), 0.0f,
+                                      sort_specs->Specs[0].SortDirection == ImGuiSortDirection_Descending});
+        }
+        sort_specs->SpecsDirty = false;
+    }
+
+    const std::vector<LibraryRow>& rows = *snapshot.library_rows; // Rebuilt for the snapshot's own track table
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const int track_index = rows[row].track_index;
+            ImGui::PushID(track_index);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", track_index + 1);
+            ImGui::TableNextColumn();
+            std::string track_name = std::filesystem::path((*snapshot.track_list)[track_index]).filename().string();
+            if (ImGui::Selectable(track_name.c_str(), track_index == snapshot.current_track_index, ImGuiSelectableFlags_SpanAllColumns)) {
+                spdlog::info("Library row selected: {}", track_name);
+                PostPlayerCommand(state, {PlayerCommandType::PlayTrack, track_index});
+            }
+            if (!state.zones.empty() && ImGui::BeginPopupContextItem()) {
+                for (auto& zone : state.zones) {
+                    if (ImGui::MenuItem(("Play in " + zone->name).c_str())) {
+                        PlayTrackInZone(state, *zone, track_index);
+                    }
+                    if (ImGui::MenuItem(("Queue in " + zone->name).c_str())) {
+                        QueueTrackInZone(state, *zone, track_index);
+                    }
+                }
+                ImGui::EndPopup();
+            }
+            ImGui::TableNextColumn();
+            if (rows[row].bpm > 0.0f) {
+                ImGui::Text("%.1f", rows[row].bpm);
+            } else {
+                ImGui::TextDisabled("-");
+            }
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GetKeyName(rows[row].musical_key));
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndTable();
+}
+
+void RenderZones(PlayerState& state) {
+    const char* preview = state.selected_zone_device >= 0 && state.selected_zone_device < static_cast<int>(state.playback_devices.size())
+                              ? state.playback_devices[state.selected_zone_device].name.c_str()
+                              : "Default device";
+    if (ImGui::BeginCombo("Output", preview)) {
+        if (ImGui::Selectable("Default device", state.selected_zone_device < 0)) {
+            state.selected_zone_device = -1;
+        }
+        for (int i = 0; i < static_cast<int>(state.playback_devices.size()); ++i) {
+            ImGui::PushID(i);
+            if (ImGui::Selectable(state.playback_devices[i].name.c_str(), state.selected_zone_device == i)) {
+                state.selected_zone_device = i;
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndCombo();
+    }
+    if (ImGui::Button("Add Zone")) {
+        AddZone(state);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Refresh Devices")) {
+        // The context is created on first use; creating it also enumerates once.
+        if (state.device_context_initialized) {
+            EnumeratePlaybackDevices(&state.device_context, state.playback_devices);
+        } else {
+            EnsureDeviceContext(state);
+        }
+        state.selected_zone_device = -1;
+    }
+    ImGui::TextDisabled("Right-click a library row to play or queue it in a zone.");
+
+    int zone_to_remove = -1;
+    for (int i = 0; i < static_cast<int>(state.zones.size()); ++i) {
+        Zone& zone = *state.zones[i];
+        ImGui::PushID(i);
+        ImGui::Separator();
+        ImGui::Text("%s  (%s)", zone.name.c_str(), zone.device_name.c_str());
+        bool sync_to_main = zone.sync_to_main;
+        if (ImGui::Checkbox("Sync to main output", &sync_to_main)) {
+            SetZoneSync(zone, sync_to_main);
+        }
+        if (zone.sync_to_main) {
+            ImGui::TextDisabled("Drift %+.1f ppm, offset %+.2f ms", zone.drift_ppm, zone.phase_error_seconds * 1000.0);
+            ImGui::PopID();
+            continue;
+        }
+        if (zone.current_track_index >= 0 && zone.current_track_index < static_cast<int>(state.track_list.size())) {
+            ImGui::Text("Now Playing: %s  [%zu queued]",
+                        std::filesystem::path(state.track_list[zone.current_track_index]).filename().string().c_str(), zone.queue.size());
+        }
+        if (ImGui::Button(zone.is_playing ? "Pause" : "Play")) {
+            if (zone.is_playing) {
+                PauseZone(zone);
+            } else if (zone.sound_initialized) {
+                StartZone(zone);
+            } else {
+                PlayTrackInZone(state, zone, state.current_track_index);
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Next")) {
+            HandleZoneNext(state, zone);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Play Main Track")) {
+            PlayTrackInZone(state, zone, state.current_track_index);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Remove")) {
+            zone_to_remove = i;
+        }
+        float zone_volume = zone.volume_level;
+        if (ImGui::SliderFloat("Volume", &zone_volume, 0.0f, 1.0f)) {
+            SetZoneVolume(zone, zone_volume);
+        }
+        ImGui::PopID();
+    }
+    if (zone_to_remove >= 0) {
+        DestroyZone(*state.zones[zone_to_remove]);
+        state.zones.erase(state.zones.begin() + zone_to_remove);
+        LogEvent(EventType::ZoneRemoved, static_cast<int64_t>(state.zones.size()));
+    }
+}
+
+void RenderCuePads(PlayerState& state) {
+    Soundboard& board = state.soundboard;
+    if (!board.initialized) {
+        ImGui::TextDisabled("Cue pads are unavailable.");
+        return;
+    }
+    if (state.is_loading_cues) {
+        ImGui::Text("Decoding cue pads...");
+    } else if (ImGui::Button("Load Cues")) {
+        TriggerCueLoadAsync(state);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Stop All")) {
+        StopAllCueVoices(board);
+    }
+    for (int bus = 0; bus < kCueBusCount; ++bus) {
+        ImGui::PushID(bus);
+        float level = board.bus_levels[bus];
+        if (ImGui::SliderFloat(fmt::format("Bus {}", kCueBusNames[bus]).c_str(), &level, 0.0f, 1.0f)) {
+            SetCueBusLevel(board, bus, level);
+        }
+        ImGui::PopID();
+    }
+
+    const CueLatencyStats& latency = board.latency;
+    ImGui::Text("Voices: %d / %d active, %u stolen", CountActiveCueVoices(board), kCueVoiceCount, board.voices_stolen);
+    if (latency.count.load() > 0) {
+        // Render latency is measured; the device buffer on top of it is the configured size.
+        const float device_ms = static_cast<float>(GetMainOutputLatency(state) * 1000.0);
+        ImGui::Text("Trigger to render: %.2f ms (avg %.2f, min %.2f, max %.2f)   To output: ~%.1f ms", latency.last_ms.load(),
+                    latency.average_ms.load(), latency.min_ms.load(), latency.max_ms.load(), latency.average_ms.load() + device_ms);
+    }
+    if (board.pads.empty()) {
+        ImGui::TextDisabled("No pads loaded. Add MP3 or WAV files to '%s' and click 'Load Cues'.", state.cue_directory.string().c_str());
+        return;
+    }
+    ImGui::TextDisabled("Right-click a pad to set its bus, choke group and gain.");
+
+    constexpr float kPadSize = 84.0f;
+    const int columns = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / (kPadSize + ImGui::GetStyle().ItemSpacing.x)));
+    for (int i = 0; i < static_cast<int>(board.pads.size()); ++i) {
+        CuePad& pad = board.pads[i];
+        ImGui::PushID(i);
+        if (i % columns != 0) {
+            ImGui::SameLine();
+        }
+        // Trigger on press rather than release to save the click's hold time.
+        ImGui::Button(pad.name.c_str(), ImVec2(kPadSize, kPadSize));
+        if (ImGui::IsItemActivated()) {
+            TriggerCuePad(board, i);
+        }
+        if (ImGui::BeginPopupContextItem("pad_settings")) {
+            ImGui::TextUnformatted(pad.name.c_str());
+            if (ImGui::BeginCombo("Bus", kCueBusNames[pad.bus])) {
+                for (int bus = 0; bus < kCueBusCount; ++bus) {
+                    if (ImGui::Selectable(kCueBusNames[bus], pad.bus == bus)) {
+                        pad.bus = bus;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::SliderInt("Choke group", &pad.choke_group, 0, kCueChokeGroups, pad.choke_group == 0 ? "None" : "%d");
+            ImGui::SliderFloat("Gain", &pad.gain, 0.0f, 2.0f);
+            ImGui::EndPopup();
+        }
+        ImGui::PopID();
+    }
+}
+
+void RenderRecordingControls(PlayerState& state) {
+    OutputRecorder& recorder = state.output_recorder;
+    if (!recorder.running) {
+        ImGui::Checkbox("Direct I/O (O_DIRECT)", &recorder.use_direct_io);
+        if (ImGui::Button("Record Output")) {
+            StartOutputRecorder(recorder, ma_engine_get_channels(&state.engine), ma_engine_get_sample_rate(&state.engine));
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("to %s", recorder.directory.string().c_str());
+        return;
+    }
+    if (ImGui::Button("Stop Recording")) {
+        StopOutputRecorder(recorder);
+        return;
+    }
+    ImGui::SameLine();
+    ImGui::Text("Recording: %s", std::filesystem::path(GetRecorderCurrentFile(recorder)).filename().string().c_str());
+}
+
+void RenderHttpStream(PlayerState& state) {
+    HttpStream& stream = state.http_stream;
+    const HttpStreamStats& stats = stream.stats;
+    if (!stream.running) {
+        ImGui::InputInt("Port", &state.http_stream_port);
+        state.http_stream_port = std::clamp(state.http_stream_port, 1, 65535);
+        ImGui::Checkbox("Allow LAN listeners", &state.http_stream_allow_remote);
+        if (ImGui::Button("Start Stream")) {
+            StartHttpStream(stream, ma_engine_get_channels(&state.engine), ma_engine_get_sample_rate(&state.engine),
+                            static_cast<uint16_t>(state.http_stream_port), state.http_stream_allow_remote);
+        }
+        return;
+    }
+    ImGui::Text("Streaming on http://%s:%u/", state.http_stream_allow_remote ? "<this-host>" : "127.0.0.1", stream.port);
+    ImGui::SameLine();
+    if (ImGui::Button("Stop Stream")) {
+        StopHttpStream(stream);
+        return;
+    }
+    ImGui::Text("Listeners: %d   Sent: %.1f MB   Chunks: %llu", stats.listeners.load(), stats.bytes_sent.load() / (1024.0 * 1024.0),
+                static_cast<unsigned long long>(stats.chunks_encoded.load()));
+    ImGui::Text("Dropped frames: %llu   Slow listeners dropped: %llu", static_cast<unsigned long long>(stats.dropped_frames.load()),
+                static_cast<unsigned long long>(stats.listeners_dropped.load()));
+}
+
+void RenderLimiterControls(PlayerState& state) {
+    LimiterNode& limiter = state.limiter;
+    bool enabled = limiter.enabled.load();
+    if (ImGui::Checkbox("Enabled##limiter", &enabled)) {
+        limiter.enabled.store(enabled);
+        spdlog::info("Limiter {}.", enabled ? "enabled" : "bypassed");
+    }
+    ImGui::SameLine();
+    bool soft_clip = limiter.soft_clip.load();
+    if (ImGui::Checkbox("Soft clip", &soft_clip)) {
+        limiter.soft_clip.store(soft_clip);
+    }
+    float lookahead_ms = limiter.lookahead_ms.load();
+    if (ImGui::SliderFloat("Lookahead (ms)", &lookahead_ms, kLimiterMinLookaheadMs, kLimiterMaxLookaheadMs, "%.1f")) {
+        limiter.lookahead_ms.store(lookahead_ms);
+    }
+    float ceiling_db = limiter.ceiling_db.load();
+    if (ImGui::SliderFloat("Ceiling (dBTP)", &ceiling_db, -12.0f, 0.0f, "%.1f")) {
+        limiter.ceiling_db.store(ceiling_db);
+    }
+    float release_ms = limiter.release_ms.load();
+    if (ImGui::SliderFloat("Release (ms)", &release_ms, 10.0f, 500.0f, "%.0f")) {
+        limiter.release_ms.store(release_ms);
+    }
+    ImGui::Text("Gain reduction: %.1f dB   CPU: %.2f%%", limiter.gain_reduction_db.load(), limiter.cpu_load.load() * 100.0f);
+}
+
+void RenderDiagnosticsWindow(PlayerState& state) {
+    if (!ImGui::Begin("Diagnostics", &state.show_diagnostics_window)) {
+        ImGui::End();
+        return;
+    }
+    if (ImGui::CollapsingHeader("Recording", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const OutputRecorder& recorder = state.output_recorder;
+        const RecorderStats& stats = recorder.stats;
+        if (!recorder.ring_initialized) {
+            ImGui::TextDisabled("Not recording.");
+        } else {
+            const float capacity = static_cast<float>(recorder.ring_frames);
+            const float fill = static_cast<float>(stats.fill_frames.load());
+            const float peak = static_cast<float>(stats.peak_fill_frames.load());
+            ImGui::ProgressBar(fill / capacity, ImVec2(-1.0f, 0.0f),
+                               fmt::format("Buffer {:.1f} / {:.1f} s", fill / recorder.sample_rate, capacity / recorder.sample_rate).c_str());
+            ImGui::Text("Peak fill: %.0f%%   Dropped: %llu blocks (%llu frames)", peak / capacity * 100.0f,
+                        static_cast<unsigned long long>(stats.dropped_blocks.load()), static_cast<unsigned long long>(stats.dropped_frames.load()));
+            ImGui::Text("Written: %.1f MB, %u file(s) finished   Write errors: %llu   %s", stats.bytes_written.load() / (1024.0 * 1024.0),
+                        stats.files_written.load(), static_cast<unsigned long long>(stats.write_errors.load()),
+                        stats.direct_io_active.load() ? "O_DIRECT" : "buffered");
+        }
+    }
+    if (ImGui::CollapsingHeader("Play Latency", ImGuiTreeNodeFlags_DefaultOpen)) {
+        LatencyProbe& probe = state.latency_probe;
+        ImGui::Checkbox("Measure click to first audible frame", &probe.enabled);
+        ImGui::SameLine();
+        if (ImGui::Button("Reset##latency")) {
+            ResetLatencyStats(probe);
+        }
+        const uint32_t measurements = probe.measurements.load();
+        if (measurements == 0) {
+            ImGui::TextDisabled("No measurements yet. Enable, then use Play or Next.");
+        } else {
+            ImGui::Text("Last %.1f ms   Min %.1f   Avg %.1f   Max %.1f   (%u measured, %u timed out)", probe.last_ms.load(), probe.min_ms.load(),
+                        probe.total_ms.load() / measurements, probe.max_ms.load(), measurements, probe.timeouts.load());
+            ImGui::Text("p50 <= %.0f ms   p95 <= %.0f ms   Device latency %.1f ms", EstimateLatencyPercentile(probe, 0.5),
+                        EstimateLatencyPercentile(probe, 0.95), GetMainOutputLatency(state) * 1000.0);
+            std::array<float, kLatencyHistogramBins> bins{};
+            for (size_t i = 0; i < kLatencyHistogramBins; ++i) {
+                bins[i] = static_cast<float>(probe.histogram[i].load());
+            }
+            ImGui::PlotHistogram("##latency_histogram", bins.data(), static_cast<int>(bins.size()), 0,
+                                 fmt::format("0-{:.0f} ms, {:.0f} ms bins", kLatencyHistogramBins * kLatencyHistogramBinMs, kLatencyHistogramBinMs).c_str(),
+                                 0.0f, FLT_MAX, ImVec2(-1.0f, 80.0f));
+        }
+    }
+    if (ImGui::CollapsingHeader("Tracing", ImGuiTreeNodeFlags_DefaultOpen)) {
+        bool tracing = IsTracingEnabled();
+        if (ImGui::Checkbox("Record trace events", &tracing)) {
+            SetTracingEnabled(tracing);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%zu events buffered", CountTraceEvents());
+        if (ImGui::Button("Save Trace")) {
+            const std::time_t now = std::time(nullptr);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+            WriteChromeTrace(fmt::format("trace_{}.json", stamp));
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("Chrome JSON; open in ui.perfetto.dev or chrome://tracing");
+    }
+    if (ImGui::CollapsingHeader("Clock Sync", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const double reference_rate = EstimateDeviceRate(state.output_drift_estimator);
+        ImGui::Text("Main output: %u Hz nominal, %s", ma_engine_get_sample_rate(&state.engine),
+                    reference_rate > 0.0 ? fmt::format("{:.3f} Hz measured", reference_rate).c_str() : "measuring...");
+        ImGui::Text("Main output latency: %.1f ms", GetMainOutputLatency(state) * 1000.0);
+        bool any_synced = false;
+        for (const auto& zone : state.zones) {
+            if (!zone->sync_to_main) {
+                continue;
+            }
+            any_synced = true;
+            const double zone_rate = EstimateDeviceRate(zone->drift_estimator);
+            ImGui::Separator();
+            ImGui::Text("%s (%s)", zone->name.c_str(), zone->device_name.c_str());
+            ImGui::Text("  Rate: %u Hz nominal, %.3f Hz measured", zone->device.sampleRate, zone_rate);
+            ImGui::Text("  Drift: %+.2f ppm   Phase correction: %+.1f ppm", zone->drift_ppm, zone->correction_ppm);
+            ImGui::Text("  Alignment error: %+.2f ms   Latency: %.1f ms   Re-seeks: %d", zone->phase_error_seconds * 1000.0,
+                        GetZoneOutputLatency(*zone) * 1000.0, zone->resync_count);
+        }
+        if (!any_synced) {
+            ImGui::TextDisabled("No zones are synced to the main output.");
+        }
+    }
+    if (ImGui::CollapsingHeader("UI Rendering", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Render every frame", &state.always_render_ui);
+        const uint64_t total = state.ui_frames_rendered + state.ui_frames_skipped;
+        ImGui::Text("Frames rendered: %llu   Skipped unchanged: %llu (%.0f%%)", static_cast<unsigned long long>(state.ui_frames_rendered),
+                    static_cast<unsigned long long>(state.ui_frames_skipped), total > 0 ? 100.0 * state.ui_frames_skipped / total : 0.0);
+        ImGui::Text("%s: draw and platform windows %.3f ms per rendered frame", state.use_viewports ? "Multi-viewport" : "Single window",
+                    state.ui_frames_rendered > 0 ? state.ui_present_seconds * 1000.0 / state.ui_frames_rendered : 0.0);
+    }
+    if (ImGui::CollapsingHeader("Streaming", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const ResourceJobPool& jobs = state.resource_jobs;
+        const StreamStallStats& stalls = GetStreamStallStats();
+        const uint64_t jobs_processed = jobs.jobs_processed.load(std::memory_order_relaxed);
+        ImGui::Text("Job threads: %zu of %u   Jobs: %llu (%.2f ms avg)", jobs.threads.size(), jobs.max_threads,
+                    static_cast<unsigned long long>(jobs_processed),
+                    jobs_processed > 0 ? jobs.busy_ns.load(std::memory_order_relaxed) / 1e6 / jobs_processed : 0.0);
+        ImGui::Text("Job queue: %u now, %u peak, %u capacity", jobs.queue_depth, jobs.peak_queue_depth, jobs.queue_capacity);
+        ImGui::Text("Streams open: %u   Decode-ahead: %.2f s", stalls.active_streams.load(std::memory_order_relaxed), kStreamDecodeAheadSeconds);
+        ImGui::Text("Page stalls: %llu of %llu reads, %.1f ms missed", static_cast<unsigned long long>(stalls.stalls.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(stalls.reads.load(std::memory_order_relaxed)),
+                    stalls.stalled_us.load(std::memory_order_relaxed) / 1000.0);
+    }
+    if (ImGui::CollapsingHeader("Page Cache", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Warm upcoming tracks, evict finished ones", &state.prefetch_enabled);
+        ImGui::SliderInt("Tracks ahead", &state.prefetch_track_count, 1, 10);
+        const TrackPrefetchStats& prefetch = state.prefetcher.stats;
+        ImGui::Text("Warmed: %llu files, %.1f MB   Evicted: %llu files   Failed: %llu",
+                    static_cast<unsigned long long>(prefetch.warmed_files.load(std::memory_order_relaxed)),
+                    prefetch.warmed_bytes.load(std::memory_order_relaxed) / (1024.0 * 1024.0),
+                    static_cast<unsigned long long>(prefetch.evicted_files.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(prefetch.failures.load(std::memory_order_relaxed)));
+        ImGui::Text("I/O thread: %u queued, %.1f ms busy", prefetch.pending.load(std::memory_order_relaxed),
+                    prefetch.busy_ns.load(std::memory_order_relaxed) / 1e6);
+    }
+    if (ImGui::CollapsingHeader("Staging", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Copy upcoming tracks to local disk", &state.staging_enabled);
+        const TrackStagingStats& staging = state.staging.stats;
+        const uint64_t staged_bytes = staging.staged_bytes.load(std::memory_order_relaxed);
+        const uint64_t copy_ns = staging.copy_ns.load(std::memory_order_relaxed);
+        ImGui::Text("'%s': %.0f of %.0f MB", state.staging.directory.string().c_str(),
+                    staging.resident_bytes.load(std::memory_order_relaxed) / (1024.0 * 1024.0), state.staging.budget_bytes / (1024.0 * 1024.0));
+        ImGui::Text("Staged: %llu files, %.1f MB/s   %u queued   Evicted: %llu",
+                    static_cast<unsigned long long>(staging.staged_files.load(std::memory_order_relaxed)),
+                    copy_ns > 0 ? staged_bytes / (1024.0 * 1024.0) / (copy_ns / 1e9) : 0.0, staging.pending.load(std::memory_order_relaxed),
+                    static_cast<unsigned long long>(staging.evicted_files.load(std::memory_order_relaxed)));
+        ImGui::Text("Opens: %llu local, %llu source   Rejected copies: %llu   Copy errors: %llu",
+                    static_cast<unsigned long long>(staging.hits.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(staging.misses.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(staging.integrity_failures.load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(staging.copy_errors.load(std::memory_order_relaxed)));
+    }
+    ImGui::End();
+}
+
+#if AUDIOPLAYER_PROFILER
+void RenderProfilerWindow(PlayerState& state) {
+    if (!ImGui::Begin("Frame Profiler", &state.show_profiler_window)) {
+        ImGui::End();
+        return;
+    }
+    const FrameProfiler& profiler = state.frame_profiler;
+    constexpr float kBudgetMs = 1000.0f / 60.0f;
+    const ProfilerSummary frame = SummarizeFrameTimes(profiler);
+    // Oldest sample first once the history has wrapped.
+    const int offset = profiler.count == kProfilerHistory ? static_cast<int>(profiler.head) : 0;
+    ImGui::PlotLines("##frame_ms", profiler.frame_ms.data(), static_cast<int>(profiler.count), offset,
+                     fmt::format("Frame {:.2f} ms avg, {:.2f} ms max", frame.average_ms, frame.max_ms).c_str(), 0.0f, kBudgetMs * 2.0f,
+                     ImVec2(-1.0f, 80.0f));
+    if (ImGui::BeginTable("profiler_sections", 3, ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Section");
+        ImGui::TableSetupColumn("Avg (ms)");
+        ImGui::TableSetupColumn("Max (ms)");
+        ImGui::TableHeadersRow();
+        float busy_ms = 0.0f;
+        for (size_t i = 0; i < kFrameSectionCount; ++i) {
+            const auto section = static_cast<FrameSection>(i);
+            const ProfilerSummary summary = SummarizeSection(profiler, section);
+            busy_ms += summary.average_ms;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GetFrameSectionName(section));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", summary.average_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", summary.max_ms);
+        }
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("Idle (frame pacing)");
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("%.3f", std::max(0.0f, frame.average_ms - busy_ms));
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+#endif
+
+void RenderUI(PlayerState& state) {
+    // If the window is marked for closure (e.g. by user clicking 'x'), don't attempt to render it.
+    // The main loop will catch this state and terminate.
+    if (!state.show_music_player_window) {
+        return;
+    }
+    // Player fields come from the published snapshot; changes are posted as PlayerCommands.
+    const PlayerSnapshot* snapshot = state.snapshot.Read();
+    if (!snapshot) {
+        return;
+    }
+    const std::vector<std::string>& track_list = *snapshot->track_list;
+
+    // With viewports, pass &state.show_music_player_window to ImGui::Begin.
+    // If the user clicks the 'x' on the ImGui window, ImGui will set this to false.
+    // In single-window mode the player fills the GLFW window, which is closed natively instead.
+    // ImGui::Begin returns false if the window is collapsed, among other things.
+    // We must always call ImGui::End() if ImGui::Begin() was called.
+    bool* open_flag = &state.show_music_player_window;
+    ImGuiWindowFlags window_flags = ImGuiWindowFlags_None;
+    if (!state.use_viewports) {
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos(viewport->WorkPos);
+        ImGui::SetNextWindowSize(viewport->WorkSize);
+        window_flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
+                       ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoBringToFrontOnFocus;
+        open_flag = nullptr;
+    }
+    if (ImGui::Begin("Music Player", open_flag, window_flags)) {
+        if (!snapshot->startup_complete) {
+            ImGui::TextDisabled("Starting audio engine...");
+            ImGui::End();
+            return;
+        }
+        // ----- UI Content -----
+        if (snapshot->is_loading_music) {
+            ImGui::Text("Loading music files...");
+            ImGui::BeginDisabled(); // Disable button while loading
+        }
+        if (ImGui::Button("Refresh Music List")) {
+            spdlog::info("'Refresh Music List' button clicked.");
+            PostPlayerCommand(state, {PlayerCommandType::RefreshLibrary});
+        }
+        if (snapshot->is_loading_music) {
+            ImGui::EndDisabled();
+        }
+        ImGui::Separator();
+
+        if (!track_list.empty()) {
+            if (snapshot->current_track_index >= 0 && snapshot->current_track_index < static_cast<int>(track_list.size())) {
+                std::string track_name = std::filesystem::path(track_list[snapshot->current_track_index]).filename().string();
+                if (snapshot->track_open_state == TrackOpenState::Opening) {
+                    ImGui::Text("Opening: %s...", track_name.c_str());
+                } else if (snapshot->track_open_state == TrackOpenState::Failed) {
+                    ImGui::Text("Could not open: %s", track_name.c_str());
+                } else {
+                    ImGui::Text("Now Playing: %s", track_name.c_str());
+                }
+
+                if (ImGui::Button(snapshot->is_playing ? "Pause" : "Play")) {
+                    PostPlayerCommand(state, {PlayerCommandType::PlayPause});
+                }
+
+                ImGui::SameLine();
                 if (ImGui::Button("Next")) {
-                    HandleNextTrack(state);
+                    PostPlayerCommand(state, {PlayerCommandType::NextTrack});
                 }
 
-                float current_volume = state.volume;
+                float current_volume = snapshot->volume;
                 if (ImGui::SliderFloat("Volume", &current_volume, 0.0f, 1.0f)) {
-                    HandleVolumeChange(state, current_volume);
+                    PostPlayerCommand(state, {PlayerCommandType::SetVolume, 0, current_volume});
+                }
+                if (ImGui::IsItemDeactivatedAfterEdit()) {
+                    HOT_LOG_INFO("Volume set to: {:.2f}", current_volume); // Once per drag, not per tick
+                    LogEvent(EventType::VolumeChanged, 0, current_volume);
+                }
+
+                if (ImGui::BeginCombo("Resampler", GetResamplerQualityName(snapshot->resampler_quality))) {
+                    for (ResamplerQuality quality : kResamplerQualities) {
+                        if (ImGui::Selectable(GetResamplerQualityName(quality), quality == snapshot->resampler_quality)) {
+                            PostPlayerCommand(state, {PlayerCommandType::SetResampler, static_cast<int>(quality)});
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+
+                if (ImGui::CollapsingHeader("Library", ImGuiTreeNodeFlags_DefaultOpen)) {
+                    RenderLibraryTable(state, *snapshot);
                 }
-            } else if (!state.is_loading_music) {
+            } else if (!snapshot->is_loading_music) {
                  ImGui::Text("Current track index invalid. Please refresh or select a track.");
             }
 
-        } else if (!state.is_loading_music) {
-            ImGui::Text("No tracks found in '%s'", state.music_directory.string().c_str());
+        } else if (!snapshot->is_loading_music) {
+            ImGui::Text("No tracks found in '%s'", snapshot->music_directory.c_str());
             ImGui::Text("Please add MP3 or WAV files and click 'Refresh Music List'.");
         }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Zones")) {
+            RenderZones(state);
+        }
+        if (ImGui::CollapsingHeader("Cue Pads")) {
+            RenderCuePads(state);
+        }
+        if (ImGui::CollapsingHeader("Recording")) {
+            RenderRecordingControls(state);
+        }
+        if (ImGui::CollapsingHeader("HTTP Stream")) {
+            RenderHttpStream(state);
+        }
+        if (ImGui::CollapsingHeader("Limiter")) {
+            RenderLimiterControls(state);
+        }
+        if (ImGui::CollapsingHeader("Duplicate Finder")) {
+            if (state.is_scanning_duplicates) {
+                ImGui::Text("Fingerprinting tracks... %d / %d", state.duplicate_scan_progress->load(), state.duplicate_scan_total);
+            } else if (ImGui::Button("Find Duplicates")) {
+                spdlog::info("'Find Duplicates' button clicked.");
+                TriggerDuplicateScanAsync(state);
+            }
+            for (size_t group_index = 0; group_index < state.duplicate_groups.size(); ++group_index) {
+                ImGui::Text("Group %zu:", group_index + 1);
+                for (const auto& track : state.duplicate_groups[group_index]) {
+                    ImGui::BulletText("%s", std::filesystem::path(track).filename().string().c_str());
+                }
+            }
+            if (state.duplicate_scan_completed && !state.is_scanning_duplicates && state.duplicate_groups.empty()) {
+                ImGui::Text("No duplicates found.");
+            }
+        }
+        ImGui::Separator();
+        ImGui::Checkbox("Show Diagnostics", &state.show_diagnostics_window);
+#if AUDIOPLAYER_PROFILER
+        ImGui::SameLine();
+        ImGui::Checkbox("Show Profiler", &state.show_profiler_window);
+#endif
         // ----- End UI Content -----
     }
     ImGui::End(); // Always call End if Begin was called.
@@ -442,57 +2336,167 @@ void RenderUI(PlayerState& state) {
 void ProcessAudioEvents(PlayerState& state) {
     if (state.track_ended_flag.exchange(false)) {
         if (state.is_playing) {
-            std::string ended_track_name = "Unknown Track";
+            std::string_view ended_track_name = "Unknown Track";
             if (!state.track_list.empty() && state.current_track_index >=0 && state.current_track_index < static_cast<int>(state.track_list.size())) {
-                 ended_track_name = std::filesystem::path(state.track_list[state.current_track_index]).filename().string();
+                 ended_track_name = GetFileNamePart(state.track_list[state.current_track_index]);
             }
-            spdlog::info("Track '{}' ended (callback). Playing next.", ended_track_name);
+            HOT_LOG_INFO("Track '{}' ended (callback). Playing next.", ended_track_name);
+            LogEvent(EventType::TrackEnded, state.current_track_index, 0.0, ended_track_name);
             HandleNextTrack(state);
         } else {
-            spdlog::debug("Track ended (callback), but player was not in 'is_playing' state. Not proceeding to next.");
+            HOT_LOG_DEBUG("Track ended (callback), but player was not in 'is_playing' state. Not proceeding to next.");
         }
     }
 }
 
 // --- Cleanup ---
+// Whether this frame has to build and draw the UI. A GLFW input, resize or expose event (see
+// g_ui_event_count) or a new player snapshot marks the UI dirty; it then keeps rendering for a few frames so hover and layout changes
+// settle. Otherwise the previous swap stays on screen, redrawn every idle_refresh_time so progress
+// counters and meters stay current.
+bool NeedsUiRender(PlayerState& state, double now, double idle_refresh_time) {
+    constexpr int kUiSettleFrames = 3;
+    const PlayerSnapshot* snapshot = state.snapshot.Read();
+    const uint64_t snapshot_version = snapshot ? snapshot->version : 0;
+    if (g_ui_event_count != state.rendered_ui_event_count || snapshot_version != state.rendered_snapshot_version) {
+        state.rendered_ui_event_count = g_ui_event_count;
+        state.rendered_snapshot_version = snapshot_version;
+        state.ui_settle_frames = kUiSettleFrames;
+    }
+    bool render = state.always_render_ui || state.ui_settle_frames > 0 || now - state.last_ui_render_time >= idle_refresh_time;
+#if AUDIOPLAYER_PROFILER
+    render = render || state.show_profiler_window; // The frame-time graph is per frame
+#endif
+    if (!render) {
+        ++state.ui_frames_skipped;
+        return false;
+    }
+    if (state.ui_settle_frames > 0) {
+        --state.ui_settle_frames;
+    }
+    state.last_ui_render_time = now;
+    ++state.ui_frames_rendered;
+    return true;
+}
+
 void Cleanup(GLFWwindow* window, PlayerState& state) {
     spdlog::info("Starting cleanup...");
+    // An early exit can arrive while the background startup still owns the engine or the library.
+    if (state.audio_init_future.valid()) {
+        state.audio_init_future.wait();
+    }
+    if (state.library_load_future.valid()) {
+        state.library_load_future.wait();
+    }
+    if (state.font_atlas_future.valid()) {
+        state.font_atlas_future.wait();
+    }
+    if (state.cue_load_future.valid()) {
+        state.cue_load_future.wait(); // Its decodes run on worker_pool
+    }
+    if (state.ui_frames_rendered > 0) {
+        spdlog::info("UI draw ({}): {:.3f} ms per rendered frame over {} frames, {} unchanged frames skipped.",
+                     state.use_viewports ? "multi-viewport" : "single window", state.ui_present_seconds * 1000.0 / state.ui_frames_rendered,
+                     state.ui_frames_rendered, state.ui_frames_skipped);
+    }
+    DestroyAllZones(state); // Zones share the resource manager, which is released below
+    ma_engine_stop(&state.engine); // The process callback uses the output taps and soundboard, released next
+    UninitializeOutputRecorder(state.output_recorder); // Flushes and finalises the current recording
+    UninitializeHttpStream(state.http_stream);
+    StopTrackPrefetcher(state.prefetcher);
+    StopTrackStaging(state.staging);
+    UninitializeSoundboard(state.soundboard);
+    AbandonTrackOpen(state);
+    ReapAbandonedTrackOpens(state, true);
     UninitializeCurrentSound(state);
+    if (state.master_chain_initialized) {
+        ma_sound_group_uninit(&state.master_bus);
+        UninitializeLimiterNode(&state.limiter);
+        UninitializeVolumeNode(&state.master_volume);
+        state.master_chain_initialized = false;
+    }
     ma_engine_uninit(&state.engine);
+    if (state.resource_manager_initialized) {
+        StopResourceJobPool(state.resource_jobs); // After every data source is gone: uninitialising one waits on a job
+        ma_resource_manager_uninit(&state.resource_manager);
+        state.resource_manager_initialized = false;
+    }
     spdlog::info("Miniaudio engine uninitialized.");
 
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-    spdlog::info("ImGui shutdown.");
+    if (ImGui::GetCurrentContext()) { // Created only once the font atlas is in
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+        spdlog::info("ImGui shutdown.");
+    }
 
     if (window) {
         glfwDestroyWindow(window);
     }
     glfwTerminate();
     spdlog::info("GLFW terminated. Application finished.");
+    CloseEventLog();
+    StopHotLog();
     spdlog::shutdown();
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    const auto launch_time = std::chrono::steady_clock::now();
     InitializeSpdlog();
+    SetTraceThreadName("Main");
+    LogStartupStage("logging", launch_time, launch_time);
+
+    bool use_viewports = false;
+    ResourceJobConfig job_config; // 0 = sized from the core count
+    bool stage_tracks = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--trace") {
+            SetTracingEnabled(true); // From startup, so the initial scan and first frames are captured
+        }
+        if (arg == "--event-log" || arg.starts_with("--event-log=")) {
+            OpenEventLog(arg.size() > 12 ? std::filesystem::path(arg.substr(12)) : std::filesystem::path("audioplayer_events.bin"));
+        }
+        if (arg == "--viewports") {
+            use_viewports = true; // Floating native windows instead of the single player window
+        }
+        if (arg.starts_with("--job-threads=")) {
+            std::from_chars(arg.data() + 14, arg.data() + arg.size(), job_config.max_threads);
+        }
+        if (arg.starts_with("--job-queue=")) {
+            std::from_chars(arg.data() + 12, arg.data() + arg.size(), job_config.job_queue_capacity);
+        }
+        if (arg == "--stage-tracks") {
+            stage_tracks = true; // Copy upcoming tracks to local disk even if the scan finds the storage fast
+        }
+    }
 
     GLFWwindow* window = nullptr;
     ImGuiIO* imgui_io = nullptr;
     PlayerState playerState; // playerState.show_music_player_window defaults to true
-
-    if (!InitializeGLFW(window, "Music Player Backend")) { Cleanup(window, playerState); return -1; }
+    playerState.use_viewports = use_viewports;
+    playerState.resource_job_config = job_config;
+    playerState.staging_enabled = stage_tracks;
+
+    StartBackgroundStartup(playerState, launch_time);
+    auto stage_start = std::chrono::steady_clock::now();
+    playerState.font_atlas_future = StartFontAtlasBuild();
+    if (!InitializeGLFW(window, use_viewports ? "Music Player Backend" : "Music Player", use_viewports)) { Cleanup(window, playerState); return -1; }
     if (!InitializeGLEW()) { Cleanup(window, playerState); return -1; }
-    if (!InitializeImGui(window, imgui_io)) { Cleanup(window, playerState); return -1; }
-    if (!InitializeMiniaudio(playerState)) { Cleanup(window, playerState); return -1; }
-
-    TriggerLoadMusicFilesAsync(playerState, true);
+    LogStartupStage("GL context", stage_start, launch_time);
+    stage_start = std::chrono::steady_clock::now();
+    if (!InitializeImGui(window, imgui_io, use_viewports, playerState.font_atlas_future, playerState.font_atlas)) { Cleanup(window, playerState); return -1; }
+    LogStartupStage("ImGui", stage_start, launch_time);
 
     spdlog::info("Main loop starting...");
 
     const double target_frame_time = 1.0 / 60.0;
-    double last_frame_time = glfwGetTime();
+    const double slow_frame_time = 0.1; // Frame gaps above this go to the event log
+    const double idle_ui_refresh_time = 0.25; // Redraw rate of an unchanged UI
+    double last_frame_time = glfwGetTime() - target_frame_time; // Draw the first frame straight away
+    bool first_frame_shown = false;
+    int exit_code = 0;
 
     // Main loop continues as long as the (hidden) GLFW window isn't closed AND the ImGui window is not closed by the user.
     while (!glfwWindowShouldClose(window) && playerState.show_music_player_window) {
@@ -504,35 +2508,100 @@ int main() {
             continue;
         }
         last_frame_time = current_time;
+        if (elapsed_time > slow_frame_time) {
+            LogEvent(EventType::SlowFrame, 0, elapsed_time * 1000.0);
+        }
+        PROFILE_FRAME_BEGIN(playerState.frame_profiler);
+        TRACE_SCOPE("Frame");
 
-        glfwPollEvents();
-
-        ProcessAsyncMusicLoadCompletion(playerState);
-        ProcessAudioEvents(playerState);
+        {
+            PROFILE_SECTION(playerState.frame_profiler, FrameSection::PollEvents);
+            glfwPollEvents();
+        }
+        if (!playerState.startup_complete && !ProcessStartupCompletion(playerState)) {
+            spdlog::critical("Audio engine failed to start; exiting.");
+            exit_code = -1;
+            break;
+        }
+        if (playerState.startup_complete) {
+            {
+                PROFILE_SECTION(playerState.frame_profiler, FrameSection::MusicLoad);
+                ProcessAsyncMusicLoadCompletion(playerState);
+            }
+            {
+                PROFILE_SECTION(playerState.frame_profiler, FrameSection::AudioEvents);
+                ProcessTrackOpenCompletion(playerState);
+                ProcessResourceJobs(playerState);
+                ProcessAudioEvents(playerState);
+            }
+            {
+                PROFILE_SECTION(playerState.frame_profiler, FrameSection::OtherEvents);
+                ProcessDuplicateScanCompletion(playerState);
+                ProcessLibraryAnalysisCompletion(playerState);
+                ProcessZoneEvents(playerState);
+                ProcessCueLoadCompletion(playerState);
+            }
+        }
+        ProcessPlayerCommands(playerState);
+        ValidateCurrentTrack(playerState);
+        PublishPlayerSnapshot(playerState);
+        if (!NeedsUiRender(playerState, current_time, idle_ui_refresh_time)) {
+            continue; // Nothing changed: skip NewFrame/Render and leave the last frame on screen
+        }
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+        {
+            PROFILE_SECTION(playerState.frame_profiler, FrameSection::RenderUI);
+            TRACE_SCOPE("RenderUI");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
 
-        RenderUI(playerState);
+            RenderUI(playerState);
+            if (playerState.show_diagnostics_window) {
+                RenderDiagnosticsWindow(playerState);
+            }
+#if AUDIOPLAYER_PROFILER
+            if (playerState.show_profiler_window) {
+                RenderProfilerWindow(playerState);
+            }
+#endif
+            playerState.snapshot.ReportQuiescent(); // The UI holds no snapshot past this point
+        }
 
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h); // For the backend window
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // Clear backend window (mostly unseen with viewports)
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        const double draw_start_time = glfwGetTime();
+        {
+            PROFILE_SECTION(playerState.frame_profiler, FrameSection::ImGuiRender);
+            int display_w, display_h;
+            glfwGetFramebufferSize(window, &display_w, &display_h);
+            glViewport(0, 0, display_w, display_h);
+            if (playerState.use_viewports) {
+                glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // Clear backend window (mostly unseen with viewports)
+            } else {
+                const ImVec4& background = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
+                glClearColor(background.x, background.y, background.z, 1.0f);
+            }
+            glClear(GL_COLOR_BUFFER_BIT);
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
         if (imgui_io && (imgui_io->ConfigFlags & ImGuiConfigFlags_ViewportsEnable)) {
+            PROFILE_SECTION(playerState.frame_profiler, FrameSection::PlatformWindows);
             GLFWwindow* backup_current_context = glfwGetCurrentContext();
             ImGui::UpdatePlatformWindows();
-            ImGui::RenderPlatformWindowsDefault();
+            ImGui::RenderPlatformWindowsDefault(); // A context switch and swap per floating window
             glfwMakeContextCurrent(backup_current_context);
         }
-        glfwSwapBuffers(window); // For the backend window
+        playerState.ui_present_seconds += glfwGetTime() - draw_start_time;
+        PROFILE_SECTION(playerState.frame_profiler, FrameSection::Swap);
+        glfwSwapBuffers(window);
+        if (!first_frame_shown) {
+            first_frame_shown = true;
+            spdlog::info("Startup: first frame shown {:.1f} ms after launch.",
+                         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launch_time).count());
+        }
     }
 
     Cleanup(window, playerState);
-    return 0;
+    return exit_code;
 }
\ No newline at end of file
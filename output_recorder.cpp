@@ -0,0 +1,358 @@
+#include "output_recorder.h"
+
+#include "event_log.h"
+#include "hot_log.h"
+#include "pcm_ring.h"
+#include "trace.h"
+#include "wav_format.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr ma_uint32 kStagingFrames = 4096;
+constexpr uint32_t kBitsPerSample = 16;
+
+struct AlignedDelete {
+    void operator()(char* memory) const { ::operator delete(memory, std::align_val_t{kRecorderAlignment}); }
+};
+using AlignedBuffer = std::unique_ptr<char, AlignedDelete>;
+
+// --- File Output ---
+// One WAV file being written. The header goes out with the first block (sizes unknown, so a file
+// cut short by a crash is still readable) and is patched with the real sizes when it is closed.
+struct RecordingFile {
+#if defined(__linux__)
+    int fd = -1;
+    bool direct = false;
+#else
+    std::FILE* file = nullptr;
+#endif
+    std::filesystem::path path;
+    uint64_t data_bytes = 0;
+};
+
+bool IsOpen(const RecordingFile& file) {
+#if defined(__linux__)
+    return file.fd >= 0;
+#else
+    return file.file != nullptr;
+#endif
+}
+
+bool OpenRecordingFile(RecordingFile& file, const std::filesystem::path& path, bool want_direct) {
+    file.path = path;
+    file.data_bytes = 0;
+#if defined(__linux__)
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    file.direct = false;
+    if (want_direct) {
+        file.fd = open(path.c_str(), flags | O_DIRECT, 0644);
+        file.direct = file.fd >= 0;
+        if (file.fd < 0) {
+            spdlog::warn("Recorder: O_DIRECT unavailable for '{}' ({}); using buffered writes.", path.string(), std::strerror(errno));
+        }
+    }
+    if (file.fd < 0) {
+        file.fd = open(path.c_str(), flags, 0644);
+    }
+#else
+    (void)want_direct;
+    file.file = std::fopen(path.string().c_str(), "wb");
+#endif
+    if (!IsOpen(file)) {
+        spdlog::error("Recorder: cannot create '{}'.", path.string());
+        return false;
+    }
+    return true;
+}
+
+// Writes `bytes` from the aligned buffer; with O_DIRECT, `bytes` is a multiple of kRecorderAlignment.
+bool WriteRecordingBlock(RecordingFile& file, const char* data, size_t bytes) {
+#if defined(__linux__)
+    size_t done = 0;
+    while (done < bytes) {
+        const ssize_t written = write(file.fd, data + done, bytes - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EINVAL && file.direct) {
+                // Some filesystems accept the O_DIRECT open but not the writes.
+                spdlog::warn("Recorder: O_DIRECT write rejected; switching to buffered writes.");
+                fcntl(file.fd, F_SETFL, fcntl(file.fd, F_GETFL) & ~O_DIRECT);
+                file.direct = false;
+                continue;
+            }
+            spdlog::error("Recorder: write to '{}' failed: {}", file.path.string(), std::strerror(errno));
+            return false;
+        }
+        done += static_cast<size_t>(written);
+    }
+    return true;
+#else
+    return std::fwrite(data, 1, bytes, file.file) == bytes;
+#endif
+}
+
+void CloseRecordingFile(RecordingFile& file, ma_uint32 channels, ma_uint32 sample_rate) {
+    if (!IsOpen(file)) {
+        return;
+    }
+    const auto header = BuildWavHeader(channels, sample_rate, kBitsPerSample, false, static_cast<uint32_t>(file.data_bytes));
+#if defined(__linux__)
+    // The last block was padded for O_DIRECT; cut the file back to its real length.
+    if (ftruncate(file.fd, static_cast<off_t>(kWavHeaderSize + file.data_bytes)) != 0) {
+        spdlog::warn("Recorder: could not trim '{}': {}", file.path.string(), std::strerror(errno));
+    }
+    close(file.fd);
+    file.fd = -1;
+    // The header patch is unaligned, so it goes through a regular descriptor.
+    const int fd = open(file.path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0 || pwrite(fd, header.data(), header.size(), 0) != static_cast<ssize_t>(header.size())) {
+        spdlog::warn("Recorder: could not finalise the header of '{}'.", file.path.string());
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+#else
+    std::fseek(file.file, 0, SEEK_SET);
+    std::fwrite(header.data(), 1, header.size(), file.file);
+    std::fclose(file.file);
+    file.file = nullptr;
+#endif
+}
+
+std::filesystem::path MakeRecordingPath(const std::filesystem::path& directory) {
+    const std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+    std::filesystem::path path = directory / fmt::format("output_{}.wav", stamp);
+    for (int suffix = 2; std::filesystem::exists(path); ++suffix) {
+        path = directory / fmt::format("output_{}_{}.wav", stamp, suffix);
+    }
+    return path;
+}
+
+// --- Writer ---
+class RecordingWriter {
+public:
+    explicit RecordingWriter(OutputRecorder& recorder)
+        : recorder(recorder),
+          bytes_per_frame(recorder.channels * (kBitsPerSample / 8)),
+          buffer(static_cast<char*>(::operator new(kRecorderWriteBytes, std::align_val_t{kRecorderAlignment}))),
+          staging(static_cast<size_t>(kStagingFrames) * recorder.channels) {
+        // Keep each file under 4 GB including the header and the final block's padding.
+        const uint64_t size_limit_frames = (UINT32_MAX - kWavHeaderSize - kRecorderAlignment) / bytes_per_frame;
+        segment_limit_frames = std::min<uint64_t>(static_cast<uint64_t>(kRecorderSegmentSeconds * recorder.sample_rate), size_limit_frames);
+    }
+
+    void StartSegment() {
+        fill = 0;
+        segment_frames = 0;
+        if (!OpenRecordingFile(file, MakeRecordingPath(recorder.directory), recorder.use_direct_io)) {
+            recorder.stats.write_errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+#if defined(__linux__)
+        recorder.stats.direct_io_active.store(file.direct, std::memory_order_relaxed);
+#endif
+        {
+            std::lock_guard<std::mutex> lock(recorder.file_mutex);
+            recorder.current_file = file.path.string();
+        }
+        const auto header = BuildWavHeader(recorder.channels, recorder.sample_rate, kBitsPerSample, false, kWavUnknownSize);
+        std::memcpy(buffer.get(), header.data(), header.size());
+        fill = header.size();
+        spdlog::info("Recording to '{}'.", file.path.string());
+    }
+
+    void FinishSegment() {
+        if (!IsOpen(file)) {
+            return;
+        }
+        if (fill > 0) {
+            // Pad the tail to the alignment; the file is trimmed back when it is closed.
+            const size_t padded = (fill + kRecorderAlignment - 1) / kRecorderAlignment * kRecorderAlignment;
+            std::memset(buffer.get() + fill, 0, padded - fill);
+            WriteBlock(padded);
+        }
+        CloseRecordingFile(file, recorder.channels, recorder.sample_rate);
+        recorder.stats.files_written.fetch_add(1, std::memory_order_relaxed);
+        spdlog::info("Finished recording '{}' ({:.1f} MB).", file.path.string(), file.data_bytes / (1024.0 * 1024.0));
+    }
+
+    // Converts and buffers `count` f32 frames, writing whenever the buffer fills.
+    void Append(const float* frames, ma_uint32 count) {
+        ma_pcm_f32_to_s16(staging.data(), frames, static_cast<ma_uint64>(count) * recorder.channels, ma_dither_mode_triangle);
+        segment_frames += count;
+        if (!IsOpen(file)) {
+            return; // The file could not be created; the error is already counted
+        }
+        const char* bytes = reinterpret_cast<const char*>(staging.data());
+        size_t remaining = static_cast<size_t>(count) * bytes_per_frame;
+        file.data_bytes += remaining;
+        while (remaining > 0) {
+            const size_t take = std::min(remaining, kRecorderWriteBytes - fill);
+            std::memcpy(buffer.get() + fill, bytes, take);
+            fill += take;
+            bytes += take;
+            remaining -= take;
+            if (fill == kRecorderWriteBytes) {
+                WriteBlock(fill);
+            }
+        }
+    }
+
+    void Run(std::stop_token stop_token) {
+        StartSegment();
+        ma_pcm_rb* ring = &recorder.ring;
+        while (true) {
+            // Checked before reading the fill level, so everything captured before the stop is written.
+            const bool stopping = stop_token.stop_requested();
+            ma_uint32 available = ma_pcm_rb_available_read(ring);
+            recorder.stats.fill_frames.store(available, std::memory_order_relaxed);
+            if (available > recorder.stats.peak_fill_frames.load(std::memory_order_relaxed)) {
+                recorder.stats.peak_fill_frames.store(available, std::memory_order_relaxed);
+            }
+            if (available == 0) {
+                if (stopping) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                continue;
+            }
+            while (available > 0) {
+                ma_uint32 count = static_cast<ma_uint32>(std::min<uint64_t>({available, kStagingFrames, segment_limit_frames - segment_frames}));
+                void* frames = nullptr;
+                if (ma_pcm_rb_acquire_read(ring, &count, &frames) != MA_SUCCESS || count == 0) {
+                    break;
+                }
+                Append(static_cast<const float*>(frames), count);
+                ma_pcm_rb_commit_read(ring, count);
+                available -= count;
+                if (segment_frames == segment_limit_frames) {
+                    FinishSegment();
+                    StartSegment();
+                }
+            }
+        }
+        FinishSegment();
+    }
+
+private:
+    void WriteBlock(size_t bytes) {
+        if (WriteRecordingBlock(file, buffer.get(), bytes)) {
+            recorder.stats.bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+        } else {
+            recorder.stats.write_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        fill = 0;
+    }
+
+    OutputRecorder& recorder;
+    const size_t bytes_per_frame;
+    AlignedBuffer buffer;
+    std::vector<int16_t> staging;
+    RecordingFile file;
+    size_t fill = 0;
+    uint64_t segment_frames = 0;
+    uint64_t segment_limit_frames = 0;
+};
+
+void WriterLoop(std::stop_token stop_token, OutputRecorder* recorder) {
+    SetTraceThreadName("Recorder Writer");
+    RecordingWriter writer(*recorder);
+    writer.Run(stop_token);
+}
+
+} // namespace
+
+bool StartOutputRecorder(OutputRecorder& recorder, ma_uint32 channels, ma_uint32 sample_rate) {
+    if (recorder.running) {
+        return true;
+    }
+    if (recorder.ring_initialized && (recorder.channels != channels || recorder.sample_rate != sample_rate)) {
+        spdlog::error("Recorder: output format changed; restart the player to record.");
+        return false;
+    }
+    if (!recorder.ring_initialized) {
+        // Allocated once and kept: the audio thread may still be inside a write when recording stops.
+        recorder.ring_frames = static_cast<ma_uint32>(kRecorderRingSeconds * sample_rate);
+        ma_result result = ma_pcm_rb_init(ma_format_f32, channels, recorder.ring_frames, nullptr, nullptr, &recorder.ring);
+        if (result != MA_SUCCESS) {
+            spdlog::error("Recorder: failed to allocate ring buffer: {}", ma_result_description(result));
+            return false;
+        }
+        recorder.ring_initialized = true;
+    }
+    try {
+        std::filesystem::create_directories(recorder.directory);
+    } catch (const std::filesystem::filesystem_error& e) {
+        spdlog::error("Recorder: cannot create '{}': {}", recorder.directory.string(), e.what());
+        return false;
+    }
+    ma_pcm_rb_reset(&recorder.ring);
+    recorder.channels = channels;
+    recorder.sample_rate = sample_rate;
+    recorder.stats.peak_fill_frames.store(0);
+    recorder.stats.dropped_blocks.store(0);
+    recorder.stats.dropped_frames.store(0);
+    recorder.writer_thread = std::jthread(WriterLoop, &recorder);
+    recorder.capturing.store(true, std::memory_order_release);
+    recorder.running = true;
+    LogEvent(EventType::RecordingStarted, sample_rate);
+    return true;
+}
+
+void StopOutputRecorder(OutputRecorder& recorder) {
+    if (!recorder.running) {
+        return;
+    }
+    recorder.capturing.store(false, std::memory_order_release);
+    recorder.writer_thread = std::jthread(); // Requests stop; the writer drains the ring and finalises the file
+    recorder.running = false;
+    LogEvent(EventType::RecordingStopped, static_cast<int64_t>(recorder.stats.dropped_frames.load()),
+             recorder.stats.bytes_written.load() / (1024.0 * 1024.0));
+    std::lock_guard<std::mutex> lock(recorder.file_mutex);
+    recorder.current_file.clear();
+}
+
+void UninitializeOutputRecorder(OutputRecorder& recorder) {
+    StopOutputRecorder(recorder);
+    if (recorder.ring_initialized) {
+        ma_pcm_rb_uninit(&recorder.ring);
+        recorder.ring_initialized = false;
+    }
+}
+
+std::string GetRecorderCurrentFile(OutputRecorder& recorder) {
+    std::lock_guard<std::mutex> lock(recorder.file_mutex);
+    return recorder.current_file;
+}
+
+void WriteOutputRecorderFrames(OutputRecorder& recorder, const float* frames, ma_uint64 frame_count) {
+    if (!recorder.capturing.load(std::memory_order_acquire)) {
+        return;
+    }
+    const ma_uint64 written = WritePcmRing(&recorder.ring, recorder.channels, frames, frame_count);
+    if (written < frame_count) {
+        recorder.stats.dropped_blocks.fetch_add(1, std::memory_order_relaxed);
+        recorder.stats.dropped_frames.fetch_add(frame_count - written, std::memory_order_relaxed);
+        HOT_LOG_WARN("Recorder: ring buffer full, dropped {} frames.", frame_count - written);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Continuous recording of the output mix. The audio thread only copies into a lock-free ring;
+// a writer thread converts to 16-bit PCM and writes WAV files in large, block-aligned writes,
+// optionally with O_DIRECT so the page cache never builds up a burst of dirty pages that stalls
+// on a slow card. Files roll over every kRecorderSegmentSeconds to stay within WAV's 4 GB limit.
+
+constexpr double kRecorderRingSeconds = 10.0;      // How long the disk may stall before blocks are dropped
+constexpr size_t kRecorderWriteBytes = 1 << 20;    // Size of each disk write
+constexpr size_t kRecorderAlignment = 4096;        // Buffer, offset and length alignment for O_DIRECT
+constexpr double kRecorderSegmentSeconds = 3600.0;
+
+struct RecorderStats {
+    std::atomic<uint32_t> fill_frames{0};      // Ring occupancy as last seen by the writer
+    std::atomic<uint32_t> peak_fill_frames{0};
+    std::atomic<uint64_t> dropped_blocks{0};   // Audio periods that did not fit in the ring
+    std::atomic<uint64_t> dropped_frames{0};
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> write_errors{0};
+    std::atomic<uint32_t> files_written{0};
+    std::atomic<bool> direct_io_active{false};
+};
+
+struct OutputRecorder {
+    ma_pcm_rb ring{};
+    bool ring_initialized = false;
+    ma_uint32 channels = 0;
+    ma_uint32 sample_rate = 0;
+    ma_uint32 ring_frames = 0;
+    std::atomic<bool> capturing{false};
+    bool running = false;
+
+    std::filesystem::path directory = "./recordings/";
+    bool use_direct_io = true;
+
+    std::mutex file_mutex; // Guards current_file, which the writer changes on rollover
+    std::string current_file;
+    std::jthread writer_thread;
+    RecorderStats stats;
+};
+
+// Starts capturing and writing into `recorder.directory`. False if the ring cannot be created.
+bool StartOutputRecorder(OutputRecorder& recorder, ma_uint32 channels, ma_uint32 sample_rate);
+// Stops capturing, flushes what is buffered and finalises the current file.
+void StopOutputRecorder(OutputRecorder& recorder);
+// Releases the ring. Call once the engine no longer runs the audio callback.
+void UninitializeOutputRecorder(OutputRecorder& recorder);
+std::string GetRecorderCurrentFile(OutputRecorder& recorder);
+
+// Audio thread: queue one period of interleaved f32 output. Never blocks or allocates.
+void WriteOutputRecorderFrames(OutputRecorder& recorder, const float* frames, ma_uint64 frame_count);
@@ -0,0 +1,20 @@
+#include "pcm_ring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+ma_uint64 WritePcmRing(ma_pcm_rb* ring, ma_uint32 channels, const float* frames, ma_uint64 frame_count) {
+    ma_uint64 written = 0;
+    while (written < frame_count) {
+        ma_uint32 count = static_cast<ma_uint32>(std::min<ma_uint64>(frame_count - written, UINT32_MAX));
+        void* buffer = nullptr;
+        if (ma_pcm_rb_acquire_write(ring, &count, &buffer) != MA_SUCCESS || count == 0) {
+            break;
+        }
+        std::memcpy(buffer, frames + written * channels, static_cast<size_t>(count) * channels * sizeof(float));
+        ma_pcm_rb_commit_write(ring, count);
+        written += count;
+    }
+    return written;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "miniaudio.h"
+
+// Helpers over ma_pcm_rb (single producer, single consumer, lock-free) for taps on the output mix.
+
+// Audio thread: copies up to `frame_count` interleaved f32 frames in, across the wrap point.
+// Returns the frames that fit; never blocks or allocates.
+ma_uint64 WritePcmRing(ma_pcm_rb* ring, ma_uint32 channels, const float* frames, ma_uint64 frame_count);
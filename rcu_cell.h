@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Single-writer, single-reader RCU cell. The writer publishes immutable values by swapping a
+// pointer; the reader gets the latest one with one acquire load and never blocks or copies. Old
+// values are freed by the writer once the reader has passed a quiescent point (ReportQuiescent,
+// e.g. the end of a frame) after they were replaced, so a pointer from Read stays valid until the
+// reader's next ReportQuiescent.
+template <typename T>
+class RcuCell {
+public:
+    RcuCell() = default;
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+    ~RcuCell() { delete current_.load(std::memory_order_relaxed); }
+
+    // Reader. Null until the first Publish.
+    const T* Read() const { return current_.load(std::memory_order_acquire); }
+
+    // Reader: holds no pointer obtained from Read before this call.
+    void ReportQuiescent() { reader_epoch_.store(epoch_.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Writer.
+    void Publish(std::unique_ptr<const T> value) {
+        const T* previous = current_.exchange(value.release(), std::memory_order_acq_rel);
+        const uint64_t retire_epoch = epoch_.fetch_add(1, std::memory_order_release) + 1;
+        if (previous) {
+            retired_.emplace_back(retire_epoch, std::unique_ptr<const T>(previous));
+        }
+        Reclaim();
+    }
+
+    // Writer: frees the values the reader can no longer hold.
+    void Reclaim() {
+        const uint64_t safe_epoch = reader_epoch_.load(std::memory_order_acquire);
+        std::erase_if(retired_, [safe_epoch](const auto& retired) { return retired.first <= safe_epoch; });
+    }
+
+    size_t GetRetiredCount() const { return retired_.size(); } // Writer
+
+private:
+    std::atomic<const T*> current_{nullptr};
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<uint64_t> reader_epoch_{0};
+    std::vector<std::pair<uint64_t, std::unique_ptr<const T>>> retired_; // Writer only
+};
@@ -0,0 +1,348 @@
+#include "resampler.h"
+
+#include "dsp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <tuple>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr uint32_t kResamplerPhases = 256;
+constexpr size_t kResamplerChunkFrames = 1024;        // History room beyond the filter length
+constexpr ma_uint64 kResamplingSourceBlockFrames = 1024;
+
+struct QualityPreset {
+    uint32_t taps;
+    double kaiser_beta;
+    double rolloff; // Passband edge as a fraction of the lower Nyquist frequency
+};
+
+QualityPreset GetQualityPreset(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Low: return {16, 6.0, 0.85};
+        case ResamplerQuality::Medium: return {32, 8.0, 0.92};
+        case ResamplerQuality::High: return {64, 10.0, 0.96};
+        case ResamplerQuality::Builtin: break;
+    }
+    return {0, 0.0, 0.0};
+}
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+std::shared_ptr<const ResamplerFilterBank> CreateFilterBank(ResamplerQuality quality, uint32_t input_rate, uint32_t output_rate) {
+    const QualityPreset preset = GetQualityPreset(quality);
+    auto bank = std::make_shared<ResamplerFilterBank>();
+    bank->taps = preset.taps;
+    bank->phases = kResamplerPhases;
+    bank->coefficients.resize(static_cast<size_t>(bank->phases + 1) * bank->taps);
+
+    // Cutoff relative to the input Nyquist; when downsampling it moves down to the output Nyquist.
+    const double cutoff = std::min(1.0, static_cast<double>(output_rate) / input_rate) * preset.rolloff;
+    const double half_span = bank->taps / 2.0;
+    const double window_norm = BesselI0(preset.kaiser_beta);
+    for (uint32_t phase = 0; phase <= bank->phases; ++phase) {
+        float* row = &bank->coefficients[static_cast<size_t>(phase) * bank->taps];
+        const double fraction = static_cast<double>(phase) / bank->phases;
+        double sum = 0.0;
+        for (uint32_t k = 0; k < bank->taps; ++k) {
+            // Distance from the output instant to tap k (taps cover [ipos - taps/2 + 1, ipos + taps/2]).
+            double x = fraction + half_span - 1.0 - k;
+            double sinc_arg = std::numbers::pi * cutoff * x;
+            double sinc = sinc_arg == 0.0 ? 1.0 : std::sin(sinc_arg) / sinc_arg;
+            double r = std::clamp(x / half_span, -1.0, 1.0);
+            double window = BesselI0(preset.kaiser_beta * std::sqrt(1.0 - r * r)) / window_norm;
+            row[k] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+        for (uint32_t k = 0; k < bank->taps; ++k) {
+            row[k] = static_cast<float>(row[k] / sum); // Unity DC gain for every phase
+        }
+    }
+    return bank;
+}
+
+} // namespace
+
+const char* GetResamplerQualityName(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::Builtin: return "Built-in (linear)";
+        case ResamplerQuality::Low: return "Sinc 16";
+        case ResamplerQuality::Medium: return "Sinc 32";
+        case ResamplerQuality::High: return "Sinc 64";
+    }
+    return "Unknown";
+}
+
+std::shared_ptr<const ResamplerFilterBank> GetResamplerFilterBank(ResamplerQuality quality, uint32_t input_rate, uint32_t output_rate) {
+    if (quality == ResamplerQuality::Builtin) {
+        return nullptr;
+    }
+    static std::mutex cache_mutex;
+    static std::map<std::tuple<ResamplerQuality, uint32_t, uint32_t>, std::shared_ptr<const ResamplerFilterBank>> cache;
+    std::lock_guard lock(cache_mutex);
+    auto& bank = cache[{quality, input_rate, output_rate}];
+    if (!bank) {
+        bank = CreateFilterBank(quality, input_rate, output_rate);
+        spdlog::debug("Created {} filter bank for {} -> {} Hz.", GetResamplerQualityName(quality), input_rate, output_rate);
+    }
+    return bank;
+}
+
+bool InitializeResampler(Resampler& resampler, ResamplerQuality quality, uint32_t channels, uint32_t input_rate, uint32_t output_rate) {
+    if (quality == ResamplerQuality::Builtin || channels == 0 || input_rate == 0 || output_rate == 0) {
+        return false;
+    }
+    resampler.bank = GetResamplerFilterBank(quality, input_rate, output_rate);
+    resampler.channels = channels;
+    resampler.input_rate = input_rate;
+    resampler.output_rate = output_rate;
+    resampler.step = static_cast<double>(input_rate) / output_rate;
+    resampler.capacity_frames = resampler.bank->taps + kResamplerChunkFrames;
+    resampler.history.assign(resampler.capacity_frames * channels, 0.0f);
+    resampler.coefficient_scratch.assign(resampler.bank->taps, 0.0f);
+    ResetResampler(resampler);
+    return true;
+}
+
+void ResetResampler(Resampler& resampler) {
+    // Prime with taps/2 - 1 zeros so output frame 0 lines up with input frame 0.
+    const size_t half = resampler.bank->taps / 2;
+    std::fill(resampler.history.begin(), resampler.history.end(), 0.0f);
+    resampler.buffered_frames = half - 1;
+    resampler.position = static_cast<double>(half - 1);
+}
+
+void SetResamplerRatioAdjustment(Resampler& resampler, double ratio_adjustment) {
+    resampler.step = static_cast<double>(resampler.input_rate) / resampler.output_rate * ratio_adjustment;
+}
+
+uint32_t GetResamplerFlushFrames(const Resampler& resampler) {
+    return resampler.bank->taps / 2;
+}
+
+void ProcessResampler(Resampler& resampler, const float* input, uint64_t* input_frames, float* output, uint64_t* output_frames) {
+    const ResamplerFilterBank& bank = *resampler.bank;
+    const size_t taps = bank.taps;
+    const size_t half = taps / 2;
+    const size_t channels = resampler.channels;
+    const size_t capacity = resampler.capacity_frames;
+    float* scratch = resampler.coefficient_scratch.data();
+
+    uint64_t consumed = 0;
+    uint64_t produced = 0;
+    while (produced < *output_frames) {
+        size_t integer_position = static_cast<size_t>(resampler.position);
+        if (integer_position + half >= resampler.buffered_frames) {
+            if (consumed == *input_frames) {
+                break;
+            }
+            // Drop history the filter no longer needs, then append deinterleaved input.
+            size_t first_needed = integer_position + 1 - half;
+            size_t discard = std::min(first_needed, resampler.buffered_frames);
+            if (discard > 0) {
+                size_t keep = resampler.buffered_frames - discard;
+                for (size_t c = 0; c < channels; ++c) {
+                    float* channel = &resampler.history[c * capacity];
+                    std::memmove(channel, channel + discard, keep * sizeof(float));
+                }
+                resampler.buffered_frames = keep;
+                resampler.position -= static_cast<double>(discard);
+            }
+            size_t count = static_cast<size_t>(std::min<uint64_t>(capacity - resampler.buffered_frames, *input_frames - consumed));
+            const float* source = input + consumed * channels;
+            for (size_t c = 0; c < channels; ++c) {
+                float* channel = &resampler.history[c * capacity + resampler.buffered_frames];
+                for (size_t i = 0; i < count; ++i) {
+                    channel[i] = source[i * channels + c];
+                }
+            }
+            resampler.buffered_frames += count;
+            consumed += count;
+            continue;
+        }
+
+        const double fraction = resampler.position - static_cast<double>(integer_position);
+        const double phase_position = fraction * bank.phases;
+        const size_t phase = static_cast<size_t>(phase_position);
+        const float* row = &bank.coefficients[phase * taps];
+        DspLerp(row, row + taps, static_cast<float>(phase_position - static_cast<double>(phase)), scratch, taps);
+
+        const size_t start = integer_position + 1 - half;
+        float* frame_out = output + produced * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            frame_out[c] = DspDotProduct(&resampler.history[c * capacity + start], scratch, taps);
+        }
+        ++produced;
+        resampler.position += resampler.step;
+    }
+    *input_frames = consumed;
+    *output_frames = produced;
+}
+
+// --- Data Source ---
+namespace {
+
+ma_result ResamplingSourceRead(ma_data_source* data_source, void* frames_out, ma_uint64 frame_count, ma_uint64* frames_read) {
+    auto* source = static_cast<ResamplingDataSource*>(data_source);
+    const uint32_t channels = source->resampler.channels;
+    auto* output = static_cast<float*>(frames_out);
+    ma_uint64 produced = 0;
+    ma_result inner_result = MA_SUCCESS;
+
+    while (produced < frame_count) {
+        if (source->input_block_offset == source->input_block_frames && !source->inner_at_end) {
+            ma_uint64 read = 0;
+            inner_result = ma_data_source_read_pcm_frames(source->inner, source->input_block.data(), kResamplingSourceBlockFrames, &read);
+            source->input_block_frames = read;
+            source->input_block_offset = 0;
+            if (read == 0) {
+                if (inner_result == MA_BUSY) {
+                    break; // Streaming decoder has not caught up; ma_sound outputs silence
+                }
+                source->inner_at_end = true;
+                source->flush_frames_remaining = GetResamplerFlushFrames(source->resampler);
+            }
+        }
+
+        uint64_t input_frames = 0;
+        const float* input = nullptr;
+        bool flushing = false;
+        if (source->input_block_offset < source->input_block_frames) {
+            input = source->input_block.data() + source->input_block_offset * channels;
+            input_frames = source->input_block_frames - source->input_block_offset;
+        } else if (source->flush_frames_remaining > 0) {
+            std::fill(source->input_block.begin(), source->input_block.end(), 0.0f);
+            input = source->input_block.data();
+            input_frames = std::min<uint64_t>(source->flush_frames_remaining, kResamplingSourceBlockFrames);
+            flushing = true;
+        } else {
+            break;
+        }
+
+        uint64_t output_frames = frame_count - produced;
+        ProcessResampler(source->resampler, input, &input_frames, output + produced * channels, &output_frames);
+        if (flushing) {
+            source->flush_frames_remaining -= static_cast<uint32_t>(input_frames);
+        } else {
+            source->input_block_offset += input_frames;
+        }
+        produced += output_frames;
+        if (input_frames == 0 && output_frames == 0) {
+            break;
+        }
+    }
+
+    *frames_read = produced;
+    source->output_cursor += produced;
+    if (produced == 0) {
+        return source->inner_at_end ? MA_AT_END : inner_result;
+    }
+    return MA_SUCCESS;
+}
+
+ma_result ResamplingSourceSeek(ma_data_source* data_source, ma_uint64 frame_index) {
+    auto* source = static_cast<ResamplingDataSource*>(data_source);
+    const Resampler& resampler = source->resampler;
+    ma_uint64 inner_frame = frame_index * resampler.input_rate / resampler.output_rate;
+    ma_result result = ma_data_source_seek_to_pcm_frame(source->inner, inner_frame);
+    if (result != MA_SUCCESS) {
+        return result;
+    }
+    ResetResampler(source->resampler);
+    source->input_block_frames = 0;
+    source->input_block_offset = 0;
+    source->inner_at_end = false;
+    source->flush_frames_remaining = 0;
+    source->output_cursor = frame_index;
+    return MA_SUCCESS;
+}
+
+ma_result ResamplingSourceGetDataFormat(ma_data_source* data_source, ma_format* format, ma_uint32* channels, ma_uint32* sample_rate,
+                                        ma_channel* channel_map, size_t channel_map_cap) {
+    auto* source = static_cast<ResamplingDataSource*>(data_source);
+    ma_result result = ma_data_source_get_data_format(source->inner, format, channels, nullptr, channel_map, channel_map_cap);
+    if (sample_rate) {
+        *sample_rate = source->resampler.output_rate;
+    }
+    return result;
+}
+
+ma_result ResamplingSourceGetCursor(ma_data_source* data_source, ma_uint64* cursor) {
+    *cursor = static_cast<ResamplingDataSource*>(data_source)->output_cursor;
+    return MA_SUCCESS;
+}
+
+ma_result ResamplingSourceGetLength(ma_data_source* data_source, ma_uint64* length) {
+    auto* source = static_cast<ResamplingDataSource*>(data_source);
+    ma_uint64 inner_length = 0;
+    ma_result result = ma_data_source_get_length_in_pcm_frames(source->inner, &inner_length);
+    if (result != MA_SUCCESS) {
+        return result;
+    }
+    *length = inner_length * source->resampler.output_rate / source->resampler.input_rate;
+    return MA_SUCCESS;
+}
+
+ma_data_source_vtable g_resampling_source_vtable = {
+    ResamplingSourceRead,
+    ResamplingSourceSeek,
+    ResamplingSourceGetDataFormat,
+    ResamplingSourceGetCursor,
+    ResamplingSourceGetLength,
+    nullptr,
+    0
+};
+
+} // namespace
+
+ma_result InitializeResamplingDataSource(ma_data_source* inner, ResamplerQuality quality, ma_uint32 output_rate,
+                                         ResamplingDataSource* source) {
+    ma_format format = ma_format_unknown;
+    ma_uint32 channels = 0;
+    ma_uint32 input_rate = 0;
+    ma_result result = ma_data_source_get_data_format(inner, &format, &channels, &input_rate, nullptr, 0);
+    if (result != MA_SUCCESS) {
+        return result;
+    }
+    if (format != ma_format_f32) {
+        spdlog::error("Resampling data source needs f32 input.");
+        return MA_INVALID_ARGS;
+    }
+    if (!InitializeResampler(source->resampler, quality, channels, input_rate, output_rate)) {
+        return MA_INVALID_ARGS;
+    }
+    source->inner = inner;
+    source->input_block.assign(kResamplingSourceBlockFrames * channels, 0.0f);
+    source->input_block_frames = 0;
+    source->input_block_offset = 0;
+    source->inner_at_end = false;
+    source->flush_frames_remaining = 0;
+    source->output_cursor = 0;
+
+    ma_data_source_config config = ma_data_source_config_init();
+    config.vtable = &g_resampling_source_vtable;
+    return ma_data_source_init(&config, &source->base);
+}
+
+void UninitializeResamplingDataSource(ResamplingDataSource* source) {
+    ma_data_source_uninit(&source->base);
+    source->inner = nullptr;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Polyphase windowed-sinc sample-rate converter. Filter banks are precomputed per quality and
+// conversion ratio; between table phases the coefficients are linearly interpolated, so the
+// ratio can be any real number (and can be nudged at runtime for clock-drift correction).
+
+enum class ResamplerQuality {
+    Builtin, // miniaudio's linear resampler inside ma_sound
+    Low,
+    Medium,
+    High,
+};
+
+constexpr ResamplerQuality kResamplerQualities[] = {ResamplerQuality::Builtin, ResamplerQuality::Low, ResamplerQuality::Medium,
+                                                   ResamplerQuality::High};
+
+const char* GetResamplerQualityName(ResamplerQuality quality);
+
+struct ResamplerFilterBank {
+    uint32_t taps = 0;
+    uint32_t phases = 0;
+    std::vector<float> coefficients; // (phases + 1) rows of `taps`; row p is for fractional offset p / phases
+};
+
+// Shared, cached bank for a quality and ratio. Never returns null for non-Builtin qualities.
+std::shared_ptr<const ResamplerFilterBank> GetResamplerFilterBank(ResamplerQuality quality, uint32_t input_rate, uint32_t output_rate);
+
+struct Resampler {
+    std::shared_ptr<const ResamplerFilterBank> bank;
+    uint32_t channels = 0;
+    uint32_t input_rate = 0;
+    uint32_t output_rate = 0;
+    double step = 1.0;              // Input frames advanced per output frame
+    double position = 0.0;          // Read position in the history, in input frames
+    size_t buffered_frames = 0;     // Valid frames in each channel's history
+    size_t capacity_frames = 0;
+    std::vector<float> history;     // Planar, `capacity_frames` per channel
+    std::vector<float> coefficient_scratch;
+};
+
+bool InitializeResampler(Resampler& resampler, ResamplerQuality quality, uint32_t channels, uint32_t input_rate, uint32_t output_rate);
+void ResetResampler(Resampler& resampler);
+// Scales the nominal ratio by `ratio_adjustment` (e.g. 1.0001 to consume input 0.01% faster).
+void SetResamplerRatioAdjustment(Resampler& resampler, double ratio_adjustment);
+// Consumes up to *input_frames interleaved frames and writes up to *output_frames. Both counts are
+// updated to what was actually consumed and produced. Never allocates.
+void ProcessResampler(Resampler& resampler, const float* input, uint64_t* input_frames, float* output, uint64_t* output_frames);
+// Half the filter length: zero frames to feed after the last input to flush the tail.
+uint32_t GetResamplerFlushFrames(const Resampler& resampler);
+
+// --- Data Source ---
+// Wraps an f32 data source and presents it at `output_rate`, so ma_sound does no resampling of its own.
+struct ResamplingDataSource {
+    ma_data_source_base base; // Must be first
+    ma_data_source* inner = nullptr;
+    Resampler resampler;
+    std::vector<float> input_block;
+    ma_uint64 input_block_frames = 0;
+    ma_uint64 input_block_offset = 0;
+    bool inner_at_end = false;
+    uint32_t flush_frames_remaining = 0;
+    ma_uint64 output_cursor = 0;
+};
+
+ma_result InitializeResamplingDataSource(ma_data_source* inner, ResamplerQuality quality, ma_uint32 output_rate,
+                                         ResamplingDataSource* source);
+void UninitializeResamplingDataSource(ResamplingDataSource* source);
@@ -0,0 +1,100 @@
+#include "resource_jobs.h"
+
+#include "trace.h"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+constexpr uint32_t kReservedCores = 2;     // UI and audio threads
+constexpr uint32_t kMaxAutoJobThreads = 8; // Past this, extra threads only contend for storage
+
+// Mirrors miniaudio's own job thread, with timing.
+void ResourceJobThread(ResourceJobPool* pool) {
+    SetTraceThreadName("Resource Jobs");
+    for (;;) {
+        ma_job job;
+        ma_result result = ma_resource_manager_next_job(pool->resource_manager, &job);
+        if (result != MA_SUCCESS || job.toc.breakup.code == MA_JOB_TYPE_QUIT) {
+            break;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        {
+            TRACE_SCOPE("ResourceJob");
+            ma_job_process(&job);
+        }
+        pool->busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+                                std::memory_order_relaxed);
+        pool->jobs_processed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AddResourceJobThreads(ResourceJobPool& pool, uint32_t count) {
+    for (uint32_t i = 0; i < count && pool.threads.size() < pool.max_threads; ++i) {
+        pool.threads.emplace_back(ResourceJobThread, &pool);
+    }
+}
+
+} // namespace
+
+void ResolveResourceJobConfig(ResourceJobConfig& config, unsigned hardware_threads) {
+    if (config.max_threads == 0) {
+        const uint32_t spare = hardware_threads > kReservedCores ? hardware_threads - kReservedCores : 1;
+        config.max_threads = std::min(spare, kMaxAutoJobThreads);
+    }
+    if (config.initial_threads == 0) {
+        config.initial_threads = config.expected_streams + 1; // One stream page and one file load at a time
+    }
+    config.initial_threads = std::min(config.initial_threads, config.max_threads);
+}
+
+void ConfigureResourceManagerJobs(ma_resource_manager_config& manager_config, const ResourceJobConfig& config) {
+    manager_config.jobThreadCount = 0; // The pool pulls jobs with ma_resource_manager_next_job
+    if (config.job_queue_capacity > 0) {
+        manager_config.jobQueueCapacity = config.job_queue_capacity;
+    }
+}
+
+void StartResourceJobPool(ResourceJobPool& pool, ma_resource_manager* resource_manager, const ResourceJobConfig& config) {
+    pool.resource_manager = resource_manager;
+    pool.max_threads = std::max<uint32_t>(config.max_threads, 1);
+    pool.queue_capacity = resource_manager->jobQueue.capacity;
+    AddResourceJobThreads(pool, std::max<uint32_t>(config.initial_threads, 1));
+    spdlog::info("Resource manager: {} job threads (up to {}), queue of {} jobs, {:.2f} s decoded ahead per stream.", pool.threads.size(),
+                 pool.max_threads, pool.queue_capacity, kStreamDecodeAheadSeconds);
+}
+
+void GrowResourceJobPool(ResourceJobPool& pool, uint32_t active_streams) {
+    const size_t wanted = std::min<size_t>(active_streams + 1, pool.max_threads);
+    if (pool.resource_manager == nullptr || pool.threads.size() >= wanted) {
+        return;
+    }
+    AddResourceJobThreads(pool, static_cast<uint32_t>(wanted - pool.threads.size()));
+    spdlog::info("Resource manager: {} streams open, now {} job threads.", active_streams, pool.threads.size());
+}
+
+void StopResourceJobPool(ResourceJobPool& pool) {
+    if (pool.resource_manager == nullptr) {
+        return;
+    }
+    // The quit job stays at the head of the queue, so one post stops every thread.
+    ma_resource_manager_post_job_quit(pool.resource_manager);
+    for (auto& thread : pool.threads) {
+        thread.join();
+    }
+    pool.threads.clear();
+    pool.resource_manager = nullptr;
+}
+
+void SampleJobQueue(ResourceJobPool& pool) {
+    if (pool.resource_manager == nullptr) {
+        return;
+    }
+    // Slots held by queued jobs; miniaudio updates the count atomically.
+    pool.queue_depth = std::atomic_ref<ma_uint32>(pool.resource_manager->jobQueue.allocator.count).load(std::memory_order_relaxed);
+    pool.peak_queue_depth = std::max(pool.peak_queue_depth, pool.queue_depth);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Job threads for the resource manager, run by the player instead of miniaudio so their number can
+// follow demand. They decode stream pages and load files. The pool starts with enough threads for
+// the expected streams and adds one whenever the open streams outgrow it, up to a budget that
+// leaves the UI and audio threads their own cores. Threads only go away at shutdown.
+//
+// Each streamed track keeps one page decoded ahead of the one playing; the page length
+// (AUDIOPLAYER_STREAM_PAGE_MS in CMake) is therefore the decode-ahead depth.
+
+#ifndef MA_RESOURCE_MANAGER_PAGE_SIZE_IN_MILLISECONDS
+#define MA_RESOURCE_MANAGER_PAGE_SIZE_IN_MILLISECONDS 1000 // miniaudio's default
+#endif
+
+constexpr double kStreamDecodeAheadSeconds = MA_RESOURCE_MANAGER_PAGE_SIZE_IN_MILLISECONDS / 1000.0;
+
+struct ResourceJobConfig {
+    uint32_t initial_threads = 0;    // 0 = enough for expected_streams
+    uint32_t max_threads = 0;        // 0 = the cores not needed by the UI and audio threads
+    uint32_t job_queue_capacity = 0; // 0 = miniaudio's default
+    uint32_t expected_streams = 1;   // The main player
+};
+
+struct ResourceJobPool {
+    ma_resource_manager* resource_manager = nullptr;
+    std::vector<std::thread> threads;
+    uint32_t max_threads = 1;
+
+    // Written by the job threads.
+    std::atomic<uint64_t> jobs_processed{0};
+    std::atomic<uint64_t> busy_ns{0};
+
+    // Queue occupancy, sampled by SampleJobQueue on the UI thread.
+    uint32_t queue_capacity = 0;
+    uint32_t queue_depth = 0;
+    uint32_t peak_queue_depth = 0;
+};
+
+// Fills the thread counts left at 0 from the core count.
+void ResolveResourceJobConfig(ResourceJobConfig& config, unsigned hardware_threads);
+// Hands job processing to the pool: call on the config before ma_resource_manager_init.
+void ConfigureResourceManagerJobs(ma_resource_manager_config& manager_config, const ResourceJobConfig& config);
+
+void StartResourceJobPool(ResourceJobPool& pool, ma_resource_manager* resource_manager, const ResourceJobConfig& config);
+// Adds threads while `active_streams` + 1 exceeds the pool, within max_threads.
+void GrowResourceJobPool(ResourceJobPool& pool, uint32_t active_streams);
+// Call before ma_resource_manager_uninit.
+void StopResourceJobPool(ResourceJobPool& pool);
+
+void SampleJobQueue(ResourceJobPool& pool);
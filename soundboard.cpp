@@ -0,0 +1,280 @@
+#include "soundboard.h"
+
+#include "resampler.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr double kCueMaxSeconds = 60.0; // Pads are meant to be short; longer files are truncated
+constexpr ma_uint32 kCueVoiceFlags = MA_SOUND_FLAG_NO_PITCH | MA_SOUND_FLAG_NO_SPATIALIZATION;
+
+int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool IsVoiceBusy(const CueVoice& voice) {
+    return voice.pending_pad.load(std::memory_order_relaxed) != nullptr || ma_sound_is_playing(&voice.sound);
+}
+
+// Cancels a pending restart and stops the voice. Safe while the audio thread is rendering it.
+void StopVoice(CueVoice& voice) {
+    voice.pending_pad.store(nullptr, std::memory_order_relaxed);
+    ma_sound_stop(&voice.sound);
+}
+
+void RecordLatency(CueLatencyStats& stats, float latency_ms) {
+    const uint32_t count = stats.count.load(std::memory_order_relaxed);
+    stats.last_ms.store(latency_ms, std::memory_order_relaxed);
+    if (count == 0) {
+        stats.min_ms.store(latency_ms, std::memory_order_relaxed);
+        stats.max_ms.store(latency_ms, std::memory_order_relaxed);
+        stats.average_ms.store(latency_ms, std::memory_order_relaxed);
+    } else {
+        stats.min_ms.store(std::min(stats.min_ms.load(std::memory_order_relaxed), latency_ms), std::memory_order_relaxed);
+        stats.max_ms.store(std::max(stats.max_ms.load(std::memory_order_relaxed), latency_ms), std::memory_order_relaxed);
+        // Running mean for the first triggers, then an exponential average over roughly the last 64.
+        const float weight = 1.0f / static_cast<float>(std::min<uint32_t>(count + 1, 64));
+        const float average = stats.average_ms.load(std::memory_order_relaxed);
+        stats.average_ms.store(average + (latency_ms - average) * weight, std::memory_order_relaxed);
+    }
+    stats.count.store(count + 1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+bool InitializeSoundboard(Soundboard& board, ma_engine* engine, ma_node* output) {
+    board.engine = engine;
+    board.initialized = true; // From here on UninitializeSoundboard releases whatever was created
+    for (; board.bus_count < kCueBusCount; ++board.bus_count) {
+        ma_sound_group& bus = board.buses[board.bus_count];
+        ma_result result = ma_sound_group_init(engine, 0, nullptr, &bus);
+        if (result != MA_SUCCESS) {
+            spdlog::error("Failed to initialize cue bus {}: {}", kCueBusNames[board.bus_count], ma_result_description(result));
+            UninitializeSoundboard(board);
+            return false;
+        }
+        ma_node_attach_output_bus(&bus, 0, output, 0);
+        ma_sound_group_set_volume(&bus, board.bus_levels[board.bus_count]);
+    }
+
+    const ma_uint32 channels = ma_engine_get_channels(engine);
+    board.voices = std::make_unique<CueVoice[]>(kCueVoiceCount);
+    for (; board.voice_count < kCueVoiceCount; ++board.voice_count) {
+        CueVoice& voice = board.voices[board.voice_count];
+        ma_result result = ma_audio_buffer_ref_init(ma_format_f32, channels, nullptr, 0, &voice.buffer);
+        if (result == MA_SUCCESS) {
+            // Pads are decoded at the engine rate, so the voices never resample.
+            voice.buffer.sampleRate = ma_engine_get_sample_rate(engine);
+            result = ma_sound_init_from_data_source(engine, &voice.buffer, kCueVoiceFlags, &board.buses[0], &voice.sound);
+            if (result != MA_SUCCESS) {
+                ma_audio_buffer_ref_uninit(&voice.buffer);
+            }
+        }
+        if (result != MA_SUCCESS) {
+            spdlog::error("Failed to initialize cue voice {}: {}", board.voice_count, ma_result_description(result));
+            UninitializeSoundboard(board);
+            return false;
+        }
+    }
+    board.active.store(true, std::memory_order_release);
+    spdlog::info("Soundboard ready: {} voices on {} buses.", kCueVoiceCount, kCueBusCount);
+    return true;
+}
+
+void UninitializeSoundboard(Soundboard& board) {
+    if (!board.initialized) {
+        return;
+    }
+    board.active.store(false, std::memory_order_release);
+    for (int i = 0; i < board.voice_count; ++i) {
+        ma_sound_uninit(&board.voices[i].sound);
+        ma_audio_buffer_ref_uninit(&board.voices[i].buffer);
+    }
+    for (int i = 0; i < board.bus_count; ++i) {
+        ma_sound_group_uninit(&board.buses[i]);
+    }
+    board.voices.reset();
+    board.voice_count = 0;
+    board.bus_count = 0;
+    board.pads.clear();
+    board.retired_pads.clear();
+    board.initialized = false;
+}
+
+bool DecodeCuePad(const std::string& path, ma_uint32 channels, ma_uint32 sample_rate, CuePad& pad_out) {
+    TRACE_SCOPE("DecodeCuePad");
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, channels, 0); // Native rate; resampled below
+    ma_decoder decoder;
+    ma_result result = ma_decoder_init_file(path.c_str(), &config, &decoder);
+    if (result != MA_SUCCESS) {
+        spdlog::warn("Cue pad '{}' could not be opened: {}", path, ma_result_description(result));
+        return false;
+    }
+    const ma_uint32 native_rate = decoder.outputSampleRate;
+    const ma_uint64 max_frames = static_cast<ma_uint64>(kCueMaxSeconds * native_rate);
+    std::vector<float> decoded;
+    ma_uint64 length = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) == MA_SUCCESS && length > 0) {
+        decoded.reserve(static_cast<size_t>(std::min(length, max_frames) * channels));
+    }
+    constexpr ma_uint64 kChunkFrames = 4096;
+    std::vector<float> chunk(kChunkFrames * channels);
+    ma_uint64 total_frames = 0;
+    while (total_frames < max_frames) {
+        ma_uint64 frames_read = 0;
+        result = ma_decoder_read_pcm_frames(&decoder, chunk.data(), std::min(kChunkFrames, max_frames - total_frames), &frames_read);
+        decoded.insert(decoded.end(), chunk.begin(), chunk.begin() + frames_read * channels);
+        total_frames += frames_read;
+        if (result != MA_SUCCESS || frames_read == 0) {
+            break;
+        }
+    }
+    ma_decoder_uninit(&decoder);
+    if (total_frames == 0) {
+        spdlog::warn("Cue pad '{}' is empty.", path);
+        return false;
+    }
+    if (total_frames == max_frames) {
+        spdlog::warn("Cue pad '{}' is longer than {:.0f} s and was truncated.", path, kCueMaxSeconds);
+    }
+
+    pad_out.path = path;
+    pad_out.name = std::filesystem::path(path).stem().string();
+    if (native_rate == sample_rate) {
+        pad_out.samples = std::move(decoded);
+    } else {
+        // Load-time conversion, so the best quality costs nothing when the pad fires.
+        Resampler resampler;
+        if (!InitializeResampler(resampler, ResamplerQuality::High, channels, native_rate, sample_rate)) {
+            return false;
+        }
+        // Feed half a filter of silence so the tail is flushed; output frame 0 lines up with input frame 0.
+        const uint64_t source_frames = decoded.size() / channels;
+        decoded.resize(decoded.size() + static_cast<size_t>(GetResamplerFlushFrames(resampler)) * channels, 0.0f);
+        const uint64_t target_frames = source_frames * sample_rate / native_rate;
+        pad_out.samples.assign(static_cast<size_t>(target_frames) * channels, 0.0f);
+        uint64_t input_frames = decoded.size() / channels;
+        uint64_t output_frames = target_frames;
+        ProcessResampler(resampler, decoded.data(), &input_frames, pad_out.samples.data(), &output_frames);
+        pad_out.samples.resize(static_cast<size_t>(output_frames) * channels);
+    }
+    pad_out.frame_count = pad_out.samples.size() / channels;
+    return pad_out.frame_count > 0;
+}
+
+void ReplaceCuePads(Soundboard& board, std::vector<CuePad> pads) {
+    StopAllCueVoices(board);
+    for (int i = 0; i < board.voice_count; ++i) {
+        board.voices[i].pad = -1;
+    }
+    board.retired_pads = std::move(board.pads);
+    board.pads = std::move(pads);
+}
+
+int TriggerCuePad(Soundboard& board, int pad_index) {
+    if (!board.active.load(std::memory_order_relaxed) || pad_index < 0 || pad_index >= static_cast<int>(board.pads.size())) {
+        return -1;
+    }
+    const CuePad& pad = board.pads[pad_index];
+    if (pad.frame_count == 0) {
+        return -1;
+    }
+    const int64_t trigger_time_ns = NowNanoseconds();
+
+    // Choke first, so a voice freed by the choke is not also the one stolen.
+    int free_voice = -1;
+    int oldest_voice = 0;
+    for (int i = 0; i < board.voice_count; ++i) {
+        CueVoice& voice = board.voices[i];
+        const bool busy = IsVoiceBusy(voice);
+        if (busy && pad.choke_group != 0 && voice.pad >= 0 && board.pads[voice.pad].choke_group == pad.choke_group) {
+            StopVoice(voice);
+        } else if (!busy) {
+            if (free_voice < 0) {
+                free_voice = i;
+            }
+            continue;
+        }
+        if (voice.trigger_serial < board.voices[oldest_voice].trigger_serial) {
+            oldest_voice = i;
+        }
+    }
+
+    const bool steal = free_voice < 0;
+    const int voice_index = steal ? oldest_voice : free_voice;
+    CueVoice& voice = board.voices[voice_index];
+    if (steal) {
+        StopVoice(voice);
+        ++board.voices_stolen;
+    }
+    voice.pad = pad_index;
+    voice.trigger_serial = board.next_trigger_serial++;
+    if (voice.bus != pad.bus) {
+        ma_node_attach_output_bus(&voice.sound, 0, &board.buses[pad.bus], 0);
+        voice.bus = pad.bus;
+    }
+    ma_sound_set_volume(&voice.sound, pad.gain);
+
+    // Stolen, choked or just stopped, the graph may be mid-read of the old buffer; the audio thread
+    // swaps it after this period.
+    voice.pending_pad.store(&pad, std::memory_order_release);
+    // Published last, so the audio thread never measures against the previous buffer's cursor.
+    voice.trigger_time_ns.store(trigger_time_ns, std::memory_order_release);
+    return voice_index;
+}
+
+void StopAllCueVoices(Soundboard& board) {
+    for (int i = 0; i < board.voice_count; ++i) {
+        StopVoice(board.voices[i]);
+        board.voices[i].trigger_time_ns.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SetCueBusLevel(Soundboard& board, int bus, float level) {
+    if (bus < 0 || bus >= kCueBusCount) {
+        return;
+    }
+    board.bus_levels[bus] = level;
+    if (board.initialized) {
+        ma_sound_group_set_volume(&board.buses[bus], level);
+    }
+}
+
+int CountActiveCueVoices(const Soundboard& board) {
+    int active = 0;
+    for (int i = 0; i < board.voice_count; ++i) {
+        active += IsVoiceBusy(board.voices[i]) ? 1 : 0;
+    }
+    return active;
+}
+
+void ProcessSoundboardAudio(Soundboard& board) {
+    if (!board.active.load(std::memory_order_acquire)) {
+        return;
+    }
+    const int64_t now_ns = NowNanoseconds();
+    for (int i = 0; i < board.voice_count; ++i) {
+        CueVoice& voice = board.voices[i];
+        if (const CuePad* pad = voice.pending_pad.exchange(nullptr, std::memory_order_acquire)) {
+            // Between periods the graph is idle, so swapping the voice's buffer is safe here.
+            ma_audio_buffer_ref_set_data(&voice.buffer, pad->samples.data(), pad->frame_count);
+            ma_sound_seek_to_pcm_frame(&voice.sound, 0);
+            ma_sound_start(&voice.sound);
+            continue;
+        }
+        int64_t trigger_time_ns = voice.trigger_time_ns.load(std::memory_order_acquire);
+        if (trigger_time_ns == 0) {
+            continue;
+        }
+        ma_uint64 cursor = 0;
+        if (ma_sound_get_cursor_in_pcm_frames(&voice.sound, &cursor) == MA_SUCCESS && cursor > 0 &&
+            voice.trigger_time_ns.compare_exchange_strong(trigger_time_ns, 0, std::memory_order_relaxed)) {
+            RecordLatency(board.latency, static_cast<float>(now_ns - trigger_time_ns) / 1e6f);
+        }
+    }
+}
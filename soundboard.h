@@ -0,0 +1,92 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Cue pads for live use. Every pad is decoded up front into memory at the engine's format, and a
+// fixed pool of voices (ma_sound over an ma_audio_buffer_ref) is created once. Triggering a pad only
+// re-points an idle voice's buffer and starts it: no allocation, no decoding, no file access.
+// When every voice is busy the oldest is stolen; its buffer is swapped on the audio thread at the
+// next period boundary, since the graph may be reading it at the moment of the trigger.
+
+constexpr int kCueVoiceCount = 64;
+constexpr int kCueBusCount = 4;    // Pads route to one of these groups, each with its own level
+constexpr int kCueChokeGroups = 8; // Choke group 0 means "none"
+constexpr const char* kCueBusNames[kCueBusCount] = {"A", "B", "C", "D"};
+
+struct CuePad {
+    std::string path;
+    std::string name;
+    std::vector<float> samples; // Interleaved f32 at the engine's channels and rate
+    ma_uint64 frame_count = 0;
+    int bus = 0;
+    int choke_group = 0; // Triggering a pad stops every voice playing a pad in the same group
+    float gain = 1.0f;
+};
+
+struct CueVoice {
+    ma_audio_buffer_ref buffer{};
+    ma_sound sound{};
+    int pad = -1;
+    int bus = 0;
+    uint64_t trigger_serial = 0; // Oldest voice is stolen first
+    // Pad waiting for the audio thread to swap in and restart. Only the audio thread re-points the
+    // buffer: a voice that looks stopped may still be mid-read in the current period.
+    std::atomic<const CuePad*> pending_pad{nullptr};
+    // Set by the trigger, cleared by the audio thread once the voice has been rendered.
+    std::atomic<int64_t> trigger_time_ns{0};
+};
+
+// Trigger-to-output latency. Render latency is measured on the audio thread: trigger to the end of
+// the first period that contains the voice. The device buffer is added on top for the output estimate.
+struct CueLatencyStats {
+    std::atomic<float> last_ms{0.0f};
+    std::atomic<float> min_ms{0.0f};
+    std::atomic<float> max_ms{0.0f};
+    std::atomic<float> average_ms{0.0f};
+    std::atomic<uint32_t> count{0};
+};
+
+struct Soundboard {
+    ma_engine* engine = nullptr;
+    std::array<ma_sound_group, kCueBusCount> buses{};
+    std::array<float, kCueBusCount> bus_levels{1.0f, 1.0f, 1.0f, 1.0f};
+    std::unique_ptr<CueVoice[]> voices; // Fixed addresses: the node graph points into them
+    int voice_count = 0;
+    int bus_count = 0;
+    bool initialized = false;
+    std::atomic<bool> active{false}; // Audio-thread gate: set once the pool is complete
+
+    std::vector<CuePad> pads;
+    // The previous pad set, kept until the next reload in case the audio thread was still reading it
+    // when the voices were stopped.
+    std::vector<CuePad> retired_pads;
+
+    uint64_t next_trigger_serial = 1;
+    uint32_t voices_stolen = 0;
+    CueLatencyStats latency;
+};
+
+// Creates the buses (attached to `output`) and the voice pool. `output` is usually the master bus.
+bool InitializeSoundboard(Soundboard& board, ma_engine* engine, ma_node* output);
+void UninitializeSoundboard(Soundboard& board);
+
+// Worker thread: decodes one pad file into memory at the given format. False if it cannot be read.
+bool DecodeCuePad(const std::string& path, ma_uint32 channels, ma_uint32 sample_rate, CuePad& pad_out);
+// Main thread: stops every voice and swaps in a new pad set.
+void ReplaceCuePads(Soundboard& board, std::vector<CuePad> pads);
+
+// Main thread. Returns the voice index used, or -1 if the pad is empty. Allocation-free.
+int TriggerCuePad(Soundboard& board, int pad_index);
+void StopAllCueVoices(Soundboard& board);
+void SetCueBusLevel(Soundboard& board, int bus, float level);
+int CountActiveCueVoices(const Soundboard& board);
+
+// Audio thread, after each engine period: restarts stolen voices and records the latency of voices
+// rendered for the first time.
+void ProcessSoundboardAudio(Soundboard& board);
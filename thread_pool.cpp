@@ -0,0 +1,54 @@
+#include "thread_pool.h"
+
+#include "trace.h"
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this](std::stop_token stop_token) { WorkerLoop(stop_token); });
+    }
+    spdlog::info("Thread pool started with {} workers.", thread_count);
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto& worker : workers) {
+        worker.request_stop();
+    }
+    jobs_available.notify_all();
+    workers.clear(); // jthread joins on destruction
+}
+
+void ThreadPool::Enqueue(std::function<void()> job) {
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobs_available.notify_one();
+}
+
+void ThreadPool::WorkerLoop(std::stop_token stop_token) {
+    SetTraceThreadName("Pool Worker");
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mutex);
+            if (!jobs_available.wait(lock, stop_token, [this] { return !jobs.empty(); })) {
+                return; // Stop requested while idle
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        TRACE_SCOPE("ThreadPoolJob");
+        try {
+            job();
+        } catch (const std::exception& e) {
+            spdlog::error("Unhandled exception in thread pool job: {}", e.what());
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Shared worker pool for background jobs (analysis, fingerprinting, scans).
+// Jobs run in FIFO order; the destructor lets the workers finish every queued job before joining them.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Enqueue(std::function<void()> job);
+
+    template <typename F>
+    auto Submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> future = task->get_future();
+        Enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    unsigned GetThreadCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    void WorkerLoop(std::stop_token stop_token);
+
+    std::mutex mutex;
+    std::condition_variable_any jobs_available;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::jthread> workers;
+};
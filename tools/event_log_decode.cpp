@@ -0,0 +1,170 @@
+// Decodes a binary event log written with --event-log into text lines (default) or a JSON array.
+//
+//     EventLogDecode audioplayer_events.bin [--json]
+//
+// Standalone on purpose: it shares only event_log_format.h with the player, so it builds without
+// any of the player's dependencies.
+
+#include "event_log_format.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct DecodedLog {
+    uint32_t capacity = 0;
+    uint64_t next_sequence = 0;
+    std::vector<EventRecord> records; // Sorted by sequence
+    size_t torn = 0;
+};
+
+bool ReadEventLog(const char* path, DecodedLog& log) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "Cannot open '%s'.\n", path);
+        return false;
+    }
+    std::vector<char> header_bytes(kEventLogHeaderBytes);
+    if (!file.read(header_bytes.data(), header_bytes.size())) {
+        std::fprintf(stderr, "'%s' is too short to be an event log.\n", path);
+        return false;
+    }
+    // Read the fields individually: the header holds an atomic, so it is not copied as a whole.
+    const char* bytes = header_bytes.data();
+    uint32_t version = 0;
+    uint32_t record_bytes = 0;
+    std::memcpy(&version, bytes + offsetof(EventLogHeader, version), sizeof(version));
+    std::memcpy(&record_bytes, bytes + offsetof(EventLogHeader, record_bytes), sizeof(record_bytes));
+    std::memcpy(&log.capacity, bytes + offsetof(EventLogHeader, capacity), sizeof(log.capacity));
+    std::memcpy(&log.next_sequence, bytes + offsetof(EventLogHeader, next_sequence), sizeof(log.next_sequence));
+    if (std::memcmp(bytes, kEventLogMagic, sizeof(kEventLogMagic)) != 0 || version != kEventLogVersion || record_bytes != sizeof(EventRecord)) {
+        std::fprintf(stderr, "'%s' is not a version %u event log.\n", path, kEventLogVersion);
+        return false;
+    }
+
+    log.records.resize(log.capacity);
+    file.read(reinterpret_cast<char*>(log.records.data()), static_cast<std::streamsize>(log.records.size() * sizeof(EventRecord)));
+    log.records.resize(static_cast<size_t>(file.gcount()) / sizeof(EventRecord));
+    size_t kept = 0;
+    for (size_t slot = 0; slot < log.records.size(); ++slot) {
+        const EventRecord& record = log.records[slot];
+        if (record.sequence == 0) {
+            continue;
+        }
+        if ((record.sequence - 1) % log.capacity != slot) {
+            ++log.torn;
+            continue;
+        }
+        log.records[kept++] = record;
+    }
+    log.records.resize(kept);
+    std::sort(log.records.begin(), log.records.end(), [](const EventRecord& a, const EventRecord& b) { return a.sequence < b.sequence; });
+    return true;
+}
+
+std::string FormatTime(int64_t time_ns) {
+    const std::time_t seconds = static_cast<std::time_t>(time_ns / 1'000'000'000);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+    char result[48];
+    std::snprintf(result, sizeof(result), "%s.%06lld", stamp, static_cast<long long>(time_ns % 1'000'000'000 / 1000));
+    return result;
+}
+
+std::string_view GetRecordText(const EventRecord& record) {
+    return std::string_view(record.text, strnlen(record.text, kEventTextBytes));
+}
+
+std::string EscapeJson(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void PrintText(const DecodedLog& log) {
+    for (const EventRecord& record : log.records) {
+        const EventTypeInfo* info = GetEventTypeInfo(record.type);
+        std::printf("%8llu %s [t%u] %s", static_cast<unsigned long long>(record.sequence), FormatTime(record.time_ns).c_str(), record.thread,
+                    info ? info->name : "Unknown");
+        if (!info || info->int_label) {
+            std::printf(" %s=%lld", info ? info->int_label : "int", static_cast<long long>(record.value_int));
+        }
+        if (!info || info->value_label) {
+            std::printf(" %s=%.3f", info ? info->value_label : "value", record.value);
+        }
+        const std::string_view text = GetRecordText(record);
+        if (!text.empty()) {
+            std::printf(" \"%.*s\"", static_cast<int>(text.size()), text.data());
+        }
+        std::printf("\n");
+    }
+}
+
+void PrintJson(const DecodedLog& log) {
+    std::printf("[\n");
+    for (size_t i = 0; i < log.records.size(); ++i) {
+        const EventRecord& record = log.records[i];
+        const EventTypeInfo* info = GetEventTypeInfo(record.type);
+        std::printf("  {\"sequence\":%llu,\"time_ns\":%lld,\"thread\":%u,\"type\":\"%s\"", static_cast<unsigned long long>(record.sequence),
+                    static_cast<long long>(record.time_ns), record.thread, info ? info->name : "Unknown");
+        if (!info || info->int_label) {
+            std::printf(",\"%s\":%lld", info ? info->int_label : "int", static_cast<long long>(record.value_int));
+        }
+        if (!info || info->value_label) {
+            std::printf(",\"%s\":%.6g", info ? info->value_label : "value", record.value);
+        }
+        const std::string_view text = GetRecordText(record);
+        if (!text.empty()) {
+            std::printf(",\"text\":\"%s\"", EscapeJson(text).c_str());
+        }
+        std::printf("}%s\n", i + 1 < log.records.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s <event log> [--json]\n", argv[0]);
+        return 2;
+    }
+    DecodedLog log;
+    if (!ReadEventLog(path, log)) {
+        return 1;
+    }
+    if (json) {
+        PrintJson(log);
+    } else {
+        PrintText(log);
+    }
+    std::fprintf(stderr, "%zu events (of %llu logged, ring of %u), %zu torn by a crash mid-write.\n", log.records.size(),
+                 static_cast<unsigned long long>(log.next_sequence), log.capacity, log.torn);
+    return 0;
+}
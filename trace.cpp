@@ -0,0 +1,242 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+std::atomic<bool> g_trace_enabled{false};
+
+namespace {
+
+// Preallocated when tracing is first enabled. Buffers of exited threads are kept for export until a
+// new thread needs one; the oldest retired buffer is reused first.
+constexpr size_t kMaxTraceBuffers = 64;
+
+enum : uint8_t { kBufferFree, kBufferActive, kBufferRetired };
+
+struct ThreadTraceBuffer {
+    std::array<TraceEvent, kTraceEventsPerThread> events;
+    std::atomic<uint64_t> write_count{0}; // Total events written; slot = count % capacity
+    std::atomic<uint8_t> state{kBufferFree};
+    std::atomic<uint64_t> retired_order{0};
+    std::atomic<uint32_t> thread_id{0};
+    std::atomic<const char*> name{nullptr}; // String literal; null = "Thread <id>"
+};
+
+std::mutex g_pool_mutex; // Serializes the one-time allocation and the exporters
+std::unique_ptr<ThreadTraceBuffer[]> g_pool_storage;
+std::atomic<ThreadTraceBuffer*> g_pool{nullptr};
+std::atomic<uint32_t> g_next_thread_id{1};
+std::atomic<uint64_t> g_next_retired_order{1};
+std::atomic<uint64_t> g_dropped_events{0};
+std::atomic<uint64_t> g_next_flow_id{1};
+
+// Tick <-> wall-clock pair taken when tracing is enabled; a second pair at export gives the rate.
+std::atomic<uint64_t> g_calibration_ticks{0};
+std::atomic<int64_t> g_calibration_ns{0};
+
+int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct ThreadBufferHandle {
+    ThreadTraceBuffer* buffer = nullptr;
+    const char* pending_name = nullptr;
+    ~ThreadBufferHandle() {
+        if (buffer) {
+            buffer->retired_order.store(g_next_retired_order.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+            buffer->state.store(kBufferRetired, std::memory_order_release);
+        }
+    }
+};
+thread_local ThreadBufferHandle t_handle;
+
+// Runs on whatever thread records first, including the audio callbacks, so it only claims a
+// preallocated slot with a CAS. Null when the pool is missing or every slot belongs to a live thread.
+ThreadTraceBuffer* ClaimThreadBuffer() {
+    ThreadTraceBuffer* pool = g_pool.load(std::memory_order_acquire);
+    if (!pool) {
+        return nullptr;
+    }
+    ThreadTraceBuffer* buffer = nullptr;
+    for (size_t i = 0; i < kMaxTraceBuffers && !buffer; ++i) {
+        uint8_t expected = kBufferFree;
+        if (pool[i].state.compare_exchange_strong(expected, kBufferActive, std::memory_order_acquire)) {
+            buffer = &pool[i];
+        }
+    }
+    while (!buffer) {
+        ThreadTraceBuffer* oldest = nullptr;
+        for (size_t i = 0; i < kMaxTraceBuffers; ++i) {
+            if (pool[i].state.load(std::memory_order_relaxed) == kBufferRetired &&
+                (!oldest || pool[i].retired_order.load(std::memory_order_relaxed) < oldest->retired_order.load(std::memory_order_relaxed))) {
+                oldest = &pool[i];
+            }
+        }
+        if (!oldest) {
+            return nullptr;
+        }
+        uint8_t expected = kBufferRetired;
+        if (oldest->state.compare_exchange_strong(expected, kBufferActive, std::memory_order_acquire)) {
+            buffer = oldest; // Otherwise another thread took it first; look again
+        }
+    }
+    buffer->write_count.store(0, std::memory_order_relaxed);
+    buffer->thread_id.store(g_next_thread_id.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+    buffer->name.store(t_handle.pending_name, std::memory_order_relaxed);
+    t_handle.buffer = buffer;
+    return buffer;
+}
+
+void AppendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += *c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+void SetTracingEnabled(bool enabled) {
+    if (enabled && !g_pool.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(g_pool_mutex);
+        if (!g_pool_storage) {
+            // Default-initialized, so the event arrays are only paged in by the threads that write them.
+            g_pool_storage = std::make_unique_for_overwrite<ThreadTraceBuffer[]>(kMaxTraceBuffers);
+            g_pool.store(g_pool_storage.get(), std::memory_order_release);
+        }
+    }
+    if (enabled && !IsTracingEnabled()) {
+        g_calibration_ns.store(NowNanoseconds(), std::memory_order_relaxed);
+        g_calibration_ticks.store(ReadTraceTicks(), std::memory_order_relaxed);
+    }
+    g_trace_enabled.store(enabled, std::memory_order_relaxed);
+    spdlog::info("Tracing {}.", enabled ? "enabled" : "disabled");
+}
+
+void SetTraceThreadName(const char* name) {
+    if (t_handle.pending_name == name) {
+        return; // Cheap enough to call from a callback on every period
+    }
+    t_handle.pending_name = name;
+    if (t_handle.buffer) {
+        t_handle.buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+uint64_t NewTraceFlowId() {
+    return g_next_flow_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordTraceEvent(const char* name, char phase, uint64_t start_ticks, uint64_t duration_ticks, uint64_t flow_id) {
+    ThreadTraceBuffer* buffer = t_handle.buffer ? t_handle.buffer : ClaimThreadBuffer();
+    if (!buffer) {
+        g_dropped_events.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const uint64_t index = buffer->write_count.load(std::memory_order_relaxed);
+    buffer->events[index % kTraceEventsPerThread] = TraceEvent{name, start_ticks, duration_ticks, flow_id, phase};
+    buffer->write_count.store(index + 1, std::memory_order_release);
+}
+
+size_t CountTraceEvents() {
+    const ThreadTraceBuffer* pool = g_pool.load(std::memory_order_acquire);
+    size_t total = 0;
+    for (size_t i = 0; pool && i < kMaxTraceBuffers; ++i) {
+        total += static_cast<size_t>(std::min<uint64_t>(pool[i].write_count.load(std::memory_order_relaxed), kTraceEventsPerThread));
+    }
+    return total;
+}
+
+bool WriteChromeTrace(const std::filesystem::path& path) {
+    const uint64_t base_ticks = g_calibration_ticks.load(std::memory_order_relaxed);
+    const ThreadTraceBuffer* pool = g_pool.load(std::memory_order_acquire);
+    const int64_t elapsed_ns = NowNanoseconds() - g_calibration_ns.load(std::memory_order_relaxed);
+    const uint64_t elapsed_ticks = ReadTraceTicks() - base_ticks;
+    if (!pool || base_ticks == 0 || elapsed_ns <= 0 || elapsed_ticks == 0) {
+        spdlog::warn("No trace recorded yet.");
+        return false;
+    }
+    const double us_per_tick = static_cast<double>(elapsed_ns) / 1000.0 / static_cast<double>(elapsed_ticks);
+    auto to_us = [&](uint64_t ticks) { return static_cast<double>(static_cast<int64_t>(ticks - base_ticks)) * us_per_tick; };
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    size_t event_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_pool_mutex);
+        std::vector<TraceEvent> snapshot;
+        for (size_t b = 0; b < kMaxTraceBuffers; ++b) {
+            const ThreadTraceBuffer* buffer = &pool[b];
+            if (buffer->state.load(std::memory_order_acquire) == kBufferFree) {
+                continue;
+            }
+            // Copy, then drop anything the owning thread may have overwritten during the copy.
+            const uint64_t end = buffer->write_count.load(std::memory_order_acquire);
+            const uint64_t begin = end > kTraceEventsPerThread ? end - kTraceEventsPerThread : 0;
+            snapshot.clear();
+            for (uint64_t i = begin; i < end; ++i) {
+                snapshot.push_back(buffer->events[i % kTraceEventsPerThread]);
+            }
+            const uint64_t after = buffer->write_count.load(std::memory_order_acquire);
+            const uint64_t overwritten = after > kTraceEventsPerThread ? after - kTraceEventsPerThread : 0;
+            const size_t skip = static_cast<size_t>(std::min<uint64_t>(overwritten > begin ? overwritten - begin : 0, snapshot.size()));
+
+            const uint32_t thread_id = buffer->thread_id.load(std::memory_order_relaxed);
+            const char* thread_name = buffer->name.load(std::memory_order_relaxed);
+            json += fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":", thread_id);
+            AppendJsonString(json, thread_name ? thread_name : fmt::format("Thread {}", thread_id).c_str());
+            json += "}},\n";
+            for (size_t i = skip; i < snapshot.size(); ++i) {
+                const TraceEvent& event = snapshot[i];
+                if (event.start_ticks < base_ticks) {
+                    continue; // From before the current recording was enabled
+                }
+                json += "{\"name\":";
+                AppendJsonString(json, event.name);
+                json += fmt::format(",\"ph\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}", event.phase, thread_id, to_us(event.start_ticks));
+                switch (event.phase) {
+                case 'X':
+                    json += fmt::format(",\"dur\":{:.3f}", static_cast<double>(event.duration_ticks) * us_per_tick);
+                    break;
+                case 'i':
+                    json += ",\"s\":\"t\"";
+                    break;
+                case 'f':
+                    json += fmt::format(",\"cat\":\"flow\",\"id\":{},\"bp\":\"e\"", event.flow_id);
+                    break;
+                default:
+                    json += fmt::format(",\"cat\":\"flow\",\"id\":{}", event.flow_id);
+                    break;
+                }
+                json += "},\n";
+                ++event_count;
+            }
+        }
+    }
+    if (json.ends_with(",\n")) {
+        json.resize(json.size() - 2); // Trailing ",\n"; there is none if no buffer was claimed
+    }
+    json += "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file || !file.write(json.data(), static_cast<std::streamsize>(json.size()))) {
+        spdlog::error("Failed to write trace to '{}'.", path.string());
+        return false;
+    }
+    spdlog::info("Wrote {} trace events to '{}'.", event_count, path.string());
+    if (const uint64_t dropped = g_dropped_events.load(std::memory_order_relaxed); dropped > 0) {
+        spdlog::warn("{} trace events were dropped by threads that found no free buffer (of {}).", dropped, kMaxTraceBuffers);
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define AUDIOPLAYER_TRACE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define AUDIOPLAYER_TRACE_TSC 1
+#else
+#include <chrono>
+#endif
+
+// Event tracing with Chrome trace-event JSON export (opens in chrome://tracing and ui.perfetto.dev).
+// Each thread appends to its own fixed ring, so recording takes no lock: a timestamp from the CPU
+// counter and a few stores. Names must be string literals (only the pointer is kept). Flow events
+// link slices across threads, e.g. a click to the file open it caused to the first audio period.
+// Thread buffers are preallocated when tracing is first enabled; the first event on a thread claims
+// one without locking, and a thread that finds none free drops its events.
+
+struct TraceEvent {
+    const char* name;
+    uint64_t start_ticks;
+    uint64_t duration_ticks;
+    uint64_t flow_id;
+    char phase; // Chrome phase: 'X' complete, 'i' instant, 's'/'t'/'f' flow start/step/end
+};
+
+constexpr size_t kTraceEventsPerThread = 16384;
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline uint64_t ReadTraceTicks() {
+#if AUDIOPLAYER_TRACE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline bool IsTracingEnabled() {
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+void SetTracingEnabled(bool enabled);
+// Names the calling thread in exported traces. Repeated calls with the same literal are nearly free.
+void SetTraceThreadName(const char* name);
+uint64_t NewTraceFlowId();
+void RecordTraceEvent(const char* name, char phase, uint64_t start_ticks, uint64_t duration_ticks, uint64_t flow_id);
+// Writes every thread's buffered events as Chrome JSON. Safe while other threads keep tracing.
+bool WriteChromeTrace(const std::filesystem::path& path);
+size_t CountTraceEvents();
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name), start(IsTracingEnabled() ? ReadTraceTicks() : 0) {}
+    ~TraceScope() {
+        if (start != 0) {
+            RecordTraceEvent(name, 'X', start, ReadTraceTicks() - start, 0);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_EVENT_IF_ENABLED(name, phase, flow_id)                                \
+    do {                                                                            \
+        if (IsTracingEnabled()) {                                                   \
+            RecordTraceEvent(name, phase, ReadTraceTicks(), 0, flow_id);            \
+        }                                                                           \
+    } while (0)
+#define TRACE_INSTANT(name) TRACE_EVENT_IF_ENABLED(name, 'i', 0)
+// Flow events attach to the enclosing TRACE_SCOPE on their thread.
+#define TRACE_FLOW_BEGIN(name, flow_id) TRACE_EVENT_IF_ENABLED(name, 's', flow_id)
+#define TRACE_FLOW_STEP(name, flow_id) TRACE_EVENT_IF_ENABLED(name, 't', flow_id)
+#define TRACE_FLOW_END(name, flow_id) TRACE_EVENT_IF_ENABLED(name, 'f', flow_id)
@@ -0,0 +1,315 @@
+#include "track_analysis.h"
+
+#include "dsp.h"
+#include "miniaudio.h"
+#include "trace.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr size_t kOnsetFrameSize = 1024;
+constexpr size_t kOnsetHopSize = 128;      // ~86 envelope frames per second at 11.025 kHz
+constexpr float kOnsetCompression = 100.0f;
+constexpr double kTempoPriorCenterBpm = 120.0;
+constexpr double kTempoPriorOctaves = 0.9; // Width of the log-normal tempo prior, resolves octave errors
+constexpr double kTempoStepBpm = 0.05;
+constexpr int kCombHarmonics = 4;
+
+constexpr size_t kKeyFrameSize = 4096;
+constexpr size_t kKeyHopSize = 2048;
+
+constexpr ma_uint64 kSilenceBlockFrames = 4096;
+constexpr double kSilenceTailWindowSeconds = 20.0;
+constexpr double kSilenceLeadPadSeconds = 0.010; // Keep a little air before the first transient
+constexpr double kSilenceTailPadSeconds = 0.050; // ...and after the last audible sample
+
+constexpr std::array<float, 12> kMajorProfile = {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f};
+constexpr std::array<float, 12> kMinorProfile = {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f};
+
+constexpr std::array<const char*, 24> kKeyNames = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B",
+    "Cm", "C#m", "Dm", "D#m", "Em", "Fm", "F#m", "Gm", "G#m", "Am", "A#m", "Bm"};
+
+// Spectral flux of the log-compressed magnitude spectrum, de-trended and half-wave rectified.
+std::vector<float> ComputeOnsetEnvelope(const float* samples, size_t sample_count) {
+    std::vector<float> envelope;
+    if (sample_count < kOnsetFrameSize) {
+        return envelope;
+    }
+    const FftPlan plan = CreateFftPlan(kOnsetFrameSize);
+    FftScratch scratch;
+    std::vector<float> power(kOnsetFrameSize / 2 + 1);
+    std::vector<float> previous(power.size(), 0.0f);
+
+    const size_t frame_count = (sample_count - kOnsetFrameSize) / kOnsetHopSize + 1;
+    envelope.resize(frame_count);
+    for (size_t t = 0; t < frame_count; ++t) {
+        ComputePowerSpectrum(plan, samples + t * kOnsetHopSize, power.data(), scratch);
+        float flux = 0.0f;
+        for (size_t k = 1; k < power.size(); ++k) {
+            float magnitude = std::log1p(kOnsetCompression * std::sqrt(power[k]));
+            flux += std::max(0.0f, magnitude - previous[k]);
+            previous[k] = magnitude;
+        }
+        envelope[t] = flux;
+    }
+    envelope[0] = 0.0f; // First frame has no predecessor
+
+    // Subtract a ~0.5 s moving average so sustained loudness does not look like an onset.
+    const size_t half_window = 22;
+    std::vector<float> prefix(frame_count + 1, 0.0f);
+    for (size_t t = 0; t < frame_count; ++t) {
+        prefix[t + 1] = prefix[t] + envelope[t];
+    }
+    for (size_t t = 0; t < frame_count; ++t) {
+        size_t begin = t > half_window ? t - half_window : 0;
+        size_t end = std::min(frame_count, t + half_window + 1);
+        float local_mean = (prefix[end] - prefix[begin]) / static_cast<float>(end - begin);
+        envelope[t] = std::max(0.0f, envelope[t] - local_mean);
+    }
+    return envelope;
+}
+
+float InterpolateAt(const std::vector<float>& values, double position) {
+    size_t index = static_cast<size_t>(position);
+    if (index + 1 >= values.size()) {
+        return 0.0f;
+    }
+    float frac = static_cast<float>(position - static_cast<double>(index));
+    return values[index] + frac * (values[index + 1] - values[index]);
+}
+
+float PearsonCorrelation(const float* a, const float* b, size_t count) {
+    float mean_a = 0.0f, mean_b = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        mean_a += a[i];
+        mean_b += b[i];
+    }
+    mean_a /= static_cast<float>(count);
+    mean_b /= static_cast<float>(count);
+    float cov = 0.0f, var_a = 0.0f, var_b = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        cov += (a[i] - mean_a) * (b[i] - mean_b);
+        var_a += (a[i] - mean_a) * (a[i] - mean_a);
+        var_b += (b[i] - mean_b) * (b[i] - mean_b);
+    }
+    float denom = std::sqrt(var_a * var_b);
+    return denom > 0.0f ? cov / denom : 0.0f;
+}
+
+ma_uint64 FindFirstFrameAbove(const float* samples, ma_uint64 frame_count, ma_uint32 channels, float threshold) {
+    for (ma_uint64 frame = 0; frame < frame_count; ++frame) {
+        if (DspPeakAbs(samples + frame * channels, channels) > threshold) {
+            return frame;
+        }
+    }
+    return frame_count;
+}
+
+ma_uint64 FindLastFrameAbove(const float* samples, ma_uint64 frame_count, ma_uint32 channels, float threshold) {
+    for (ma_uint64 frame = frame_count; frame > 0; --frame) {
+        if (DspPeakAbs(samples + (frame - 1) * channels, channels) > threshold) {
+            return frame - 1;
+        }
+    }
+    return frame_count;
+}
+
+} // namespace
+
+float EstimateTempo(const float* mono_samples, size_t sample_count, uint32_t sample_rate) {
+    std::vector<float> envelope = ComputeOnsetEnvelope(mono_samples, sample_count);
+    const double envelope_rate = static_cast<double>(sample_rate) / kOnsetHopSize;
+    const size_t max_lag = static_cast<size_t>(std::ceil(kCombHarmonics * 60.0 * envelope_rate / kMinDetectableBpm)) + 2;
+    if (envelope.size() < max_lag * 2) {
+        return 0.0f;
+    }
+
+    // Normalised autocorrelation of the onset envelope; each lag is one vectorised dot product.
+    std::vector<float> autocorrelation(max_lag, 0.0f);
+    const float energy = DspSumOfSquares(envelope.data(), envelope.size());
+    if (energy <= 0.0f) {
+        return 0.0f;
+    }
+    for (size_t lag = 1; lag < max_lag; ++lag) {
+        size_t overlap = envelope.size() - lag;
+        autocorrelation[lag] = DspDotProduct(envelope.data(), envelope.data() + lag, overlap) / energy
+                               * static_cast<float>(envelope.size()) / static_cast<float>(overlap);
+    }
+
+    // Comb filter: a true beat period also lines up with its multiples.
+    double best_bpm = 0.0;
+    double best_score = 0.0;
+    for (double bpm = kMinDetectableBpm; bpm <= kMaxDetectableBpm; bpm += kTempoStepBpm) {
+        double lag = 60.0 * envelope_rate / bpm;
+        double score = 0.0;
+        for (int k = 1; k <= kCombHarmonics; ++k) {
+            score += InterpolateAt(autocorrelation, lag * k) / k;
+        }
+        double octaves = std::log2(bpm / kTempoPriorCenterBpm) / kTempoPriorOctaves;
+        score *= std::exp(-0.5 * octaves * octaves);
+        if (score > best_score) {
+            best_score = score;
+            best_bpm = bpm;
+        }
+    }
+    return static_cast<float>(std::round(best_bpm * 10.0) / 10.0);
+}
+
+int EstimateKey(const float* mono_samples, size_t sample_count, uint32_t sample_rate, float* confidence_out) {
+    if (confidence_out) {
+        *confidence_out = 0.0f;
+    }
+    if (sample_count < kKeyFrameSize) {
+        return kUnknownKey;
+    }
+    const FftPlan plan = CreateFftPlan(kKeyFrameSize);
+    const std::vector<int> bin_map = CreateChromaBinMap(kKeyFrameSize, sample_rate, 55.0, 2000.0);
+    FftScratch scratch;
+    std::vector<float> power(kKeyFrameSize / 2 + 1);
+    std::array<float, 12> frame_chroma{};
+    std::array<float, 12> total_chroma{};
+
+    for (size_t start = 0; start + kKeyFrameSize <= sample_count; start += kKeyHopSize) {
+        ComputePowerSpectrum(plan, mono_samples + start, power.data(), scratch);
+        AccumulateChroma(power.data(), bin_map, frame_chroma.data());
+        float frame_sum = 0.0f;
+        for (float v : frame_chroma) {
+            frame_sum += v;
+        }
+        if (frame_sum <= 1e-9f) {
+            continue; // Silent frame
+        }
+        // Per-frame normalisation keeps loud passages from dominating the key estimate.
+        for (size_t c = 0; c < 12; ++c) {
+            total_chroma[c] += frame_chroma[c] / frame_sum;
+        }
+    }
+
+    int best_key = kUnknownKey;
+    float best = -2.0f;
+    float second = -2.0f;
+    std::array<float, 12> rotated{};
+    for (int key = 0; key < 24; ++key) {
+        const auto& profile = key < 12 ? kMajorProfile : kMinorProfile;
+        int tonic = key % 12;
+        for (int c = 0; c < 12; ++c) {
+            rotated[(c + tonic) % 12] = profile[c];
+        }
+        float correlation = PearsonCorrelation(total_chroma.data(), rotated.data(), 12);
+        if (correlation > best) {
+            second = best;
+            best = correlation;
+            best_key = key;
+        } else if (correlation > second) {
+            second = correlation;
+        }
+    }
+    if (best <= 0.0f) {
+        return kUnknownKey;
+    }
+    if (confidence_out) {
+        *confidence_out = best - second;
+    }
+    return best_key;
+}
+
+bool AnalyzeTrack(const std::string& filepath, TrackAnalysis& analysis_out) {
+    TRACE_SCOPE("AnalyzeTrack");
+    analysis_out = TrackAnalysis{};
+    std::vector<float> samples;
+    if (!DecodeFileToMono(filepath, kAnalysisSampleRate, kAnalysisMaxSeconds, samples)) {
+        return false;
+    }
+    analysis_out.bpm = EstimateTempo(samples.data(), samples.size(), kAnalysisSampleRate);
+    analysis_out.musical_key = EstimateKey(samples.data(), samples.size(), kAnalysisSampleRate, &analysis_out.key_confidence);
+    DetectSilenceBounds(filepath, analysis_out.silence);
+    return true;
+}
+
+bool DetectSilenceBounds(const std::string& filepath, SilenceBounds& bounds_out) {
+    bounds_out = SilenceBounds{};
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 0, 0); // Native channels and rate
+    ma_decoder decoder;
+    if (ma_decoder_init_file(filepath.c_str(), &config, &decoder) != MA_SUCCESS) {
+        return false;
+    }
+    const ma_uint32 channels = decoder.outputChannels;
+    const ma_uint32 sample_rate = decoder.outputSampleRate;
+    ma_uint64 length = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) != MA_SUCCESS || length == 0) {
+        ma_decoder_uninit(&decoder);
+        return false;
+    }
+    const float threshold = std::pow(10.0f, kSilenceThresholdDb / 20.0f);
+    std::vector<float> block(static_cast<size_t>(kSilenceBlockFrames * channels));
+
+    // Leading edge: read forward until a block's peak crosses the threshold.
+    ma_uint64 first_audible = length;
+    ma_uint64 position = 0;
+    while (position < length) {
+        ma_uint64 frames_read = 0;
+        ma_decoder_read_pcm_frames(&decoder, block.data(), kSilenceBlockFrames, &frames_read);
+        if (frames_read == 0) {
+            break;
+        }
+        if (DspPeakAbs(block.data(), static_cast<size_t>(frames_read * channels)) > threshold) {
+            first_audible = position + FindFirstFrameAbove(block.data(), frames_read, channels, threshold);
+            break;
+        }
+        position += frames_read;
+    }
+    if (first_audible >= length) {
+        ma_decoder_uninit(&decoder);
+        return true; // Entirely silent; leave it untrimmed
+    }
+
+    // Trailing edge: scan a window at the end, widening it only if the whole window was silent.
+    // Windows are read forwards because backwards seeking is expensive for compressed formats.
+    ma_uint64 last_audible_end = 0;
+    ma_uint64 window = static_cast<ma_uint64>(kSilenceTailWindowSeconds * sample_rate);
+    while (last_audible_end == 0) {
+        ma_uint64 window_start = length > window ? std::max(first_audible, length - window) : first_audible;
+        if (ma_decoder_seek_to_pcm_frame(&decoder, window_start) != MA_SUCCESS) {
+            break;
+        }
+        position = window_start;
+        while (true) {
+            ma_uint64 frames_read = 0;
+            ma_decoder_read_pcm_frames(&decoder, block.data(), kSilenceBlockFrames, &frames_read);
+            if (frames_read == 0) {
+                break;
+            }
+            if (DspPeakAbs(block.data(), static_cast<size_t>(frames_read * channels)) > threshold) {
+                last_audible_end = position + FindLastFrameAbove(block.data(), frames_read, channels, threshold) + 1;
+            }
+            position += frames_read;
+        }
+        if (window_start == first_audible) {
+            break;
+        }
+        window *= 4;
+    }
+    ma_decoder_uninit(&decoder);
+    if (last_audible_end <= first_audible) {
+        return false;
+    }
+
+    const ma_uint64 lead_pad = static_cast<ma_uint64>(kSilenceLeadPadSeconds * sample_rate);
+    const ma_uint64 tail_pad = static_cast<ma_uint64>(kSilenceTailPadSeconds * sample_rate);
+    bounds_out.detected = true;
+    bounds_out.sample_rate = sample_rate;
+    bounds_out.start_frame = first_audible > lead_pad ? first_audible - lead_pad : 0;
+    bounds_out.end_frame = std::min(length, last_audible_end + tail_pad);
+    return true;
+}
+
+const char* GetKeyName(int musical_key) {
+    if (musical_key < 0 || musical_key >= static_cast<int>(kKeyNames.size())) {
+        return "-";
+    }
+    return kKeyNames[musical_key];
+}
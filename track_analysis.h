@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Per-track analysis: tempo and key for DJ-style sorting and queue constraints, and the
+// audible region used to trim leading/trailing silence at playback time.
+
+constexpr uint32_t kAnalysisSampleRate = 11025;
+constexpr double kAnalysisMaxSeconds = 240.0;
+constexpr float kMinDetectableBpm = 60.0f;
+constexpr float kMaxDetectableBpm = 200.0f;
+
+constexpr float kSilenceThresholdDb = -60.0f;
+
+// Keys 0-11 are C..B major, 12-23 are C..B minor, -1 is unknown.
+constexpr int kUnknownKey = -1;
+
+// Audible region of a track in PCM frames at the file's native sample rate.
+struct SilenceBounds {
+    bool detected = false;
+    uint64_t start_frame = 0;
+    uint64_t end_frame = 0; // Exclusive
+    uint32_t sample_rate = 0;
+};
+
+struct TrackAnalysis {
+    float bpm = 0.0f;          // 0 when no stable tempo was found
+    int musical_key = kUnknownKey;
+    float key_confidence = 0.0f;
+    SilenceBounds silence;
+};
+
+bool AnalyzeTrack(const std::string& filepath, TrackAnalysis& analysis_out);
+
+// Onset envelope + autocorrelation with a comb over beat multiples. Returns 0 when undetermined.
+float EstimateTempo(const float* mono_samples, size_t sample_count, uint32_t sample_rate);
+// Accumulated chroma correlated against Krumhansl-Kessler key profiles.
+int EstimateKey(const float* mono_samples, size_t sample_count, uint32_t sample_rate, float* confidence_out = nullptr);
+
+// Peak scan from each end of the decoded file, stopping at the first block above the threshold.
+bool DetectSilenceBounds(const std::string& filepath, SilenceBounds& bounds_out);
+
+const char* GetKeyName(int musical_key);
@@ -0,0 +1,140 @@
+#include "track_prefetch.h"
+
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+#if defined(__linux__)
+bool AdviseFile(const std::string& filepath, uint64_t bytes, int advice) {
+    const int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::debug("Prefetch: cannot open '{}': {}", filepath, std::strerror(errno));
+        return false;
+    }
+    const int error = posix_fadvise(fd, 0, static_cast<off_t>(bytes), advice); // Length 0 = to the end of the file
+    close(fd);
+    if (error != 0) {
+        spdlog::debug("Prefetch: fadvise failed for '{}': {}", filepath, std::strerror(error));
+        return false;
+    }
+    return true;
+}
+#endif
+
+// Returns the bytes warmed, or 0 on failure.
+uint64_t WarmFile(const std::string& filepath, uint64_t bytes) {
+#if defined(__linux__)
+    // Starts the reads and returns; the kernel fills the cache in the background.
+    return AdviseFile(filepath, bytes, POSIX_FADV_WILLNEED) ? bytes : 0;
+#else
+    std::ifstream in(filepath, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+    uint64_t warmed = 0;
+    while (in && warmed < bytes) {
+        in.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(buffer.size(), bytes - warmed)));
+        warmed += static_cast<uint64_t>(in.gcount());
+    }
+    return warmed;
+#endif
+}
+
+bool EvictFile(const std::string& filepath) {
+#if defined(__linux__)
+    return AdviseFile(filepath, 0, POSIX_FADV_DONTNEED);
+#else
+    (void)filepath;
+    return false; // No portable equivalent; the OS ages the pages out
+#endif
+}
+
+void PrefetchLoop(std::stop_token stop_token, TrackPrefetcher* prefetcher) {
+    SetTraceThreadName("Prefetch I/O");
+    TrackPrefetchStats& stats = prefetcher->stats;
+    while (true) {
+        TrackPrefetchRequest request;
+        {
+            std::unique_lock lock(prefetcher->mutex);
+            if (!prefetcher->requests_available.wait(lock, stop_token, [prefetcher] { return !prefetcher->requests.empty(); })) {
+                return;
+            }
+            request = std::move(prefetcher->requests.front());
+            prefetcher->requests.pop_front();
+        }
+        TRACE_SCOPE("PrefetchRequest");
+        const auto start = std::chrono::steady_clock::now();
+        if (request.bytes > 0) {
+            const uint64_t warmed = WarmFile(request.filepath, request.bytes);
+            if (warmed > 0) {
+                stats.warmed_files.fetch_add(1, std::memory_order_relaxed);
+                stats.warmed_bytes.fetch_add(warmed, std::memory_order_relaxed);
+            } else {
+                stats.failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (EvictFile(request.filepath)) {
+            stats.evicted_files.fetch_add(1, std::memory_order_relaxed);
+        }
+        stats.busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+                                std::memory_order_relaxed);
+        stats.pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void PostRequest(TrackPrefetcher& prefetcher, TrackPrefetchRequest request) {
+    if (!prefetcher.io_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(prefetcher.mutex);
+        prefetcher.requests.push_back(std::move(request));
+        prefetcher.stats.pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    prefetcher.requests_available.notify_one();
+}
+
+} // namespace
+
+void StartTrackPrefetcher(TrackPrefetcher& prefetcher) {
+    if (!prefetcher.io_thread.joinable()) {
+        prefetcher.io_thread = std::jthread(PrefetchLoop, &prefetcher);
+    }
+}
+
+void StopTrackPrefetcher(TrackPrefetcher& prefetcher) {
+    if (!prefetcher.io_thread.joinable()) {
+        return;
+    }
+    prefetcher.io_thread.request_stop();
+    prefetcher.requests_available.notify_all();
+    prefetcher.io_thread.join();
+    std::lock_guard lock(prefetcher.mutex);
+    prefetcher.requests.clear();
+    prefetcher.stats.pending.store(0, std::memory_order_relaxed);
+}
+
+void WarmUpcomingTracks(TrackPrefetcher& prefetcher, const std::vector<std::string>& upcoming, uint64_t bytes) {
+    for (const auto& filepath : upcoming) {
+        if (std::find(prefetcher.warm_files.begin(), prefetcher.warm_files.end(), filepath) == prefetcher.warm_files.end()) {
+            PostRequest(prefetcher, {filepath, bytes});
+        }
+    }
+    prefetcher.warm_files = upcoming;
+}
+
+void EvictFinishedTrack(TrackPrefetcher& prefetcher, const std::string& filepath) {
+    if (std::find(prefetcher.warm_files.begin(), prefetcher.warm_files.end(), filepath) == prefetcher.warm_files.end()) {
+        PostRequest(prefetcher, {filepath, 0});
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Page-cache hints for the play queue, issued from a background I/O thread. The first few MB of the
+// next tracks are read ahead while the current one plays, so a track start on a spinning disk or
+// NFS does not wait for the first read; a track that has finished is dropped from the cache so
+// large lossless files do not push out everything else. On Linux these are posix_fadvise WILLNEED
+// and DONTNEED; elsewhere warming reads the bytes and eviction is left to the OS.
+
+constexpr uint64_t kPrefetchDefaultBytes = 8ull << 20;
+constexpr int kPrefetchDefaultTracks = 3;
+
+struct TrackPrefetchStats {
+    std::atomic<uint32_t> pending{0};
+    std::atomic<uint64_t> warmed_files{0};
+    std::atomic<uint64_t> warmed_bytes{0};
+    std::atomic<uint64_t> evicted_files{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> busy_ns{0}; // Time the I/O thread spent on requests
+};
+
+struct TrackPrefetchRequest {
+    std::string filepath;
+    uint64_t bytes = 0; // Bytes to warm from the start; 0 = evict the whole file
+};
+
+struct TrackPrefetcher {
+    std::mutex mutex;
+    std::condition_variable_any requests_available;
+    std::deque<TrackPrefetchRequest> requests;
+    std::jthread io_thread;
+    TrackPrefetchStats stats;
+
+    // UI thread: the files warmed for the current queue, so unchanged entries are not re-sent.
+    std::vector<std::string> warm_files;
+};
+
+void StartTrackPrefetcher(TrackPrefetcher& prefetcher);
+// Drops queued requests and joins the I/O thread.
+void StopTrackPrefetcher(TrackPrefetcher& prefetcher);
+
+// UI thread. Warms the first `bytes` of each file in `upcoming` that was not warmed last time.
+void WarmUpcomingTracks(TrackPrefetcher& prefetcher, const std::vector<std::string>& upcoming, uint64_t bytes);
+// UI thread. Evicts a finished track, unless it is also coming up again.
+void EvictFinishedTrack(TrackPrefetcher& prefetcher, const std::string& filepath);
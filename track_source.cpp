@@ -0,0 +1,180 @@
+#include "track_source.h"
+
+#include "trace.h"
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+StreamStallStats g_stream_stall_stats;
+
+// --- Stall Monitor ---
+ma_result StallMonitorRead(ma_data_source* data_source, void* frames_out, ma_uint64 frame_count, ma_uint64* frames_read) {
+    auto* source = static_cast<StallMonitorDataSource*>(data_source);
+    ma_uint64 read = 0;
+    ma_result result = ma_data_source_read_pcm_frames(source->inner, frames_out, frame_count, &read);
+    *frames_read = read;
+    g_stream_stall_stats.reads.fetch_add(1, std::memory_order_relaxed);
+    if (result == MA_BUSY && read < frame_count) {
+        g_stream_stall_stats.stalls.fetch_add(1, std::memory_order_relaxed);
+        if (source->sample_rate > 0) {
+            g_stream_stall_stats.stalled_us.fetch_add((frame_count - read) * 1000000 / source->sample_rate, std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+ma_result StallMonitorSeek(ma_data_source* data_source, ma_uint64 frame_index) {
+    return ma_data_source_seek_to_pcm_frame(static_cast<StallMonitorDataSource*>(data_source)->inner, frame_index);
+}
+
+ma_result StallMonitorGetDataFormat(ma_data_source* data_source, ma_format* format, ma_uint32* channels, ma_uint32* sample_rate,
+                                    ma_channel* channel_map, size_t channel_map_cap) {
+    return ma_data_source_get_data_format(static_cast<StallMonitorDataSource*>(data_source)->inner, format, channels, sample_rate, channel_map,
+                                          channel_map_cap);
+}
+
+ma_result StallMonitorGetCursor(ma_data_source* data_source, ma_uint64* cursor) {
+    return ma_data_source_get_cursor_in_pcm_frames(static_cast<StallMonitorDataSource*>(data_source)->inner, cursor);
+}
+
+ma_result StallMonitorGetLength(ma_data_source* data_source, ma_uint64* length) {
+    return ma_data_source_get_length_in_pcm_frames(static_cast<StallMonitorDataSource*>(data_source)->inner, length);
+}
+
+ma_data_source_vtable g_stall_monitor_vtable = {
+    StallMonitorRead,
+    StallMonitorSeek,
+    StallMonitorGetDataFormat,
+    StallMonitorGetCursor,
+    StallMonitorGetLength,
+    nullptr,
+    0
+};
+
+// The decoder, or the stall monitor in front of it for streams.
+ma_data_source* GetTrackDecodedSource(TrackSource* track) {
+    if (track->monitored_initialized) {
+        return &track->monitored;
+    }
+    return &track->decoded;
+}
+
+// Puts the stall monitor after a stream's decoder and the high-quality resampler after that when
+// the rates differ.
+ma_result InsertTrackResampler(TrackSource* track, const std::string& filepath, ResamplerQuality quality, ma_uint32 output_rate) {
+    ma_uint32 native_rate = 0;
+    ma_result result = ma_data_source_get_data_format(&track->decoded, nullptr, nullptr, &native_rate, nullptr, 0);
+    if (result == MA_SUCCESS && track->streaming && !track->monitored_initialized) {
+        track->monitored.inner = &track->decoded;
+        track->monitored.sample_rate = native_rate;
+        ma_data_source_config config = ma_data_source_config_init();
+        config.vtable = &g_stall_monitor_vtable;
+        if (ma_data_source_init(&config, &track->monitored.base) == MA_SUCCESS) {
+            track->monitored_initialized = true;
+            g_stream_stall_stats.active_streams.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (result != MA_SUCCESS || quality == ResamplerQuality::Builtin || native_rate == output_rate) {
+        return MA_SUCCESS; // Nothing to convert, or left to ma_sound
+    }
+    result = InitializeResamplingDataSource(GetTrackDecodedSource(track), quality, output_rate, &track->resampled);
+    if (result != MA_SUCCESS) {
+        spdlog::warn("Falling back to the built-in resampler for '{}': {}", filepath, ma_result_description(result));
+        return MA_SUCCESS;
+    }
+    track->resampled_initialized = true;
+    spdlog::debug("Resampling '{}' {} -> {} Hz with {}.", filepath, native_rate, output_rate, GetResamplerQualityName(quality));
+    return MA_SUCCESS;
+}
+
+} // namespace
+
+StreamStallStats& GetStreamStallStats() {
+    return g_stream_stall_stats;
+}
+
+ma_result InitializeTrackSource(ma_resource_manager* resource_manager, const std::string& filepath, ma_uint32 data_source_flags,
+                                ResamplerQuality quality, ma_uint32 output_rate, TrackSource* track) {
+    TRACE_SCOPE("InitializeTrackSource");
+    ma_result result = ma_resource_manager_data_source_init(resource_manager, filepath.c_str(), data_source_flags, nullptr, &track->decoded);
+    if (result != MA_SUCCESS) {
+        return result;
+    }
+    track->decoded_initialized = true;
+    track->streaming = (data_source_flags & MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM) != 0;
+    return InsertTrackResampler(track, filepath, quality, output_rate);
+}
+
+ma_result BeginTrackSourceOpen(ma_resource_manager* resource_manager, const std::string& filepath, ma_uint32 data_source_flags, TrackSource* track,
+                               ma_fence* done_fence) {
+    TRACE_SCOPE("BeginTrackSourceOpen");
+    ma_result result = ma_fence_init(&track->open_fence);
+    if (result != MA_SUCCESS) {
+        return result;
+    }
+    track->open_fence_initialized = true;
+    ma_async_notification_poll_init(&track->open_notification);
+
+    ma_resource_manager_pipeline_notifications notifications = ma_resource_manager_pipeline_notifications_init();
+    notifications.init.pNotification = &track->open_notification;
+    notifications.init.pFence = &track->open_fence;
+    notifications.done.pFence = done_fence;
+    ma_resource_manager_data_source_config config = ma_resource_manager_data_source_config_init();
+    config.pFilePath = filepath.c_str();
+    config.flags = data_source_flags | MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_ASYNC;
+    config.pNotifications = &notifications;
+    result = ma_resource_manager_data_source_init_ex(resource_manager, &config, &track->decoded);
+    if (result != MA_SUCCESS) {
+        return result;
+    }
+    track->decoded_initialized = true;
+    track->streaming = (data_source_flags & MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM) != 0;
+    return MA_SUCCESS;
+}
+
+bool IsTrackSourceOpenComplete(const TrackSource* track) {
+    return !track->decoded_initialized || ma_async_notification_poll_is_signalled(&track->open_notification);
+}
+
+void WaitForTrackSourceOpen(TrackSource* track) {
+    if (track->open_fence_initialized) {
+        ma_fence_wait(&track->open_fence);
+    }
+}
+
+ma_result FinishTrackSourceOpen(TrackSource* track, const std::string& filepath, ResamplerQuality quality, ma_uint32 output_rate) {
+    // A decoded buffer may still be filling in the background (MA_BUSY); it plays from what is there.
+    ma_result result = ma_resource_manager_data_source_result(&track->decoded);
+    if (result != MA_SUCCESS && result != MA_BUSY) {
+        return result;
+    }
+    return InsertTrackResampler(track, filepath, quality, output_rate);
+}
+
+ma_data_source* GetTrackDataSource(TrackSource* track) {
+    if (track->resampled_initialized) {
+        return &track->resampled;
+    }
+    return GetTrackDecodedSource(track);
+}
+
+void UninitializeTrackSource(TrackSource* track) {
+    if (track->resampled_initialized) {
+        UninitializeResamplingDataSource(&track->resampled);
+        track->resampled_initialized = false;
+    }
+    if (track->monitored_initialized) {
+        ma_data_source_uninit(&track->monitored.base);
+        track->monitored_initialized = false;
+        g_stream_stall_stats.active_streams.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (track->decoded_initialized) {
+        ma_resource_manager_data_source_uninit(&track->decoded);
+        track->decoded_initialized = false;
+    }
+    if (track->open_fence_initialized) {
+        ma_fence_uninit(&track->open_fence);
+        track->open_fence_initialized = false;
+    }
+}
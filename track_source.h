@@ -0,0 +1,62 @@
+#pragma once
+
+#include "miniaudio.h"
+#include "resampler.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// A track opened for playback: the resource manager's streaming decoder (at the file's native
+// rate), a stall monitor for streams, and optionally the high-quality resampler. ma_sound is initialised from
+// GetTrackDataSource; when no resampler is inserted, ma_sound's built-in converter is used.
+
+// --- Stream Stalls ---
+// Streams are watched for page-boundary stalls: reads that come back short with MA_BUSY because
+// the job threads have not decoded the next page yet. ma_sound plays silence for the missing frames.
+struct StreamStallStats {
+    std::atomic<uint32_t> active_streams{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> stalls{0};
+    std::atomic<uint64_t> stalled_us{0}; // Audio missed, at each stream's native rate
+};
+
+StreamStallStats& GetStreamStallStats();
+
+// Pass-through data source in front of a stream's decoder that feeds StreamStallStats.
+struct StallMonitorDataSource {
+    ma_data_source_base base; // Must be first
+    ma_data_source* inner = nullptr;
+    ma_uint32 sample_rate = 0;
+};
+
+struct TrackSource {
+    ma_resource_manager_data_source decoded{};
+    StallMonitorDataSource monitored;
+    ResamplingDataSource resampled;
+    bool decoded_initialized = false;
+    bool monitored_initialized = false;
+    bool resampled_initialized = false;
+    bool streaming = false; // Opened with MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM
+
+    // Asynchronous open: the resource manager's job thread signals both once the decoder is up.
+    ma_fence open_fence{};
+    ma_async_notification_poll open_notification{};
+    bool open_fence_initialized = false;
+};
+
+// `data_source_flags` are MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_* (STREAM for the main player).
+ma_result InitializeTrackSource(ma_resource_manager* resource_manager, const std::string& filepath, ma_uint32 data_source_flags,
+                                ResamplerQuality quality, ma_uint32 output_rate, TrackSource* track);
+ma_data_source* GetTrackDataSource(TrackSource* track);
+void UninitializeTrackSource(TrackSource* track);
+
+// Non-blocking open: BeginTrackSourceOpen posts the file open and first decode to the resource
+// manager's job thread and returns straight away. Poll IsTrackSourceOpenComplete (never blocks),
+// then FinishTrackSourceOpen reports the outcome and inserts the resampler. A source must not be
+// uninitialised while its open is in flight; WaitForTrackSourceOpen blocks until it is done.
+// `done_fence`, if given, is also released once a decoded or in-memory file has been fully loaded.
+ma_result BeginTrackSourceOpen(ma_resource_manager* resource_manager, const std::string& filepath, ma_uint32 data_source_flags, TrackSource* track,
+                               ma_fence* done_fence = nullptr);
+bool IsTrackSourceOpenComplete(const TrackSource* track);
+void WaitForTrackSourceOpen(TrackSource* track);
+ma_result FinishTrackSourceOpen(TrackSource* track, const std::string& filepath, ResamplerQuality quality, ma_uint32 output_rate);
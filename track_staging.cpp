@@ -0,0 +1,398 @@
+#include "track_staging.h"
+
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr auto kStagingCheckInterval = std::chrono::minutes(5); // Between idle re-checks of staged sources
+constexpr uint64_t kChecksumSeed = 0x9e3779b97f4a7c15ull;
+constexpr uint64_t kChecksumPrime1 = 0x9e3779b185ebca87ull;
+constexpr uint64_t kChecksumPrime2 = 0xc2b2ae3d27d4eb4full;
+
+uint64_t MixChecksum(uint64_t hash, uint64_t word) {
+    hash ^= word * kChecksumPrime2;
+    hash = (hash << 31) | (hash >> 33);
+    return hash * kChecksumPrime1;
+}
+
+// Eight bytes per step. Chunks are hashed whole, so the result depends on where the reads split the
+// data; the copy and the verifying read use the same kStagingReadBytes chunks.
+uint64_t UpdateChecksum(uint64_t hash, const char* data, size_t size) {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = MixChecksum(hash, word);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    return MixChecksum(hash, tail ^ (static_cast<uint64_t>(size - i) << 56));
+}
+
+// Named by a hash of the source path; the extension is kept so the decoder is chosen as for the source.
+std::filesystem::path GetStagedPath(const TrackStagingCache& cache, const std::string& source) {
+    return cache.directory / fmt::format("{:016x}{}", std::hash<std::string>{}(source), std::filesystem::path(source).extension().string());
+}
+
+// Size and modification time, which a lookup compares against the source's current ones.
+bool StatSource(const std::string& source, uint64_t& bytes_out, std::filesystem::file_time_type& modified_out) {
+    std::error_code error;
+    bytes_out = std::filesystem::file_size(source, error);
+    if (!error) {
+        modified_out = std::filesystem::last_write_time(source, error);
+    }
+    return !error;
+}
+
+// Writes the copy through to disk and drops its pages, so reading it back checks what is on disk
+// rather than the cached pages just written. False where that is not possible.
+bool FlushAndDropFromCache(const std::filesystem::path& path) {
+#if defined(__linux__)
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool dropped = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return dropped;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+// A name GetStagedPath could have produced, with or without the ".part" of an unfinished copy.
+bool IsStagedFileName(const std::string& name) {
+    constexpr size_t kHashDigits = 16;
+    if (name.size() < kHashDigits || (name.size() > kHashDigits && name[kHashDigits] != '.')) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.begin() + kHashDigits,
+                       [](char c) { return std::isdigit(static_cast<unsigned char>(c)) || (c >= 'a' && c <= 'f'); });
+}
+
+// Removes the copies an earlier run left behind. Anything else in the directory is not ours.
+void ClearStagingDirectory(const std::filesystem::path& directory) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        spdlog::warn("Staging: cannot create '{}': {}", directory.string(), error.message());
+        return;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file(error) && IsStagedFileName(entry.path().filename().string())) {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+// Copies in kStagingReadBytes reads. False on an I/O error or a stop request.
+bool CopyTrackFile(const std::string& source, const std::filesystem::path& destination, std::vector<char>& buffer, std::stop_token stop_token,
+                   uint64_t& bytes_out, uint64_t& checksum_out) {
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+        return false;
+    }
+    bytes_out = 0;
+    checksum_out = kChecksumSeed;
+    while (!stop_token.stop_requested()) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto read = static_cast<size_t>(in.gcount());
+        if (read == 0) {
+            return in.eof() && out.flush().good();
+        }
+        checksum_out = UpdateChecksum(checksum_out, buffer.data(), read);
+        out.write(buffer.data(), static_cast<std::streamsize>(read));
+        if (!out) {
+            return false;
+        }
+        bytes_out += read;
+    }
+    return false;
+}
+
+bool ChecksumFile(const std::filesystem::path& path, std::vector<char>& buffer, uint64_t& bytes_out, uint64_t& checksum_out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    bytes_out = 0;
+    checksum_out = kChecksumSeed;
+    while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0) {
+        const auto read = static_cast<size_t>(in.gcount());
+        checksum_out = UpdateChecksum(checksum_out, buffer.data(), read);
+        bytes_out += read;
+    }
+    return in.eof();
+}
+
+void RemoveStagedTrack(TrackStagingCache& cache, std::unordered_map<std::string, StagedTrack>::iterator it) {
+    std::error_code error;
+    std::filesystem::remove(it->second.local_path, error); // A file still open elsewhere goes with the next start
+    cache.stats.resident_bytes.fetch_sub(it->second.bytes, std::memory_order_relaxed);
+    cache.staged.erase(it);
+}
+
+// Caller holds the mutex. Evicts least recently used copies until `bytes` more fit the budget.
+bool MakeRoom(TrackStagingCache& cache, uint64_t bytes) {
+    while (cache.stats.resident_bytes.load(std::memory_order_relaxed) + bytes > cache.budget_bytes) {
+        auto oldest = cache.staged.end();
+        for (auto it = cache.staged.begin(); it != cache.staged.end(); ++it) {
+            if (it->first != cache.in_use && (oldest == cache.staged.end() || it->second.last_used < oldest->second.last_used)) {
+                oldest = it;
+            }
+        }
+        if (oldest == cache.staged.end()) {
+            return false;
+        }
+        spdlog::debug("Staging: evicting '{}'.", oldest->first);
+        RemoveStagedTrack(cache, oldest);
+        cache.stats.evicted_files.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void StageTrack(TrackStagingCache& cache, const std::string& source, std::vector<char>& buffer, std::stop_token stop_token) {
+    TRACE_SCOPE("StageTrack");
+    TrackStagingStats& stats = cache.stats;
+    std::error_code error;
+    uint64_t source_bytes = 0;
+    std::filesystem::file_time_type source_modified;
+    if (!StatSource(source, source_bytes, source_modified)) {
+        spdlog::debug("Staging: cannot stat '{}'.", source);
+        stats.copy_errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    {
+        std::lock_guard lock(cache.mutex);
+        if (source_bytes > cache.budget_bytes || !MakeRoom(cache, source_bytes)) {
+            spdlog::debug("Staging: no room for '{}' ({} bytes).", source, source_bytes);
+            return;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path local_path = GetStagedPath(cache, source);
+    std::filesystem::path partial_path = local_path;
+    partial_path += ".part"; // Renamed only once verified, so a torn copy is never opened
+    uint64_t copied_bytes = 0;
+    uint64_t source_checksum = 0;
+    if (!CopyTrackFile(source, partial_path, buffer, stop_token, copied_bytes, source_checksum)) {
+        std::filesystem::remove(partial_path, error);
+        if (!stop_token.stop_requested()) {
+            spdlog::warn("Staging: copying '{}' failed.", source);
+            stats.copy_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    // A source rewritten during the copy shows up as a new size or time; the copy may mix both versions.
+    uint64_t bytes_after = 0;
+    std::filesystem::file_time_type modified_after;
+    bool verified = copied_bytes == source_bytes && StatSource(source, bytes_after, modified_after) && bytes_after == source_bytes &&
+                    modified_after == source_modified;
+    if (verified && FlushAndDropFromCache(partial_path)) {
+        uint64_t verified_bytes = 0;
+        uint64_t verified_checksum = 0;
+        verified = ChecksumFile(partial_path, buffer, verified_bytes, verified_checksum) && verified_bytes == copied_bytes &&
+                   verified_checksum == source_checksum;
+    } else if (verified) {
+        verified = std::filesystem::file_size(partial_path, error) == copied_bytes && !error; // Only the size can be checked
+    }
+    if (!verified) {
+        spdlog::warn("Staging: the copy of '{}' does not match its source; discarded.", source);
+        stats.integrity_failures.fetch_add(1, std::memory_order_relaxed);
+        std::filesystem::remove(partial_path, error);
+        return;
+    }
+    std::filesystem::rename(partial_path, local_path, error);
+    if (error) {
+        spdlog::warn("Staging: cannot publish '{}': {}", local_path.string(), error.message());
+        stats.copy_errors.fetch_add(1, std::memory_order_relaxed);
+        std::filesystem::remove(partial_path, error);
+        return;
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    stats.copy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+    stats.staged_files.fetch_add(1, std::memory_order_relaxed);
+    stats.staged_bytes.fetch_add(copied_bytes, std::memory_order_relaxed);
+    std::lock_guard lock(cache.mutex);
+    cache.staged[source] = {local_path, copied_bytes, source_modified, ++cache.use_counter};
+    stats.resident_bytes.fetch_add(copied_bytes, std::memory_order_relaxed);
+    spdlog::debug("Staged '{}' ({:.1f} MB in {:.0f} ms).", source, copied_bytes / (1024.0 * 1024.0),
+                  std::chrono::duration<double, std::milli>(elapsed).count());
+}
+
+// Drops copies whose source now has a different size or modification time. Each source costs one
+// metadata round trip, made without the lock held. A source that cannot be reached keeps its copy:
+// it was verified when staged, and playing it is the point of staging.
+void CheckStagedTracks(TrackStagingCache& cache, std::stop_token stop_token) {
+    TRACE_SCOPE("CheckStagedTracks");
+    std::vector<std::pair<std::string, StagedTrack>> entries;
+    {
+        std::lock_guard lock(cache.mutex);
+        entries.assign(cache.staged.begin(), cache.staged.end());
+    }
+    for (const auto& [source, staged] : entries) {
+        if (stop_token.stop_requested()) {
+            return;
+        }
+        uint64_t source_bytes = 0;
+        std::filesystem::file_time_type source_modified;
+        if (!StatSource(source, source_bytes, source_modified) ||
+            (source_bytes == staged.bytes && source_modified == staged.source_modified)) {
+            continue;
+        }
+        std::lock_guard lock(cache.mutex);
+        auto it = cache.staged.find(source);
+        if (it != cache.staged.end() && it->second.source_modified == staged.source_modified && it->second.bytes == staged.bytes) {
+            spdlog::info("Staging: '{}' changed since it was staged; dropping the copy.", source);
+            cache.stats.integrity_failures.fetch_add(1, std::memory_order_relaxed);
+            RemoveStagedTrack(cache, it);
+        }
+    }
+}
+
+void StagingLoop(std::stop_token stop_token, TrackStagingCache* cache) {
+    SetTraceThreadName("Track Staging");
+    {
+        std::lock_guard lock(cache->mutex); // Entries from an earlier start name the files removed below
+        cache->staged.clear();
+        cache->stats.resident_bytes.store(0, std::memory_order_relaxed);
+    }
+    ClearStagingDirectory(cache->directory);
+    std::vector<char> buffer(kStagingReadBytes);
+    auto next_check = std::chrono::steady_clock::now() + kStagingCheckInterval;
+    while (true) {
+        std::string source;
+        {
+            std::unique_lock lock(cache->mutex);
+            const bool woken = cache->requests_available.wait_until(lock, stop_token, next_check,
+                                                                    [cache] { return !cache->requests.empty() || cache->check_requested; });
+            if (stop_token.stop_requested()) {
+                return;
+            }
+            if (!woken || cache->check_requested) { // Copies are checked when nothing is queued
+                cache->check_requested = false;
+                lock.unlock();
+                CheckStagedTracks(*cache, stop_token);
+                next_check = std::chrono::steady_clock::now() + kStagingCheckInterval;
+                continue;
+            }
+            source = std::move(cache->requests.front());
+            cache->requests.pop_front();
+            cache->copying = source;
+        }
+        StageTrack(*cache, source, buffer, stop_token);
+        std::lock_guard lock(cache->mutex);
+        cache->copying.clear();
+        cache->stats.pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+std::filesystem::path GetDefaultStagingDirectory() {
+    std::filesystem::path base;
+#if defined(_WIN32)
+    if (const char* local_app_data = std::getenv("LOCALAPPDATA")) {
+        base = local_app_data;
+    }
+#elif defined(__APPLE__)
+    if (const char* home = std::getenv("HOME")) {
+        base = std::filesystem::path(home) / "Library" / "Caches";
+    }
+#else
+    if (const char* cache_home = std::getenv("XDG_CACHE_HOME"); cache_home && *cache_home) {
+        base = cache_home;
+    } else if (const char* home = std::getenv("HOME")) {
+        base = std::filesystem::path(home) / ".cache";
+    }
+#endif
+    if (base.empty()) {
+        std::error_code error;
+        base = std::filesystem::temp_directory_path(error);
+    }
+    return base / "AudioPlayer" / "staging";
+}
+
+void StartTrackStaging(TrackStagingCache& cache) {
+    if (!cache.staging_thread.joinable()) {
+        cache.staging_thread = std::jthread(StagingLoop, &cache);
+    }
+}
+
+void StopTrackStaging(TrackStagingCache& cache) {
+    if (!cache.staging_thread.joinable()) {
+        return;
+    }
+    cache.staging_thread.request_stop();
+    cache.requests_available.notify_all();
+    cache.staging_thread.join();
+    std::lock_guard lock(cache.mutex);
+    cache.requests.clear();
+    cache.stats.pending.store(0, std::memory_order_relaxed);
+}
+
+void RequestStagedTrackCheck(TrackStagingCache& cache) {
+    {
+        std::lock_guard lock(cache.mutex);
+        cache.check_requested = true;
+    }
+    cache.requests_available.notify_one();
+}
+
+void StageUpcomingTracks(TrackStagingCache& cache, const std::vector<std::string>& upcoming) {
+    if (!cache.staging_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(cache.mutex);
+        for (const auto& source : upcoming) {
+            if (cache.staged.contains(source) || source == cache.copying ||
+                std::find(cache.requests.begin(), cache.requests.end(), source) != cache.requests.end()) {
+                continue;
+            }
+            cache.requests.push_back(source);
+            cache.stats.pending.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    cache.requests_available.notify_one();
+}
+
+std::string FindStagedTrack(TrackStagingCache& cache, const std::string& source) {
+    std::lock_guard lock(cache.mutex);
+    cache.in_use = source;
+    auto it = cache.staged.find(source);
+    if (it == cache.staged.end()) {
+        cache.stats.misses.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+    // A local stat only: the source was checked by the staging thread, off the UI thread.
+    std::error_code error;
+    const uint64_t local_bytes = std::filesystem::file_size(it->second.local_path, error);
+    if (error || local_bytes != it->second.bytes) {
+        spdlog::warn("Staging: the copy of '{}' no longer matches; opening the source.", source);
+        cache.stats.integrity_failures.fetch_add(1, std::memory_order_relaxed);
+        cache.stats.misses.fetch_add(1, std::memory_order_relaxed);
+        RemoveStagedTrack(cache, it);
+        return {};
+    }
+    it->second.last_used = ++cache.use_counter;
+    cache.stats.hits.fetch_add(1, std::memory_order_relaxed);
+    return it->second.local_path.string();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Local copies of queued tracks for libraries on network mounts that can stall for seconds. A
+// staging thread copies each upcoming file into a bounded local directory in large sequential
+// reads, checksumming the source as it goes. A copy is published only if the source kept its size
+// and modification time throughout and, where the copy can be dropped from the page cache (Linux),
+// reading it back from disk gives the same checksum. The player then opens the local copy, so playback never waits on the
+// network. The least recently played copies are deleted to stay within the budget, and copies left
+// by an earlier run are deleted on start since the sources may have changed in the meantime. Only
+// files named like a staged copy are ever deleted. While idle, and after each library rescan, the
+// staging thread re-checks each source's size and modification time and drops copies whose source
+// has changed, so opening a track never waits on a network stat.
+
+constexpr uint64_t kStagingDefaultBudgetBytes = 4ull << 30;
+constexpr size_t kStagingReadBytes = 4 << 20;
+
+struct TrackStagingStats {
+    std::atomic<uint32_t> pending{0};
+    std::atomic<uint64_t> staged_files{0};
+    std::atomic<uint64_t> staged_bytes{0}; // Copied since start
+    std::atomic<uint64_t> resident_bytes{0};
+    std::atomic<uint64_t> evicted_files{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> integrity_failures{0}; // Copies rejected, or whose source changed later
+    std::atomic<uint64_t> copy_errors{0};
+    std::atomic<uint64_t> copy_ns{0};
+};
+
+struct StagedTrack {
+    std::filesystem::path local_path;
+    uint64_t bytes = 0; // Also the source size at staging
+    std::filesystem::file_time_type source_modified;
+    uint64_t last_used = 0; // Use counter value at staging or last open
+};
+
+// A "staging" folder under the platform cache directory (XDG_CACHE_HOME or ~/.cache, LOCALAPPDATA,
+// ~/Library/Caches), or under the temp directory when none is known.
+std::filesystem::path GetDefaultStagingDirectory();
+
+struct TrackStagingCache {
+    std::filesystem::path directory = GetDefaultStagingDirectory();
+    uint64_t budget_bytes = kStagingDefaultBudgetBytes;
+
+    std::mutex mutex; // Guards everything below
+    std::condition_variable_any requests_available;
+    std::deque<std::string> requests;
+    std::unordered_map<std::string, StagedTrack> staged; // By source path
+    std::string copying;                                 // Source being copied, if any
+    std::string in_use;                                  // Source last opened; never evicted
+    bool check_requested = false;                        // Re-check the sources of staged copies
+    uint64_t use_counter = 0;
+
+    std::jthread staging_thread;
+    TrackStagingStats stats;
+};
+
+void StartTrackStaging(TrackStagingCache& cache);
+// Abandons the copy in progress and joins the staging thread. Staged files stay on disk.
+void StopTrackStaging(TrackStagingCache& cache);
+
+// UI thread. Queues the files in `upcoming` that are neither staged nor queued.
+void StageUpcomingTracks(TrackStagingCache& cache, const std::vector<std::string>& upcoming);
+// UI thread. Has the staging thread re-check the staged sources, e.g. after a library rescan.
+void RequestStagedTrackCheck(TrackStagingCache& cache);
+// UI thread. The local copy of `source` for opening, or empty if there is none. Only the local copy
+// is looked at; the source was checked by the staging thread.
+std::string FindStagedTrack(TrackStagingCache& cache, const std::string& source);
@@ -0,0 +1,92 @@
+#include "volume_node.h"
+
+#include "dsp.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+constexpr ma_uint32 kVolumeBlockFrames = 256;
+
+void ProcessVolumeNode(ma_node* node, const float** frames_in, ma_uint32* frame_count_in, float** frames_out, ma_uint32* frame_count_out) {
+    TRACE_SCOPE("ProcessVolumeNode");
+    (void)frame_count_in;
+    ProcessVolumeRamp(static_cast<VolumeNode*>(node), frames_in[0], frames_out[0], *frame_count_out);
+}
+
+ma_node_vtable g_volume_node_vtable = {
+    ProcessVolumeNode,
+    nullptr,
+    1, // Input buses
+    1, // Output buses
+    0
+};
+
+} // namespace
+
+void ConfigureVolumeRamp(VolumeNode* node, ma_uint32 channels, ma_uint32 sample_rate, float initial_gain) {
+    node->channels = channels;
+    node->target_gain.store(initial_gain);
+    node->current_gain = initial_gain;
+    node->max_step_per_frame = 1000.0f / (kVolumeRampMs * sample_rate);
+    node->expanded_gains.assign(static_cast<size_t>(kVolumeBlockFrames) * channels, initial_gain);
+}
+
+ma_result InitializeVolumeNode(ma_node_graph* node_graph, ma_uint32 channels, ma_uint32 sample_rate, float initial_gain, VolumeNode* node) {
+    ConfigureVolumeRamp(node, channels, sample_rate, initial_gain);
+
+    ma_uint32 bus_channels[1] = {channels};
+    ma_node_config node_config = ma_node_config_init();
+    node_config.vtable = &g_volume_node_vtable;
+    node_config.pInputChannels = bus_channels;
+    node_config.pOutputChannels = bus_channels;
+    ma_result result = ma_node_init(node_graph, &node_config, nullptr, &node->base);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Failed to initialize volume node: {}", ma_result_description(result));
+    }
+    return result;
+}
+
+void UninitializeVolumeNode(VolumeNode* node) {
+    ma_node_uninit(&node->base, nullptr);
+}
+
+void SetVolumeNodeTarget(VolumeNode* node, float gain) {
+    node->target_gain.store(std::clamp(gain, 0.0f, 1.0f), std::memory_order_relaxed);
+}
+
+void ProcessVolumeRamp(VolumeNode* node, const float* input, float* output, ma_uint32 frame_count) {
+    const ma_uint32 channels = node->channels;
+    const float target = node->target_gain.load(std::memory_order_relaxed);
+
+    if (node->current_gain == target) {
+        // Steady state: a plain copy or a single vector scale.
+        const size_t samples = static_cast<size_t>(frame_count) * channels;
+        if (output != input) {
+            std::memcpy(output, input, samples * sizeof(float));
+        }
+        if (target != 1.0f) {
+            DspScale(output, target, samples);
+        }
+        return;
+    }
+
+    for (ma_uint32 offset = 0; offset < frame_count; offset += kVolumeBlockFrames) {
+        const ma_uint32 block = std::min(kVolumeBlockFrames, frame_count - offset);
+        float* gains = node->expanded_gains.data();
+        float gain = node->current_gain;
+        for (ma_uint32 i = 0; i < block; ++i) {
+            // Rate-limited approach: snaps to the target on the last step and then holds it.
+            float delta = target - gain;
+            gain = std::fabs(delta) <= node->max_step_per_frame ? target : gain + std::copysign(node->max_step_per_frame, delta);
+            std::fill_n(gains + static_cast<size_t>(i) * channels, channels, gain);
+        }
+        node->current_gain = gain;
+        const size_t block_offset = static_cast<size_t>(offset) * channels;
+        DspMultiply(input + block_offset, gains, output + block_offset, static_cast<size_t>(block) * channels);
+    }
+}
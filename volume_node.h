@@ -0,0 +1,33 @@
+#pragma once
+
+#include "miniaudio.h"
+#include <atomic>
+#include <vector>
+
+// Master volume stage. The UI thread only stores a target gain; the audio thread ramps towards it
+// linearly per sample, so slider moves never produce gain steps (zipper noise). Processing takes no
+// locks and never allocates.
+
+constexpr float kVolumeRampMs = 20.0f; // Time for a full-scale (0 -> 1) change
+
+struct VolumeNode {
+    ma_node_base base; // Must be first
+
+    ma_uint32 channels = 0;
+    std::atomic<float> target_gain{1.0f};
+
+    // Audio-thread state.
+    float current_gain = 1.0f;
+    float max_step_per_frame = 0.0f;
+    std::vector<float> expanded_gains; // One block of per-sample gains, repeated per channel
+};
+
+static_assert(std::atomic<float>::is_always_lock_free, "The volume target must not fall back to a locked atomic");
+
+// Sets up the ramp state and buffers; called by InitializeVolumeNode, usable without a node graph.
+void ConfigureVolumeRamp(VolumeNode* node, ma_uint32 channels, ma_uint32 sample_rate, float initial_gain);
+ma_result InitializeVolumeNode(ma_node_graph* node_graph, ma_uint32 channels, ma_uint32 sample_rate, float initial_gain, VolumeNode* node);
+void UninitializeVolumeNode(VolumeNode* node);
+void SetVolumeNodeTarget(VolumeNode* node, float gain);
+// The node's processing, exposed for benchmarks: applies the ramped gain from `input` to `output`.
+void ProcessVolumeRamp(VolumeNode* node, const float* input, float* output, ma_uint32 frame_count);
@@ -0,0 +1,42 @@
+#include "wav_format.h"
+
+#include <cstring>
+
+namespace {
+
+void PutLe16(char* out, uint16_t value) {
+    out[0] = static_cast<char>(value & 0xFF);
+    out[1] = static_cast<char>(value >> 8);
+}
+
+void PutLe32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+} // namespace
+
+std::array<char, kWavHeaderSize> BuildWavHeader(uint32_t channels, uint32_t sample_rate, uint32_t bits_per_sample, bool is_float,
+                                                uint32_t data_bytes) {
+    constexpr uint16_t kFormatPcm = 1;
+    constexpr uint16_t kFormatIeeeFloat = 3;
+    const uint32_t block_align = channels * (bits_per_sample / 8);
+
+    std::array<char, kWavHeaderSize> header{};
+    char* out = header.data();
+    std::memcpy(out, "RIFF", 4);
+    // An unknown data size stays unknown in the RIFF size too, rather than wrapping.
+    PutLe32(out + 4, data_bytes == kWavUnknownSize ? kWavUnknownSize : data_bytes + 36);
+    std::memcpy(out + 8, "WAVEfmt ", 8);
+    PutLe32(out + 16, 16);
+    PutLe16(out + 20, is_float ? kFormatIeeeFloat : kFormatPcm);
+    PutLe16(out + 22, static_cast<uint16_t>(channels));
+    PutLe32(out + 24, sample_rate);
+    PutLe32(out + 28, sample_rate * block_align);
+    PutLe16(out + 32, static_cast<uint16_t>(block_align));
+    PutLe16(out + 34, static_cast<uint16_t>(bits_per_sample));
+    std::memcpy(out + 36, "data", 4);
+    PutLe32(out + 40, data_bytes);
+    return header;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Canonical 44-byte RIFF/WAVE header for interleaved PCM (bits 16/24/32) or float (bits 32 with
+// `is_float`). Pass kWavUnknownSize as `data_bytes` for a live stream whose length is not known.
+constexpr uint32_t kWavUnknownSize = 0xFFFFFFFFu;
+constexpr size_t kWavHeaderSize = 44;
+
+std::array<char, kWavHeaderSize> BuildWavHeader(uint32_t channels, uint32_t sample_rate, uint32_t bits_per_sample, bool is_float,
+                                                uint32_t data_bytes);
@@ -0,0 +1,270 @@
+#include "zones.h"
+
+#include "trace.h"
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+// Fully decoded and shared by path inside the resource manager. Opened asynchronously: the zone
+// takes the track over once the job thread has initialised it, while decoding continues.
+constexpr ma_uint32 kZoneTrackFlags = MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE;
+
+void AbandonZoneTrackOpen(Zone& zone) {
+    if (zone.opening_source) {
+        zone.abandoned_sources.push_back(std::move(zone.opening_source));
+    }
+    zone.opening_track_index = -1;
+    zone.opening_filepath.clear();
+}
+
+// Frees abandoned opens whose jobs have finished. With `wait`, blocks for the rest.
+void ReapZoneTrackOpens(Zone& zone, bool wait) {
+    std::erase_if(zone.abandoned_sources, [wait](const std::unique_ptr<TrackSource>& source) {
+        if (wait) {
+            WaitForTrackSourceOpen(source.get());
+        } else if (!IsTrackSourceOpenComplete(source.get())) {
+            return false;
+        }
+        UninitializeTrackSource(source.get());
+        return true;
+    });
+}
+
+void ZoneDataCallback(ma_device* device, void* output, const void* input, ma_uint32 frame_count) {
+    SetTraceThreadName("Zone Audio");
+    TRACE_SCOPE("ZoneDataCallback");
+    (void)input;
+    auto* zone = static_cast<Zone*>(device->pUserData);
+    RecordDeviceClock(zone->clock, frame_count);
+
+    const bool drift_enabled = zone->drift_correction_enabled.load(std::memory_order_relaxed);
+    if (!drift_enabled) {
+        zone->drift_active = false;
+        ma_engine_read_pcm_frames(&zone->engine, output, frame_count, nullptr);
+        return;
+    }
+    if (!zone->drift_active) {
+        ResetResampler(zone->drift_resampler);
+        zone->drift_input_frames = 0;
+        zone->drift_input_offset = 0;
+        zone->drift_active = true;
+    }
+
+    // Render the engine at its nominal rate and resample by the (ppm-level) drift correction.
+    SetResamplerRatioAdjustment(zone->drift_resampler, zone->ratio_adjustment.load(std::memory_order_relaxed));
+    const ma_uint32 channels = zone->device.playback.channels;
+    auto* out = static_cast<float*>(output);
+    uint64_t produced = 0;
+    while (produced < frame_count) {
+        if (zone->drift_input_offset == zone->drift_input_frames) {
+            ma_uint64 read = 0;
+            ma_engine_read_pcm_frames(&zone->engine, zone->drift_input.data(), kZoneDriftBlockFrames, &read);
+            zone->drift_input_frames = read;
+            zone->drift_input_offset = 0;
+            if (read == 0) {
+                std::fill(out + produced * channels, out + static_cast<size_t>(frame_count) * channels, 0.0f);
+                return;
+            }
+        }
+        uint64_t input_frames = zone->drift_input_frames - zone->drift_input_offset;
+        uint64_t output_frames = frame_count - produced;
+        ProcessResampler(zone->drift_resampler, zone->drift_input.data() + zone->drift_input_offset * channels, &input_frames,
+                         out + produced * channels, &output_frames);
+        zone->drift_input_offset += input_frames;
+        produced += output_frames;
+    }
+}
+
+void ZoneSoundEndCallback(void* user_data, ma_sound* sound) {
+    (void)sound;
+    static_cast<Zone*>(user_data)->track_ended_flag.store(true);
+}
+
+} // namespace
+
+bool EnumeratePlaybackDevices(ma_context* context, std::vector<PlaybackDeviceInfo>& devices_out) {
+    devices_out.clear();
+    ma_device_info* playback_infos = nullptr;
+    ma_uint32 playback_count = 0;
+    ma_result result = ma_context_get_devices(context, &playback_infos, &playback_count, nullptr, nullptr);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Failed to enumerate playback devices: {}", ma_result_description(result));
+        return false;
+    }
+    for (ma_uint32 i = 0; i < playback_count; ++i) {
+        PlaybackDeviceInfo info;
+        info.name = playback_infos[i].name;
+        info.id = playback_infos[i].id;
+        info.is_default = playback_infos[i].isDefault != 0;
+        devices_out.push_back(std::move(info));
+    }
+    spdlog::info("Found {} playback devices.", devices_out.size());
+    return true;
+}
+
+std::unique_ptr<Zone> CreateZone(ma_context* context, ma_resource_manager* resource_manager, const std::string& name,
+                                 const PlaybackDeviceInfo* device) {
+    auto zone = std::make_unique<Zone>();
+    zone->name = name;
+    zone->device_name = device ? device->name : "Default device";
+
+    ma_device_config device_config = ma_device_config_init(ma_device_type_playback);
+    device_config.playback.pDeviceID = device ? &device->id : nullptr;
+    device_config.playback.format = ma_format_f32;
+    device_config.dataCallback = ZoneDataCallback;
+    device_config.pUserData = zone.get();
+    ma_result result = ma_device_init(context, &device_config, &zone->device);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Zone '{}': failed to open '{}': {}", name, zone->device_name, ma_result_description(result));
+        return nullptr;
+    }
+    zone->device_initialized = true;
+
+    // The zone's device drives the engine, so the engine is created without one of its own.
+    ma_engine_config engine_config = ma_engine_config_init();
+    engine_config.pResourceManager = resource_manager;
+    engine_config.noDevice = MA_TRUE;
+    engine_config.channels = zone->device.playback.channels;
+    engine_config.sampleRate = zone->device.sampleRate;
+    result = ma_engine_init(&engine_config, &zone->engine);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Zone '{}': failed to initialize engine: {}", name, ma_result_description(result));
+        DestroyZone(*zone);
+        return nullptr;
+    }
+    zone->engine_initialized = true;
+
+    InitializeResampler(zone->drift_resampler, ResamplerQuality::Medium, engine_config.channels, engine_config.sampleRate,
+                        engine_config.sampleRate);
+    zone->drift_input.assign(kZoneDriftBlockFrames * engine_config.channels, 0.0f);
+
+    result = InitializeVolumeNode(ma_engine_get_node_graph(&zone->engine), engine_config.channels, engine_config.sampleRate,
+                                  zone->volume_level, &zone->volume);
+    if (result != MA_SUCCESS) {
+        DestroyZone(*zone);
+        return nullptr;
+    }
+    zone->volume_initialized = true;
+    ma_node_attach_output_bus(&zone->volume, 0, ma_engine_get_endpoint(&zone->engine), 0);
+
+    result = ma_device_start(&zone->device);
+    if (result != MA_SUCCESS) {
+        spdlog::error("Zone '{}': failed to start '{}': {}", name, zone->device_name, ma_result_description(result));
+        DestroyZone(*zone);
+        return nullptr;
+    }
+    spdlog::info("Zone '{}' created on '{}' ({} ch, {} Hz).", name, zone->device_name, engine_config.channels, engine_config.sampleRate);
+    return zone;
+}
+
+void DestroyZone(Zone& zone) {
+    // Stop the device first so the callback no longer touches the engine.
+    if (zone.device_initialized) {
+        ma_device_uninit(&zone.device);
+        zone.device_initialized = false;
+    }
+    UnloadZoneTrack(zone);
+    ReapZoneTrackOpens(zone, true);
+    if (zone.volume_initialized) {
+        UninitializeVolumeNode(&zone.volume);
+        zone.volume_initialized = false;
+    }
+    if (zone.engine_initialized) {
+        ma_engine_uninit(&zone.engine);
+        zone.engine_initialized = false;
+    }
+    spdlog::info("Zone '{}' destroyed.", zone.name);
+}
+
+bool BeginZoneTrackOpen(Zone& zone, ma_resource_manager* resource_manager, int track_index, const std::string& filepath) {
+    TRACE_SCOPE("BeginZoneTrackOpen");
+    UnloadZoneTrack(zone);
+    zone.opening_source = std::make_unique<TrackSource>();
+    ma_result result = BeginTrackSourceOpen(resource_manager, filepath, kZoneTrackFlags, zone.opening_source.get());
+    if (result != MA_SUCCESS) {
+        spdlog::error("Zone '{}': failed to open '{}': {}", zone.name, filepath, ma_result_description(result));
+        UninitializeTrackSource(zone.opening_source.get());
+        zone.opening_source.reset();
+        return false;
+    }
+    zone.opening_track_index = track_index;
+    zone.opening_filepath = filepath;
+    return true;
+}
+
+bool ProcessZoneTrackOpen(Zone& zone, ResamplerQuality quality) {
+    ReapZoneTrackOpens(zone, false);
+    if (!zone.opening_source || !IsTrackSourceOpenComplete(zone.opening_source.get())) {
+        return false;
+    }
+    TRACE_SCOPE("ProcessZoneTrackOpen");
+    std::unique_ptr<TrackSource> source = std::move(zone.opening_source);
+    const int track_index = zone.opening_track_index;
+    std::string filepath = std::move(zone.opening_filepath);
+    AbandonZoneTrackOpen(zone); // Only resets the bookkeeping; the source has been taken
+
+    ma_result result = FinishTrackSourceOpen(source.get(), filepath, quality, ma_engine_get_sample_rate(&zone.engine));
+    if (result == MA_SUCCESS) {
+        result = ma_sound_init_from_data_source(&zone.engine, GetTrackDataSource(source.get()), 0, nullptr, &zone.sound);
+    }
+    if (result != MA_SUCCESS) {
+        spdlog::error("Zone '{}': failed to load '{}': {}", zone.name, filepath, ma_result_description(result));
+        UninitializeTrackSource(source.get());
+        zone.play_when_open = false;
+        return false;
+    }
+    zone.track_source = std::move(source);
+    zone.sound_initialized = true;
+    zone.current_track_index = track_index;
+    zone.current_filepath = std::move(filepath);
+    ma_node_attach_output_bus(&zone.sound, 0, &zone.volume, 0);
+    ma_sound_set_end_callback(&zone.sound, ZoneSoundEndCallback, &zone);
+    return true;
+}
+
+void UnloadZoneTrack(Zone& zone) {
+    AbandonZoneTrackOpen(zone);
+    if (zone.sound_initialized) {
+        ma_sound_uninit(&zone.sound);
+        UninitializeTrackSource(zone.track_source.get());
+        zone.track_source.reset();
+        zone.sound_initialized = false;
+    }
+    zone.current_filepath.clear();
+    zone.is_playing = false;
+    zone.play_when_open = false;
+}
+
+void StartZone(Zone& zone) {
+    if (zone.sound_initialized) {
+        ma_sound_start(&zone.sound);
+        zone.is_playing = true;
+    }
+}
+
+void PauseZone(Zone& zone) {
+    if (zone.sound_initialized) {
+        ma_sound_stop(&zone.sound);
+    }
+    zone.is_playing = false;
+    zone.play_when_open = false;
+}
+
+void SetZoneVolume(Zone& zone, float volume) {
+    zone.volume_level = volume;
+    SetVolumeNodeTarget(&zone.volume, volume);
+}
+
+double GetZoneOutputLatency(const Zone& zone) {
+    const ma_uint32 rate = zone.device.sampleRate;
+    if (rate == 0) {
+        return 0.0;
+    }
+    double frames = static_cast<double>(zone.device.playback.internalPeriodSizeInFrames) * zone.device.playback.internalPeriods;
+    if (zone.drift_correction_enabled.load(std::memory_order_relaxed)) {
+        frames += GetResamplerFlushFrames(zone.drift_resampler);
+    }
+    return frames / rate;
+}
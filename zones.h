@@ -0,0 +1,91 @@
+#pragma once
+
+#include "clock_sync.h"
+#include "miniaudio.h"
+#include "resampler.h"
+#include "track_source.h"
+#include "volume_node.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Additional output zones (rooms). Each zone owns its playback device, engine, volume stage and
+// queue. All zones share the player's resource manager, and zone tracks are fully decoded through it,
+// so a track playing in several zones is decoded once and its buffer is shared.
+
+struct PlaybackDeviceInfo {
+    std::string name;
+    ma_device_id id{};
+    bool is_default = false;
+};
+
+struct Zone {
+    std::string name;
+    std::string device_name;
+    ma_device device{};
+    ma_engine engine{};
+    VolumeNode volume;
+    ma_sound sound{};
+    std::unique_ptr<TrackSource> track_source; // Backs `sound`
+    bool device_initialized = false;
+    bool engine_initialized = false;
+    bool volume_initialized = false;
+    bool sound_initialized = false;
+
+    std::deque<int> queue; // Track indices to play after the current one
+    int current_track_index = -1;
+    std::string current_filepath;
+    bool is_playing = false;
+    bool play_when_open = false; // Start once the open in flight completes
+
+    // Open in flight, taken over by ProcessZoneTrackOpen. Superseded opens wait in abandoned_sources
+    // until their job finishes.
+    std::unique_ptr<TrackSource> opening_source;
+    int opening_track_index = -1;
+    std::string opening_filepath;
+    std::vector<std::unique_ptr<TrackSource>> abandoned_sources;
+    float volume_level = 1.0f;
+    std::atomic<bool> track_ended_flag{false};
+
+    // --- Sync to the main output ---
+    // The device callback stamps `clock`; when drift correction is on, engine output goes through
+    // `drift_resampler` with the ratio adjustment computed on the main thread.
+    DeviceClock clock;
+    std::atomic<bool> drift_correction_enabled{false};
+    std::atomic<double> ratio_adjustment{1.0};
+    Resampler drift_resampler;
+    std::vector<float> drift_input;
+    ma_uint64 drift_input_frames = 0;
+    ma_uint64 drift_input_offset = 0;
+    bool drift_active = false; // Audio-thread view of drift_correction_enabled
+
+    bool sync_to_main = false;
+    DriftEstimator drift_estimator;
+    double drift_ppm = 0.0;
+    double phase_error_seconds = 0.0; // Filtered; positive = zone ahead of main
+    double correction_ppm = 0.0;
+    int resync_count = 0;
+};
+
+constexpr ma_uint64 kZoneDriftBlockFrames = 512;
+
+bool EnumeratePlaybackDevices(ma_context* context, std::vector<PlaybackDeviceInfo>& devices_out);
+// Opens the device (null = system default) and starts an engine on it. Returns null on failure.
+std::unique_ptr<Zone> CreateZone(ma_context* context, ma_resource_manager* resource_manager, const std::string& name,
+                                 const PlaybackDeviceInfo* device);
+void DestroyZone(Zone& zone);
+
+// Releases the current track and starts opening `filepath` without blocking, as for the main player.
+// Poll ProcessZoneTrackOpen once per frame; it returns true when the track has been loaded (not
+// started) and made current.
+bool BeginZoneTrackOpen(Zone& zone, ma_resource_manager* resource_manager, int track_index, const std::string& filepath);
+bool ProcessZoneTrackOpen(Zone& zone, ResamplerQuality quality);
+// Releases the current track and abandons an open in flight.
+void UnloadZoneTrack(Zone& zone);
+void StartZone(Zone& zone);
+void PauseZone(Zone& zone);
+void SetZoneVolume(Zone& zone, float volume);
+// Output latency of the zone's device plus the drift resampler's delay, in seconds.
+double GetZoneOutputLatency(const Zone& zone);